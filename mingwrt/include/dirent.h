@@ -27,6 +27,20 @@ struct dirent
   char            d_name[FILENAME_MAX]; /* File name. */
 };
 
+/* Supplementary attributes of a directory entry, which are retrieved
+ * by the same directory search as the dirent structure itself, and may
+ * be obtained by calling readdirx(), in place of readdir(), thus saving
+ * the expense of calling stat() for each entry; (a MinGW extension).
+ */
+struct dirent_stat
+{
+  unsigned long   d_attrib;		/* Win32 file attribute bits. */
+  __int64         d_size;		/* File size, in bytes. */
+  __time64_t      d_atime;		/* Time of last access. */
+  __time64_t      d_mtime;		/* Time of last modification. */
+  __time64_t      d_ctime;		/* Time of creation. */
+};
+
 /* This opaque data type represents the private structure
  * through which a directory stream is referenced.
  */
@@ -38,6 +52,7 @@ int __cdecl __MINGW_NOTHROW __mingw_closedir (DIR*);
 void __cdecl __MINGW_NOTHROW __mingw_rewinddir (DIR*);
 long __cdecl __MINGW_NOTHROW __mingw_telldir (DIR*);
 void __cdecl __MINGW_NOTHROW __mingw_seekdir (DIR*, long);
+struct dirent* __cdecl __MINGW_NOTHROW __mingw_readdirx (DIR*, struct dirent_stat*);
 
 __CRT_ALIAS __JMPSTUB__(( FUNCTION = opendir ))
 DIR* __cdecl __MINGW_NOTHROW opendir (const char *__dirname)
@@ -63,6 +78,29 @@ __CRT_ALIAS __JMPSTUB__(( FUNCTION = seekdir ))
 void __cdecl __MINGW_NOTHROW seekdir (DIR *__dir, long __loc)
 { return __mingw_seekdir (__dir, __loc); }
 
+__CRT_ALIAS __JMPSTUB__(( FUNCTION = readdirx ))
+struct dirent* __cdecl __MINGW_NOTHROW readdirx (DIR *__dir, struct dirent_stat *__st)
+{ return __mingw_readdirx (__dir, __st); }
+
+#if _POSIX_C_SOURCE >= 200809L
+/* POSIX.1-2008 adds scandir(), and its alphasort() helper.
+ */
+int __cdecl __MINGW_NOTHROW __mingw_scandir (const char*, struct dirent***,
+  int (*)(const struct dirent*), int (*)(const struct dirent**, const struct dirent**));
+int __cdecl __MINGW_NOTHROW __mingw_alphasort (const struct dirent**, const struct dirent**);
+
+__CRT_ALIAS __JMPSTUB__(( FUNCTION = scandir ))
+int __cdecl __MINGW_NOTHROW scandir (const char *__dirname, struct dirent ***__namelist,
+  int (*__filter)(const struct dirent*),
+  int (*__compare)(const struct dirent**, const struct dirent**))
+{ return __mingw_scandir (__dirname, __namelist, __filter, __compare); }
+
+__CRT_ALIAS __JMPSTUB__(( FUNCTION = alphasort ))
+int __cdecl __MINGW_NOTHROW alphasort (const struct dirent **__a, const struct dirent **__b)
+{ return __mingw_alphasort (__a, __b); }
+
+#endif	/* _POSIX_C_SOURCE >= 200809L */
+
 
 /* wide char versions */
 
@@ -86,6 +124,7 @@ int __cdecl __MINGW_NOTHROW __mingw__wclosedir (_WDIR*);
 void __cdecl __MINGW_NOTHROW __mingw__wrewinddir (_WDIR*);
 long __cdecl __MINGW_NOTHROW __mingw__wtelldir (_WDIR*);
 void __cdecl __MINGW_NOTHROW __mingw__wseekdir (_WDIR*, long);
+struct _wdirent* __cdecl __MINGW_NOTHROW __mingw__wreaddirx (_WDIR*, struct dirent_stat*);
 
 __CRT_ALIAS __JMPSTUB__(( FUNCTION = _wopendir ))
 _WDIR* __cdecl __MINGW_NOTHROW _wopendir (const wchar_t *__dirname)
@@ -111,6 +150,27 @@ __CRT_ALIAS __JMPSTUB__(( FUNCTION = _wseekdir ))
 void __cdecl __MINGW_NOTHROW _wseekdir (_WDIR *__dir, long __loc)
 { return __mingw__wseekdir (__dir, __loc); }
 
+__CRT_ALIAS __JMPSTUB__(( FUNCTION = _wreaddirx ))
+struct _wdirent* __cdecl __MINGW_NOTHROW _wreaddirx (_WDIR *__dir, struct dirent_stat *__st)
+{ return __mingw__wreaddirx (__dir, __st); }
+
+#if _POSIX_C_SOURCE >= 200809L
+int __cdecl __MINGW_NOTHROW __mingw__wscandir (const wchar_t*, struct _wdirent***,
+  int (*)(const struct _wdirent*), int (*)(const struct _wdirent**, const struct _wdirent**));
+int __cdecl __MINGW_NOTHROW __mingw__walphasort (const struct _wdirent**, const struct _wdirent**);
+
+__CRT_ALIAS __JMPSTUB__(( FUNCTION = _wscandir ))
+int __cdecl __MINGW_NOTHROW _wscandir (const wchar_t *__dirname, struct _wdirent ***__namelist,
+  int (*__filter)(const struct _wdirent*),
+  int (*__compare)(const struct _wdirent**, const struct _wdirent**))
+{ return __mingw__wscandir (__dirname, __namelist, __filter, __compare); }
+
+__CRT_ALIAS __JMPSTUB__(( FUNCTION = _walphasort ))
+int __cdecl __MINGW_NOTHROW _walphasort (const struct _wdirent **__a, const struct _wdirent **__b)
+{ return __mingw__walphasort (__a, __b); }
+
+#endif	/* _POSIX_C_SOURCE >= 200809L */
+
 _END_C_DECLS
 
 #if defined(_BSD_SOURCE) || defined(_WIN32)
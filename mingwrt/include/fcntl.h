@@ -72,4 +72,20 @@
 
 #endif	/* Not _NO_OLDNAMES */
 
+#if _POSIX_C_SOURCE >= 200112L
+/* POSIX posix_fallocate() function, implemented in libmingwex.a, in
+ * terms of a MinGW specific variant, which accepts 64-bit offsets.
+ */
+_BEGIN_C_DECLS
+
+int __cdecl __MINGW_NOTHROW posix_fallocate (int, off_t, off_t);
+int __cdecl __MINGW_NOTHROW posix_fallocate64 (int, __off64_t, __off64_t);
+
+__CRT_ALIAS __LIBIMPL__(( FUNCTION = posix_fallocate ))
+int posix_fallocate (int __fd, off_t __offset, off_t __len)
+{ return posix_fallocate64 (__fd, __offset, __len); }
+
+_END_C_DECLS
+
+#endif	/* _POSIX_C_SOURCE >= 200112L */
 #endif	/* Not _FCNTL_H_ */
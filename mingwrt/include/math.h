@@ -7,7 +7,7 @@
  * $Id$
  *
  * Written by Colin Peters <colin@bird.fu.is.saga-u.ac.jp>
- * Copyright (C) 1997-2009, 2014-2016, 2022, MinGW.OSDN Project
+ * Copyright (C) 1997-2009, 2014-2016, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -305,6 +305,34 @@ _CRTIMP int __cdecl fpclass (double);
 _CRTIMP int __cdecl _set_SSE2_enable (int);
 
 #endif	/* >= WINXP || >= __MSVCR70_DLL */
+
+/* MinGW extensions: SSE2 implementations of some of the foregoing
+ * functions, evaluating two arguments per pass.  Each __mingw_vFN()
+ * function stores FN() of each of the N elements of its argument
+ * array(s) into the first array, (which may be the same as one of
+ * the argument arrays); __mingw_sse2_FN() is the scalar equivalent.
+ * Special cases, and errno, are as for the original FN(), to which
+ * all arguments are referred, if the CPU does not support SSE2.
+ */
+#define __need_size_t
+#include <stddef.h>
+
+double __cdecl __mingw_sse2_exp (double);
+double __cdecl __mingw_sse2_log (double);
+double __cdecl __mingw_sse2_pow (double, double);
+double __cdecl __mingw_sse2_sin (double);
+double __cdecl __mingw_sse2_cos (double);
+double __cdecl __mingw_sse2_atan2 (double, double);
+double __cdecl __mingw_sse2_sqrt (double);
+
+void __cdecl __mingw_vexp (double *, const double *, size_t);
+void __cdecl __mingw_vlog (double *, const double *, size_t);
+void __cdecl __mingw_vpow (double *, const double *, const double *, size_t);
+void __cdecl __mingw_vsin (double *, const double *, size_t);
+void __cdecl __mingw_vcos (double *, const double *, size_t);
+void __cdecl __mingw_vatan2 (double *, const double *, const double *, size_t);
+void __cdecl __mingw_vsqrt (double *, const double *, size_t);
+
 #endif	/* !__STRICT_ANSI__ */
 
 #if defined __cplusplus || defined _ISOC99_SOURCE
@@ -695,11 +695,73 @@ __cdecl __MINGW_NOTHROW ssize_t getline
 #endif  /* POSIX.1-2008 */
 
 /* Formatted Input
+ *
+ * MSVCRT implementations are not ANSI C99 conformant either; (they do
+ * not support the "hh", "ll", "j", "z" or "t" length modifiers, nor
+ * hexadecimal floating point input)...  libmingwex.a offers these
+ * conforming alternatives, which are also the implementations of the
+ * vfscanf(), vscanf() and vsscanf() functions, declared above.
+ */
+#if __MINGW_GNUC_PREREQ(4, 4)
+#define __Wformat_mingw_scanf(F,A) __attribute__((__format__(__gnu_scanf__,F,A)))
+#else
+#define __Wformat_mingw_scanf(F,A)
+#endif
+
+__cdecl __MINGW_NOTHROW __Wformat_mingw_scanf(2,0)
+int __mingw_vfscanf (FILE *__restrict__, const char *__restrict__, __VALIST);
+
+__cdecl __MINGW_NOTHROW __Wformat_mingw_scanf(1,0)
+int __mingw_vscanf (const char *__restrict__, __VALIST);
+
+__cdecl __MINGW_NOTHROW __Wformat_mingw_scanf(2,0)
+int __mingw_vsscanf (const char *__restrict__, const char *__restrict__, __VALIST);
+
+#if __USE_MINGW_ANSI_STDIO && defined __GNUC__
+/* The MinGW ISO-C conforming implementations of the scanf() family of
+ * functions are to be used, in place of the non-conforming Microsoft
+ * implementations; force call redirection, via in-line functions.
+ */
+static __inline__ __cdecl __MINGW_NOTHROW __Wformat_mingw_scanf(2,3)
+int fscanf (FILE *__stream, const char *__format, ...)
+{
+  register int __retval;
+  __builtin_va_list __local_argv; __builtin_va_start( __local_argv, __format );
+  __retval = __mingw_vfscanf( __stream, __format, __local_argv );
+  __builtin_va_end( __local_argv );
+  return __retval;
+}
+
+static __inline__ __cdecl __MINGW_NOTHROW __Wformat_mingw_scanf(1,2)
+int scanf (const char *__format, ...)
+{
+  register int __retval;
+  __builtin_va_list __local_argv; __builtin_va_start( __local_argv, __format );
+  __retval = __mingw_vscanf( __format, __local_argv );
+  __builtin_va_end( __local_argv );
+  return __retval;
+}
+
+static __inline__ __cdecl __MINGW_NOTHROW __Wformat_mingw_scanf(2,3)
+int sscanf (const char *__buf, const char *__format, ...)
+{
+  register int __retval;
+  __builtin_va_list __local_argv; __builtin_va_start( __local_argv, __format );
+  __retval = __mingw_vsscanf( __buf, __format, __local_argv );
+  __builtin_va_end( __local_argv );
+  return __retval;
+}
+
+#else	/* !(__USE_MINGW_ANSI_STDIO && __GNUC__) */
+/* Default configuration: simply direct all calls to MSVCRT.
  */
 _CRTIMP __cdecl __MINGW_NOTHROW  int    fscanf (FILE *, const char *, ...);
 _CRTIMP __cdecl __MINGW_NOTHROW  int    scanf (const char *, ...);
 _CRTIMP __cdecl __MINGW_NOTHROW  int    sscanf (const char *, const char *, ...);
 
+#endif	/* !(__USE_MINGW_ANSI_STDIO && __GNUC__) */
+#undef  __Wformat_mingw_scanf
+
 /* Character Input and Output Functions
  */
 _CRTIMP __cdecl __MINGW_NOTHROW  int    fgetc (FILE *);
@@ -1102,6 +1164,19 @@ int  vfwscanf (FILE *__restrict__, const wchar_t *__restrict__, __VALIST);
 __cdecl __MINGW_NOTHROW
 int  vswscanf (const wchar_t *__restrict__, const wchar_t * __restrict__, __VALIST);
 
+/* The preceding three are implemented in libmingwex.a, where they are
+ * consistent with MSVCRT.DLL's fwscanf(), wscanf(), and swscanf(); thus,
+ * like those, they take "%s" and "%c" to refer to wchar_t data.  C99
+ * conforming alternatives, (for which these refer to char data, unless
+ * qualified by "l"), are accessible by their MinGW specific names.
+ */
+__cdecl __MINGW_NOTHROW
+int  __mingw_vwscanf (const wchar_t *__restrict__, __VALIST);
+__cdecl __MINGW_NOTHROW
+int  __mingw_vfwscanf (FILE *__restrict__, const wchar_t *__restrict__, __VALIST);
+__cdecl __MINGW_NOTHROW
+int  __mingw_vswscanf (const wchar_t *__restrict__, const wchar_t * __restrict__, __VALIST);
+
 #endif  /* _ISOC99_SOURCE */
 #endif  /* ! (_STDIO_H && _WCHAR_H) */
 
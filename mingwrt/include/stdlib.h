@@ -7,7 +7,7 @@
  * $Id$
  *
  * Written by Colin Peters <colin@bird.fu.is.saga-u.ac.jp>
- * Copyright (C) 1997-2009, 2011, 2014-2016, 2018, 2020-2022,
+ * Copyright (C) 1997-2009, 2011, 2014-2016, 2018, 2020-2022, 2026,
  *  MinGW.OSDN Project
  *
  *
@@ -1016,6 +1016,34 @@ __cdecl __MINGW_NOTHROW  int unsetenv( const char *__name )
 { return __mingw_setenv( __name, NULL, 1 ); }
 
 #endif	/* _POSIX_C_SOURCE >= 200112L (for setenv()) */
+
+#if defined _BSD_SOURCE || ! defined __STRICT_ANSI__
+/* arc4random(3) family of functions, as found on BSD systems; these
+ * deliver cryptographically secure pseudo-random data, from a ChaCha20
+ * generator which is maintained independently for each thread, seeded
+ * from the wincrypt API.
+ */
+__cdecl __MINGW_NOTHROW  unsigned int arc4random (void);
+__cdecl __MINGW_NOTHROW  void arc4random_buf (void *, size_t);
+__cdecl __MINGW_NOTHROW  unsigned int arc4random_uniform (unsigned int);
+
+__cdecl __MINGW_NOTHROW  unsigned int __mingw_arc4random (void);
+__cdecl __MINGW_NOTHROW  void __mingw_arc4random_buf (void *, size_t);
+__cdecl __MINGW_NOTHROW  unsigned int __mingw_arc4random_uniform (unsigned int);
+
+__CRT_ALIAS __JMPSTUB__(( FUNCTION = arc4random ))
+__cdecl __MINGW_NOTHROW  unsigned int arc4random (void)
+{ return __mingw_arc4random(); }
+
+__CRT_ALIAS __JMPSTUB__(( FUNCTION = arc4random_buf ))
+__cdecl __MINGW_NOTHROW  void arc4random_buf (void *__buf, size_t __len)
+{ __mingw_arc4random_buf( __buf, __len ); }
+
+__CRT_ALIAS __JMPSTUB__(( FUNCTION = arc4random_uniform ))
+__cdecl __MINGW_NOTHROW  unsigned int arc4random_uniform (unsigned int __upper_bound)
+{ return __mingw_arc4random_uniform( __upper_bound ); }
+
+#endif	/* _BSD_SOURCE || ! __STRICT_ANSI__ (for arc4random()) */
 #endif	/* _STDLIB_H */
 
 _END_C_DECLS
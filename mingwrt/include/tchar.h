@@ -254,6 +254,9 @@ typedef wchar_t _TCHAR;
 #define _trewinddir	_wrewinddir
 #define _ttelldir	_wtelldir
 #define _tseekdir	_wseekdir
+#define _treaddirx	_wreaddirx
+#define _tscandir	_wscandir
+#define _talphasort	_walphasort
 
 #else	/* Not _UNICODE */
 
@@ -470,6 +473,9 @@ typedef char	_TCHAR;
 #define _trewinddir	rewinddir
 #define _ttelldir	telldir
 #define _tseekdir	seekdir
+#define _treaddirx	readdirx
+#define _tscandir	scandir
+#define _talphasort	alphasort
 
 #endif	/* Not _UNICODE */
 
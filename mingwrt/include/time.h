@@ -6,7 +6,7 @@
  * $Id$
  *
  * Written by Colin Peters <colin@bird.fu.is.saga-u.ac.jp>
- * Copyright (C) 1997-2007, 2011, 2015-2018, 2022, MinGW.OSDN Project
+ * Copyright (C) 1997-2007, 2011, 2015-2018, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -401,8 +401,9 @@ __MINGW_IMPORT char 	*tzname[2];
 #if _POSIX_C_SOURCE
 /* The nanosleep() function provides the most general purpose API for
  * process/thread suspension; it provides for specification of periods
- * ranging from ~7.5 ms mean, (on WinNT derivatives; ~27.5 ms on Win9x),
- * extending up to ~136 years, (effectively eternity).
+ * ranging from a few microseconds, (when timed by CLOCK_MONOTONIC; if
+ * that is unavailable, ~7.5 ms mean on WinNT derivatives, or ~27.5 ms
+ * on Win9x), extending up to ~136 years, (effectively eternity).
  */
 __cdecl __MINGW_NOTHROW
 int nanosleep( const struct timespec *, struct timespec * );
@@ -429,8 +430,10 @@ int nanosleep( const struct timespec *period, struct timespec *residual )
  * was subsequently moved to "base", as of POSIX.1-2008, to the
  * extent required to support the CLOCK_REALTIME feature, with
  * the remainder of its features remaining optional.  We choose
- * to provide a subset, supporting CLOCK_MONOTONIC in addition
- * to the aforementioned CLOCK_REALTIME feature.
+ * to provide a subset, supporting CLOCK_MONOTONIC, and the CPU
+ * time clocks, in addition to the aforementioned CLOCK_REALTIME
+ * feature; we also provide the coarse clocks, which Linux offers
+ * as cheaper, (but lower resolution), alternatives.
  *
  * We define the POSIX clockid_t type as a pointer to an opaque
  * structure; user code should never need to know details of the
@@ -457,6 +460,12 @@ typedef struct __clockid__ *clockid_t;
 #define CLOCK_REALTIME  __MINGW_POSIX_CLOCKAPI (0)
 #define CLOCK_MONOTONIC __MINGW_POSIX_CLOCKAPI (1)
 
+#define CLOCK_PROCESS_CPUTIME_ID  __MINGW_POSIX_CLOCKAPI (2)
+#define CLOCK_THREAD_CPUTIME_ID   __MINGW_POSIX_CLOCKAPI (3)
+
+#define CLOCK_REALTIME_COARSE     __MINGW_POSIX_CLOCKAPI (4)
+#define CLOCK_MONOTONIC_COARSE    __MINGW_POSIX_CLOCKAPI (5)
+
 /* Prototypes for the standard POSIX functions which provide the
  * API to these standard clockid_t entities.
  */
@@ -464,6 +473,16 @@ int clock_getres (clockid_t, struct timespec *);
 int clock_gettime (clockid_t, struct timespec *);
 int clock_settime (clockid_t, const struct timespec *);
 
+/* POSIX.1-2001 added clock_nanosleep(), which may suspend the calling
+ * thread until a specified absolute time, when TIMER_ABSTIME is given
+ * in its flags argument; we support it for CLOCK_REALTIME, (although
+ * no adjustment of the system time is tracked, while waiting), and for
+ * CLOCK_MONOTONIC.
+ */
+#define TIMER_ABSTIME  1
+
+int clock_nanosleep (clockid_t, int, const struct timespec *, struct timespec *);
+
 #endif	/* _POSIX_C_SOURCE >= 199309L */
 #endif	/* _POSIX_C_SOURCE */
 
@@ -11,7 +11,7 @@
  *   Ramiro Polla <ramiro@lisha.ufsc.br>
  *   Gregory McGarry  <gregorymcgarry@users.sourceforge.net>
  *   Keith Marshall  <keith@users.osdn.me>
- * Copyright (C) 1997, 1999, 2002-2004, 2007-2009, 2014-2017, 2020-2022,
+ * Copyright (C) 1997, 1999, 2002-2004, 2007-2009, 2014-2017, 2020-2022, 2026,
  *  MinGW.OSDN Project
  *
  *
@@ -68,8 +68,8 @@
 #if _POSIX_C_SOURCE
 /* POSIX process/thread suspension functions; all are supported by a
  * common MinGW API in libmingwex.a, providing for suspension periods
- * ranging from mean values of ~7.5 milliseconds, (see the comments in
- * <time.h>), extending up to a maximum of ~136 years.
+ * ranging from a few microseconds, (see the comments in <time.h>),
+ * extending up to a maximum of ~136 years.
  *
  * Note that, whereas POSIX supports early wake-up of any suspended
  * process/thread, in response to a signal, this implementation makes
@@ -87,14 +87,15 @@ int __mingw_sleep( unsigned long, unsigned long );
  * process/thread suspension; it is declared in <time.h>, (where it is
  * accompanied by an in-line implementation), rather than here, and it
  * provides for specification of suspension periods in the range from
- * ~7.5 ms mean, (on WinNT derivatives; ~27.5 ms on Win9x), extending
- * up to ~136 years, (effectively eternity).
+ * a few microseconds, (or, if CLOCK_MONOTONIC is unavailable, ~7.5 ms
+ * mean on WinNT derivatives, or ~27.5 ms on Win9x), extending up to
+ * ~136 years, (effectively eternity).
  *
  * The usleep() function, and its associated useconds_t type specifier
  * were made obsolete in POSIX.1-2008; declared here, only for backward
  * compatibility, its continued use is not recommended.  (It is limited
- * to specification of suspension periods ranging from ~7.5 ms mean up
- * to a maximum of 999,999 microseconds only).
+ * to specification of suspension periods of no more than 999,999
+ * microseconds).
  */
 typedef unsigned long useconds_t __MINGW_ATTRIB_DEPRECATED;
 int __cdecl __MINGW_NOTHROW usleep( useconds_t )__MINGW_ATTRIB_DEPRECATED;
@@ -123,9 +124,12 @@ unsigned sleep( unsigned period ){ return __mingw_sleep( period, 0 ); }
  * Microsoft's _chsize() function is incorrectly described, on MSDN,
  * as a preferred replacement for the POSIX chsize() function.  There
  * never was any such POSIX function; the actual POSIX equivalent is
- * the ftruncate() function.
+ * the ftruncate() function.  However, we do not delegate to _chsize(),
+ * because it fills any extension of the file with explicitly written
+ * zeros, in small blocks; we delegate to ftruncate64() instead.
  */
 int __cdecl ftruncate( int, off_t );
+int __cdecl ftruncate64( int, __off64_t );
 
 #ifndef dup2
 /* Microsoft's implementation of dup2(), (which is documented as being a
@@ -145,18 +149,17 @@ __cdecl __MINGW_NOTHROW  int dup2 (int __fd1, int __fd2)
 #endif	/* ! defined dup2 */
 
 #ifndef __NO_INLINE__
-__CRT_INLINE __JMPSTUB__(( FUNCTION = ftruncate, DLLENTRY = _chsize ))
-int ftruncate( int __fd, off_t __length ){ return _chsize( __fd, __length ); }
+__CRT_INLINE __LIBIMPL__(( FUNCTION = ftruncate ))
+int ftruncate( int __fd, off_t __length ){ return ftruncate64( __fd, __length ); }
 #endif
 
 /* Although non-standard, GCC's C++ library from GCC-9.x gratuitously
- * assumes, and requires, this 64-bit off_t variant to be available; it
- * could be emulated by Microsoft's _chsize_s() function, which is only
- * supported from Vista onward; therefore, to ensure support on legacy
- * platforms, we prefer our own libmingwex.a implementation, and so,
- * we do not provide an inline implementation.
+ * assumes, and requires, the 64-bit off_t variant, ftruncate64(), (as
+ * declared above), to be available; it could be emulated by Microsoft's
+ * _chsize_s() function, which is only supported from Vista onward, but
+ * we prefer our own libmingwex.a implementation, and so, we do not
+ * provide an inline implementation.
  */
-int __cdecl ftruncate64( int, __off64_t );
 
 _END_C_DECLS
 
@@ -0,0 +1,219 @@
+/*
+ * arc4random.c
+ *
+ * Implementation of the BSD arc4random(3) family of functions, providing
+ * a fast source of cryptographically secure pseudo-random data.  Each
+ * thread maintains its own ChaCha20 key stream generator, seeded from the
+ * operating system's cryptographic provider, and refilled in blocks; the
+ * key is replaced after every refill, so that previously delivered data
+ * cannot be reconstructed from any later state of the generator.
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ARC4RANDOM_INLINE  static __inline__ __attribute__((__always_inline__))
+
+/* Each refill generates ARC4RANDOM_BLOCKS blocks of key stream, of which
+ * the first ARC4RANDOM_KEYLEN bytes, (sufficient for a 256-bit key, and a
+ * 96-bit nonce), become the next key, and the remainder is delivered to
+ * callers; fresh entropy is mixed in from the operating system after at
+ * most ARC4RANDOM_RESEED bytes have been delivered.
+ */
+#define ARC4RANDOM_BLOCKS	8
+#define ARC4RANDOM_KEYLEN	(32 + 12)
+#define ARC4RANDOM_BUFSIZ	(64 * ARC4RANDOM_BLOCKS)
+#define ARC4RANDOM_RESEED	(1600 * 1024)
+
+void *__mingw_crypto_randomize( void *, size_t );
+void __mingw_chacha20_block( unsigned char *, const uint32_t * );
+
+static __thread struct
+{ /* The per-thread generator state; since it is never shared between
+   * threads, it requires no locking.
+   */
+  uint32_t	 input[16];
+  unsigned char  buffer[ARC4RANDOM_BUFSIZ];
+  size_t	 available;
+  size_t	 budget;
+  int		 seeded;
+} rs;
+
+ARC4RANDOM_INLINE uint32_t arc4random_load( const unsigned char *input )
+{
+  /* Helper to retrieve a 32-bit word, from little-endian byte order.
+   */
+  return (uint32_t)(input[0]) | ((uint32_t)(input[1]) << 8)
+    | ((uint32_t)(input[2]) << 16) | ((uint32_t)(input[3]) << 24);
+}
+
+static void arc4random_wipe( void *buf, size_t len )
+{
+  /* Helper to clear key material which is no longer required; writing
+   * through a volatile pointer prevents the compiler from discarding
+   * what it may otherwise consider to be dead stores.
+   */
+  volatile unsigned char *p = buf;
+  while( len-- > 0 ) *p++ = 0;
+}
+
+static void arc4random_rekey( const unsigned char *key )
+{
+  /* Helper to load a new key, and nonce, into the generator state,
+   * from ARC4RANDOM_KEYLEN bytes at "key", resetting the block counter.
+   */
+  static const unsigned char sigma[] = "expand 32-byte k";
+  int i;
+
+  for( i = 0; i < 4; i++ )
+    rs.input[i] = arc4random_load( sigma + 4 * i );
+  for( i = 0; i < 8; i++ )
+    rs.input[4 + i] = arc4random_load( key + 4 * i );
+  rs.input[12] = 0;
+  for( i = 0; i < 3; i++ )
+    rs.input[13 + i] = arc4random_load( key + 32 + 4 * i );
+}
+
+static void arc4random_refill( const unsigned char *entropy )
+{
+  /* Helper to refill the buffer with fresh key stream, from which the
+   * next key is immediately extracted, after optionally mixing in the
+   * specified ARC4RANDOM_KEYLEN bytes of "entropy".
+   */
+  int i;
+  for( i = 0; i < ARC4RANDOM_BLOCKS; i++, rs.input[12]++ )
+    __mingw_chacha20_block( rs.buffer + 64 * i, rs.input );
+
+  if( entropy != NULL )
+    for( i = 0; i < ARC4RANDOM_KEYLEN; i++ )
+      rs.buffer[i] ^= entropy[i];
+
+  /* Replace the key, then erase the bytes which have become the key,
+   * so that they can never be delivered.
+   */
+  arc4random_rekey( rs.buffer );
+  arc4random_wipe( rs.buffer, ARC4RANDOM_KEYLEN );
+  rs.available = ARC4RANDOM_BUFSIZ - ARC4RANDOM_KEYLEN;
+}
+
+static int arc4random_stir( void )
+{
+  /* Helper to seed the generator from the operating system's
+   * cryptographic provider, when first used, or to mix fresh entropy
+   * from that provider into an established generator state, when the
+   * reseed budget has been exhausted; returns non-zero on failure.
+   */
+  unsigned char entropy[ARC4RANDOM_KEYLEN];
+  if( __mingw_crypto_randomize( entropy, sizeof( entropy ) ) == NULL )
+    return -1;
+
+  if( rs.seeded )
+    arc4random_refill( entropy );
+  else
+  { arc4random_rekey( entropy );
+    rs.seeded = 1;
+  }
+  arc4random_wipe( entropy, sizeof( entropy ) );
+
+  /* Discard any key stream which remains buffered, so that the next
+   * request is satisfied entirely from the newly stirred state.
+   */
+  arc4random_wipe( rs.buffer, sizeof( rs.buffer ) );
+  rs.available = 0;
+  rs.budget = ARC4RANDOM_RESEED;
+  return 0;
+}
+
+void *__mingw_arc4random_fill( void *buf, size_t len )
+{
+  /* Fill the specified buffer with "len" pseudo-random bytes, returning
+   * a pointer to it, or NULL, if the generator could not be seeded.
+   */
+  unsigned char *p = buf;
+  while( len > 0 )
+  {
+    size_t count;
+    if( (rs.budget == 0) && (arc4random_stir() != 0) )
+      return NULL;
+
+    if( rs.available == 0 )
+      arc4random_refill( NULL );
+
+    /* Deliver as much as is available, or is requested, from the top
+     * of the buffered key stream, erasing it as it is delivered.
+     */
+    count = (len < rs.available) ? len : rs.available;
+    if( count > rs.budget ) count = rs.budget;
+    memcpy( p, rs.buffer + ARC4RANDOM_BUFSIZ - rs.available, count );
+    arc4random_wipe( rs.buffer + ARC4RANDOM_BUFSIZ - rs.available, count );
+    rs.available -= count; rs.budget -= count;
+    p += count; len -= count;
+  }
+  return buf;
+}
+
+void __mingw_arc4random_buf( void *buf, size_t len )
+{
+  /* Public interface to __mingw_arc4random_fill(); like its BSD
+   * counterpart, this cannot report failure, so if the generator
+   * cannot be seeded, there is nothing sensible we can do, other
+   * than to abort.
+   */
+  if( __mingw_arc4random_fill( buf, len ) == NULL )
+    abort();
+}
+
+unsigned int __mingw_arc4random( void )
+{
+  /* Return a uniformly distributed 32-bit pseudo-random value.
+   */
+  uint32_t value;
+  __mingw_arc4random_buf( &value, sizeof( value ) );
+  return value;
+}
+
+unsigned int __mingw_arc4random_uniform( unsigned int upper_bound )
+{
+  /* Return a pseudo-random value, uniformly distributed in the range
+   * zero to (upper_bound - 1), inclusive; to avoid modulo bias, we
+   * reject any value less than (2**32 % upper_bound), so that the
+   * range from which we accept values is an exact multiple of the
+   * upper bound.
+   */
+  uint32_t value, min;
+  if( upper_bound < 2 )
+    return 0;
+
+  min = -(uint32_t)(upper_bound) % upper_bound;
+  do { value = __mingw_arc4random(); } while( value < min );
+  return value % upper_bound;
+}
+
+/* $RCSfile$: end of file */
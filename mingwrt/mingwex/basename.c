@@ -7,7 +7,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2006, 2007, 2014, 2022, MinGW.OSDN Project
+ * Copyright (C) 2006, 2007, 2014, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -36,16 +36,99 @@
 #include <libgen.h>
 #include <locale.h>
 
+#include "pathscan.h"
+
 #ifndef __cdecl  /* If compiling on any non-Win32 platform ... */
 #define __cdecl  /* this may not be defined.                   */
 #endif
 
+static char *basename_bytewise( char *path )
+{
+  /* Resolve the base name of path, when pathscan_is_bytewise() has
+   * confirmed that it may be scanned byte by byte; this follows the
+   * same logic as the wide character scan, in __mingw_basename(), but
+   * it operates directly on the caller's buffer, with no need for any
+   * transformation, or for any change of locale.
+   */
+  static char retfail[2];
+
+  if( path && *path )
+  {
+    char *refpath, *refname;
+
+    /* step over the drive designator, if present ... */
+
+    if( path[1] == ':' )
+      path += 2;
+
+    if( *path )
+    {
+      /* scan from left to right, to the char after the final dir separator */
+
+      for( refname = refpath = path ; *refpath ; ++refpath )
+      {
+	if( pathscan_is_separator( *refpath ) )
+	{
+	  /* we found a dir separator ...
+	   * step over it, and any others which immediately follow it
+	   */
+
+	  while( pathscan_is_separator( *refpath ) )
+	    ++refpath;
+
+	  /* if we didn't reach the end of the path string,
+	   * then we have a new candidate for the base name ...
+	   */
+
+	  if( *refpath )
+	    refname = refpath;
+
+	  /* otherwise, we must not overrun the terminating NUL */
+
+	  else
+	    break;
+	}
+      }
+
+      /* if the candidate base name is a dir separator, then the path
+       * comprised only dir separators, so return the default value of
+       * "/", in our own buffer, leaving the caller's path unchanged.
+       */
+
+      if( pathscan_is_separator( *refname ) )
+	return strcpy( retfail, "/" );
+
+      /* otherwise, strip off any trailing dir separators,
+       * and return the resolved base name.
+       */
+
+      while( pathscan_is_separator( *--refpath ) )
+	*refpath = '\0';
+      return refname;
+    }
+  }
+
+  /* path is NULL, or it decomposes to an empty string; return the
+   * default value of ".", (reloaded, in case the caller trashed it).
+   */
+
+  return strcpy( retfail, "." );
+}
+
 __cdecl char *__mingw_basename( char *path )
 {
   size_t len;
   static char *retfail = NULL;
 
-  /* to handle path names for files in multibyte character locales,
+  /* for a path name which may safely be scanned byte by byte, (which is
+   * always the case for ASCII, UTF-8, or any single byte code page), we
+   * may avoid the overhead of the wide character transformation below.
+   */
+
+  if( pathscan_is_bytewise( path ) )
+    return basename_bytewise( path );
+
+  /* to handle path names for files in DBCS multibyte character locales,
    * we need to set up LC_CTYPE to match the host file system locale
    */
 
@@ -0,0 +1,90 @@
+/*
+ * chacha20.c
+ *
+ * Implementation of the ChaCha20 block function, as specified by RFC 8439;
+ * this is the core of the arc4random(3) pseudo-random byte generator.  It
+ * depends on nothing beyond standard C, so that it may be checked against
+ * the RFC's known answer vectors on any host.
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdint.h>
+
+#define CHACHA_INLINE  static __inline__ __attribute__((__always_inline__))
+
+#define CHACHA_ROTATE( v, n )  (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define CHACHA_QUARTER_ROUND( x, a, b, c, d )				\
+  x[a] += x[b]; x[d] ^= x[a]; x[d] = CHACHA_ROTATE( x[d], 16 );		\
+  x[c] += x[d]; x[b] ^= x[c]; x[b] = CHACHA_ROTATE( x[b], 12 );		\
+  x[a] += x[b]; x[d] ^= x[a]; x[d] = CHACHA_ROTATE( x[d],  8 );		\
+  x[c] += x[d]; x[b] ^= x[c]; x[b] = CHACHA_ROTATE( x[b],  7 )
+
+CHACHA_INLINE void chacha_store( unsigned char *output, uint32_t value )
+{
+  /* Helper to store a 32-bit word, in little-endian byte order,
+   * regardless of the byte order of the host.
+   */
+  output[0] = value; output[1] = value >> 8;
+  output[2] = value >> 16; output[3] = value >> 24;
+}
+
+void __mingw_chacha20_block( unsigned char *output, const uint32_t *input )
+{
+  /* Generate one 64-byte block of ChaCha20 key stream, from the sixteen
+   * word state vector at "input", (comprising the four constant words,
+   * the eight key words, the block counter, and the three nonce words,
+   * in that order); the caller is responsible for advancing the block
+   * counter, before requesting a subsequent block.
+   */
+  uint32_t x[16]; int i;
+
+  for( i = 0; i < 16; i++ )
+    x[i] = input[i];
+
+  /* Perform twenty rounds, as ten iterations of alternating column
+   * and diagonal rounds...
+   */
+  for( i = 0; i < 10; i++ )
+  {
+    CHACHA_QUARTER_ROUND( x, 0, 4,  8, 12 );
+    CHACHA_QUARTER_ROUND( x, 1, 5,  9, 13 );
+    CHACHA_QUARTER_ROUND( x, 2, 6, 10, 14 );
+    CHACHA_QUARTER_ROUND( x, 3, 7, 11, 15 );
+    CHACHA_QUARTER_ROUND( x, 0, 5, 10, 15 );
+    CHACHA_QUARTER_ROUND( x, 1, 6, 11, 12 );
+    CHACHA_QUARTER_ROUND( x, 2, 7,  8, 13 );
+    CHACHA_QUARTER_ROUND( x, 3, 4,  9, 14 );
+  }
+  /* ...then add in the original state, and serialize the result.
+   */
+  for( i = 0; i < 16; i++ )
+    chacha_store( output + 4 * i, x[i] + input[i] );
+}
+
+/* $RCSfile$: end of file */
@@ -6,7 +6,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2017, 2018, 2022, MinGW.OSDN Project
+ * Copyright (C) 2017, 2018, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -30,6 +30,7 @@
  *
  */
 #include "clockapi.h"
+#include <stdlib.h>
 
 static struct __clockid__ clock_api[] =
 { { /* CLOCK_REALTIME pre-initialization implementation reference data.
@@ -45,9 +46,89 @@ static struct __clockid__ clock_api[] =
     NANOSECONDS_PER_SECOND,	/* Update frequency; needs initialization */
     0LL,			/* Resolution in ns; needs initialization */
     0LL 			/* Fixed timebase reference */
+  },
+  { /* CLOCK_PROCESS_CPUTIME_ID pre-initialization reference data.
+     */
+    CLOCK_TYPE_PROCESS_CPUTIME,	/* Fixed category index */
+    CLOCK_REALTIME_FREQUENCY,	/* Always counted at this frequency */
+    0LL,			/* Resolution in ns; needs initialization */
+    0LL 			/* Fixed timebase reference */
+  },
+  { /* CLOCK_THREAD_CPUTIME_ID pre-initialization reference data.
+     */
+    CLOCK_TYPE_THREAD_CPUTIME,	/* Fixed category index */
+    CLOCK_REALTIME_FREQUENCY,	/* Always counted at this frequency */
+    0LL,			/* Resolution in ns; needs initialization */
+    0LL 			/* Fixed timebase reference */
+  },
+  { /* CLOCK_REALTIME_COARSE pre-initialization reference data; (since
+     * CLOCK_REALTIME is already read at the system clock interrupt
+     * granularity, this is simply an alias for it).
+     */
+    CLOCK_TYPE_REALTIME,	/* Fixed category index */
+    CLOCK_REALTIME_FREQUENCY,	/* Always updated at this frequency */
+    0LL,			/* Resolution in ns; needs initialization */
+    UNIX_EPOCH_AS_FILETIME	/* Fixed timebase reference */
+  },
+  { /* CLOCK_MONOTONIC_COARSE pre-initialization reference data.
+     */
+    CLOCK_TYPE_MONOTONIC_COARSE,/* Fixed category index */
+    CLOCK_REALTIME_FREQUENCY,	/* Always counted at this frequency */
+    0LL,			/* Resolution in ns; needs initialization */
+    0LL 			/* Fixed timebase reference */
   }
 };
 
+static int64_t clock_api_interrupt_interval( void )
+{
+  /* Initialization helper, to determine the interval, in nanoseconds,
+   * between successive system clock interrupts; this is the effective
+   * resolution of the system time, of the interrupt time, and of the
+   * process and thread CPU times, all of which are updated only when
+   * such an interrupt occurs.
+   */
+  union { int64_t value; FILETIME rtc_value; } ref, now;
+  DWORD adjustment, increment; BOOL disabled;
+
+  /* The interval is reported, as a count of 100ns units, by the
+   * GetSystemTimeAdjustment() API...
+   */
+  if( GetSystemTimeAdjustment( &adjustment, &increment, &disabled )
+  &&  (increment > 0)  )
+    return increment * 100LL;
+
+  /* ...but, should that fail, we may measure it, reading the system
+   * time once, then again in a busy wait loop, until we detect a
+   * change, and compute the actual update interval between the two
+   * reported values.
+   */
+  GetSystemTimeAsFileTime( &ref.rtc_value );
+  do { GetSystemTimeAsFileTime( &now.rtc_value );
+     } while( now.value == ref.value );
+  return (now.value - ref.value) * 100LL;
+}
+
+CLOCK_INLINE
+int64_t clock_api_set_scale( clockid_t clock_api, int64_t resolution )
+{
+  /* Initialization helper, to compute the factors which allow the
+   * clock_gettime() function to convert clock ticks to seconds and
+   * nanoseconds without division; the reciprocal of the frequency
+   * yields the seconds, and the remainder is converted directly to
+   * nanoseconds, by multiplication, when the tick interval is an
+   * exact number of nanoseconds, (otherwise by the reciprocal).
+   */
+  clock_api->reciprocal = clock_div_reciprocal( clock_api->frequency );
+  clock_api->tick_interval = ((NANOSECONDS_PER_SECOND % clock_api->frequency) == 0LL)
+    ? NANOSECONDS_PER_SECOND / clock_api->frequency : 0LL;
+
+  /* The resolution must be stored last, since any other thread which
+   * sees it as initialized will assume that the scale factors are so.
+   */
+  __sync_synchronize();
+  return clock_api->resolution = resolution;
+}
+
 CLOCK_INLINE
 int64_t clock_api_getres_interval( clockid_t clock_api )
 {
@@ -66,42 +147,51 @@ int64_t clock_api_getres_interval( clockid_t clock_api )
      */
     switch( clock_api->type )
     {
-      /* We must be prepared to retrieve clock frequencies from Windows
-       * APIs, which report either LARGE_INTEGER or FILETIME values, but
-       * we prefer to interpret them as scalar int64_t values.
+      /* We must be prepared to retrieve the QPC clock frequency from
+       * a Windows API which reports a LARGE_INTEGER value, but we prefer
+       * to interpret it as a scalar int64_t value.
        */
-      union { int64_t value; LARGE_INTEGER qpc_value; FILETIME rtc_value; }
-	freq;
+      union { int64_t value; LARGE_INTEGER qpc_value; } freq;
+
+      case CLOCK_TYPE_MONOTONIC_COARSE:
+	/* Clocks in this category read the interrupt time, from the
+	 * KUSER_SHARED_DATA structure which is mapped into every process
+	 * by WinNT; Win9x provides no such mapping, so on Win9x, we must
+	 * mark such clocks as unavailable.
+	 */
+	if( (_osver & 0x8000) != 0 )
+	  break;
 
       case CLOCK_TYPE_REALTIME:
 	/* Clocks in this category use the GetSystemTimeAsFileTime() API
 	 * to read the system clock; although this is nominally updated at
 	 * 100ns intervals, it is unrealistic to expect resolution at such
-	 * a high frequency.  Thus, we read it once, then again in a busy
-	 * wait loop, until we detect a change, and compute the actual
-	 * update interval between the two reported values.
+	 * a high frequency; in practice, it advances only at each system
+	 * clock interrupt, (as does the interrupt time, which is similarly
+	 * counted in 100ns intervals)...
 	 */
-	GetSystemTimeAsFileTime( &freq.rtc_value );
-	clock_api->resolution = freq.value;
-	do { GetSystemTimeAsFileTime( &freq.rtc_value );
-	   } while( freq.value == clock_api->resolution );
-	freq.value -= clock_api->resolution;
-
-	/* Ultimately, we initialize the effective resolution, converting
-	 * from this indicated count of 100ns intervals, to nanoseconds.
+      case CLOCK_TYPE_PROCESS_CPUTIME:
+      case CLOCK_TYPE_THREAD_CPUTIME:
+	/* ...as are the CPU times, which are charged to each process,
+	 * or thread, at each such interrupt.
 	 */
-	return clock_api->resolution = freq.value * 100LL;
+	return clock_api_set_scale( clock_api, clock_api_interrupt_interval() );
 
       case CLOCK_TYPE_MONOTONIC:
 	/* Clocks in this category use the QueryPerformanceCounter() API
 	 * to count arbitrarily scaled time slices, relative to an equally
 	 * arbitrary timebase; we must use the QueryPerformanceFrequency()
 	 * call to verify availability of this API, and to establish its
-	 * update frequency and resolution in nanoseconds.
+	 * update frequency and resolution in nanoseconds, (which we must
+	 * round up, lest it be reported as zero, for a frequency which
+	 * exceeds 1GHz).
 	 */
 	if( QueryPerformanceFrequency( &freq.qpc_value ) && (freq.value > 0LL) )
-	  return clock_api->resolution = NANOSECONDS_PER_SECOND
-	    / (clock_api->frequency = freq.value);
+	{ clock_api->frequency = freq.value;
+	  return clock_api_set_scale( clock_api,
+	      (NANOSECONDS_PER_SECOND + freq.value - 1LL) / freq.value
+	    );
+	}
 
       /* In any other case, (implicitly including CLOCK_TYPE_UNIMPLEMENTED),
        * we may simply fall through to the default error return, (but note
@@ -6,7 +6,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2017, 2018, 2022, MinGW.OSDN Project
+ * Copyright (C) 2017, 2018, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -39,6 +39,9 @@ typedef enum
    */
   CLOCK_TYPE_REALTIME,		/* CLOCK_REALTIME and derivatives */
   CLOCK_TYPE_MONOTONIC, 	/* CLOCK_MONOTONIC and derivatives */
+  CLOCK_TYPE_MONOTONIC_COARSE,	/* CLOCK_MONOTONIC_COARSE */
+  CLOCK_TYPE_PROCESS_CPUTIME,	/* CLOCK_PROCESS_CPUTIME_ID */
+  CLOCK_TYPE_THREAD_CPUTIME,	/* CLOCK_THREAD_CPUTIME_ID */
 
   /* Only the above represent valid clock categories; we end the
    * enumeration with this comparator reference value, to which,
@@ -68,8 +71,16 @@ typedef struct __attribute__((__aligned__(4))) __clockid__
   int64_t	frequency;
   int64_t	resolution;
   int64_t	timebase;
+  uint64_t	reciprocal;
+  uint64_t	tick_interval;
 } *clockid_t;
 
+/* The "reciprocal" and "tick_interval" fields are derived from the
+ * "frequency", when the clock is initialized; they allow clock ticks
+ * to be converted to seconds and nanoseconds without any division.
+ */
+#include "clockdiv.h"
+
 /* Prototype for clockid_t validation function; considered private
  * within the scope of the implementation, (so not declared publicly),
  * this also provides initialization support.
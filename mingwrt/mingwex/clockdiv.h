@@ -0,0 +1,100 @@
+/*
+ * clockdiv.h
+ *
+ * Private header, providing division free conversion of clock tick counts
+ * to seconds and nanoseconds, for the POSIX clock API; (it depends on no
+ * more than <stdint.h>, so that it may be checked on any host).
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdint.h>
+
+#define CLOCK_DIV_INLINE  static __inline__ __attribute__((__always_inline__))
+
+CLOCK_DIV_INLINE
+uint64_t clock_div_reciprocal( uint64_t divisor )
+{ /* Compute the reciprocal, scaled by 2**64, which clock_div() uses
+   * to divide by the specified non-zero "divisor"; this is the only
+   * division to be performed, once only, when a clock is initialized.
+   */
+  return UINT64_MAX / divisor;
+}
+
+CLOCK_DIV_INLINE
+uint64_t clock_div_mulhi( uint64_t a, uint64_t b )
+{ /* Compute the high order 64-bits of the 128-bit product of "a" and
+   * "b", using only 32-bit by 32-bit multiplications, (which are all
+   * that i386 offers).
+   */
+  uint64_t lo = (uint64_t)((uint32_t)(a)) * (uint32_t)(b);
+  uint64_t m1 = (a >> 32) * (uint32_t)(b);
+  uint64_t m2 = (uint64_t)((uint32_t)(a)) * (b >> 32);
+  uint64_t mid = (lo >> 32) + (uint32_t)(m1) + (uint32_t)(m2);
+  return (a >> 32) * (b >> 32) + (m1 >> 32) + (m2 >> 32) + (mid >> 32);
+}
+
+CLOCK_DIV_INLINE
+uint64_t clock_div( uint64_t value, uint64_t divisor, uint64_t reciprocal,
+    uint64_t *remainder )
+{ /* Divide "value" by "divisor", given its "reciprocal", as computed
+   * by clock_div_reciprocal(); the quotient is returned, and the
+   * remainder is stored at "remainder".
+   *
+   * Since the reciprocal is truncated, it falls short of the exact
+   * (2**64 / divisor) by less than one; the high order product, for
+   * any "value" less than 2**64, thus falls short of the true ratio
+   * by less than one, and so may underestimate the quotient by no
+   * more than one.  A single corrective step is therefore sufficient
+   * to deliver the exact quotient, and remainder.
+   */
+  uint64_t quotient = clock_div_mulhi( value, reciprocal );
+  value -= quotient * divisor;
+  if( value >= divisor )
+  { value -= divisor;
+    ++quotient;
+  }
+  *remainder = value;
+  return quotient;
+}
+
+CLOCK_DIV_INLINE
+uint64_t clock_div_nanoseconds( uint64_t ticks, uint64_t frequency,
+    uint64_t reciprocal, uint64_t tick_interval )
+{ /* Convert a count of "ticks", which must be less than "frequency",
+   * to nanoseconds, truncating any fraction; when "tick_interval" is
+   * non-zero, it represents the exact number of nanoseconds in each
+   * tick, and a single multiplication suffices, otherwise we must
+   * scale by one thousand million, and then divide by "frequency",
+   * (which must not exceed UINT64_MAX / 1000000000).
+   */
+  if( tick_interval == 0 )
+    return clock_div( ticks * 1000000000ULL, frequency, reciprocal, &ticks );
+  return ticks * tick_interval;
+}
+
+/* $RCSfile$: end of file */
@@ -6,7 +6,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2017, 2018, 2022, MinGW.OSDN Project
+ * Copyright (C) 2017, 2018, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -31,6 +31,40 @@
  */
 #include "clockapi.h"
 
+CLOCK_INLINE
+uint64_t clock_interrupt_time( void )
+{
+  /* Helper to read the interrupt time, i.e. the count of 100ns units
+   * since system start-up, as updated at each clock interrupt; this is
+   * maintained by the kernel, in the KUSER_SHARED_DATA structure which
+   * is mapped at a fixed address into every process, on every version
+   * of WinNT.  Its two copies of the high order word are written before,
+   * and after, the low order word respectively, so a mismatch between
+   * them indicates that we raced with an update, and must try again.
+   */
+  volatile struct { ULONG low; LONG high1, high2; }
+    *interrupt_time = (void *)(0x7FFE0008);
+  ULONG low; LONG high;
+  do { high = interrupt_time->high1; low = interrupt_time->low;
+     } while( high != interrupt_time->high2 );
+  return ((uint64_t)(high) << 32) | low;
+}
+
+CLOCK_INLINE
+int clock_cpu_time( BOOL WINAPI (*query)( HANDLE, LPFILETIME, LPFILETIME,
+    LPFILETIME, LPFILETIME ), HANDLE owner, uint64_t *ticks )
+{
+  /* Helper to retrieve the combined kernel and user mode CPU times,
+   * as reported by either GetProcessTimes(), or GetThreadTimes(), for
+   * the specified owner; returns zero, if the query fails.
+   */
+  union { uint64_t value; FILETIME ft; } t[4];
+  if( query( owner, &t[0].ft, &t[1].ft, &t[2].ft, &t[3].ft ) == 0 )
+    return 0;
+  *ticks = t[2].value + t[3].value;
+  return 1;
+}
+
 int clock_gettime( clockid_t clock_id, struct timespec *current )
 {
   /* Standard API function, first implemented in POSIX.1b-1993, to
@@ -54,6 +88,7 @@ int clock_gettime( clockid_t clock_id, struct timespec *current )
      * we prefer to interpret them as scalar int64_t values.
      */
     union { uint64_t value; LARGE_INTEGER qpc_value; FILETIME rtc_value; } ct;
+    uint64_t ticks;
     switch( clock_id->type )
     {
       case CLOCK_TYPE_REALTIME:
@@ -66,10 +101,34 @@ int clock_gettime( clockid_t clock_id, struct timespec *current )
 
       case CLOCK_TYPE_MONOTONIC:
 	/* Conversely, the counter for CLOCK_MONOTIME and derivatives
-	 * is obtained from the Windows QPC API, if supported...
+	 * is obtained from the Windows QPC API, if supported.
 	 */
 	if( QueryPerformanceCounter( &ct.qpc_value ) > 0 )
 	  break;
+	return clock_api_invalid_error();
+
+      case CLOCK_TYPE_MONOTONIC_COARSE:
+	/* The counter for CLOCK_MONOTONIC_COARSE is the interrupt time,
+	 * which may be read directly from memory, without any system call.
+	 */
+	ct.value = clock_interrupt_time();
+	break;
+
+      case CLOCK_TYPE_PROCESS_CPUTIME:
+	/* The counter for CLOCK_PROCESS_CPUTIME_ID is the total CPU time,
+	 * in both kernel and user mode, consumed by the calling process...
+	 */
+	if( clock_cpu_time( GetProcessTimes, GetCurrentProcess(), &ct.value ) )
+	  break;
+	return clock_api_invalid_error();
+
+      case CLOCK_TYPE_THREAD_CPUTIME:
+	/* ...while that for CLOCK_THREAD_CPUTIME_ID is similarly the CPU
+	 * time consumed by the calling thread, (neither of which may be
+	 * available on Win9x, in which case the call fails).
+	 */
+	if( clock_cpu_time( GetThreadTimes, GetCurrentThread(), &ct.value ) )
+	  break;
 
       /* ...or otherwise, fall through, to force an "invalid status"
        * return, as we do for any other clock type designation, (which
@@ -79,17 +138,20 @@ int clock_gettime( clockid_t clock_id, struct timespec *current )
        */
       default: return clock_api_invalid_error();
     }
-    /* In either case, once we have a valid count of clock ticks, we
+    /* In any case, once we have a valid count of clock ticks, we
      * must adjust it, relative to the timebase for the clock, (which
      * is recorded within the clock's implementation data structure),
      * then scale it, and break it down into seconds and nanoseconds
      * components, (again based on scaling factors which are similarly
-     * recorded within the implementation data)...
+     * recorded within the implementation data, and chosen such that
+     * no division is required)...
      */
-    ct.value -= clock_id->timebase;
-    current->tv_nsec = (ct.value % clock_id->frequency)
-      * NANOSECONDS_PER_SECOND / clock_id->frequency;
-    current->tv_sec = ct.value / clock_id->frequency;
+    current->tv_sec = clock_div( ct.value - clock_id->timebase,
+	clock_id->frequency, clock_id->reciprocal, &ticks
+      );
+    current->tv_nsec = clock_div_nanoseconds( ticks, clock_id->frequency,
+	clock_id->reciprocal, clock_id->tick_interval
+      );
 
     /* ...before returning zero, as "successful completion" status...
      */
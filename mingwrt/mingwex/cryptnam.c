@@ -10,7 +10,7 @@
  * $Id$
  *
  * Written by Keith Marshall  <keith@users.osdn.me>
- * Copyright (C) 2013, 2014, 2018-2020, 2022, MinGW.OSDN Project
+ * Copyright (C) 2013, 2014, 2018-2020, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -38,9 +38,15 @@
 
 #define CRYPTO_INLINE  static __inline__ __attribute__((__always_inline__))
 
-void *__mingw_crypto_randomize( void *, size_t );
+/* Random bytes are drawn from the buffered, per-thread arc4random(3)
+ * generator, which is seeded from the wincrypt API only once, rather
+ * than by calling on the wincrypt API for each character; unlike the
+ * public arc4random_buf(3), this reports, rather than aborts on, any
+ * failure to seed the generator.
+ */
+void *__mingw_arc4random_fill( void *, size_t );
 CRYPTO_INLINE void *crypto_randomize( void *buf, size_t buflen )
-{ return __mingw_crypto_randomize( buf, buflen ); }
+{ return __mingw_arc4random_fill( buf, buflen ); }
 
 CRYPTO_INLINE
 unsigned char *crypto_random_filename_char( unsigned char *caret )
@@ -95,7 +101,8 @@ unsigned char *crypto_random_filename_char( unsigned char *caret )
 
 char *__mingw_crypto_tmpname( char *template )
 {
-  /* Helper function, based on Microsoft's wincrypt API, to construct
+  /* Helper function, based on a cryptographically secure generator
+   * which is seeded by Microsoft's wincrypt API, to construct
    * the candidate names for temporary files, both in a less predictable
    * manner than Microsoft's _mktemp() function, and without suffering
    * its inherent limitation of allowing no more than 26 file names
@@ -18,7 +18,7 @@
  * Further significantly revised for improved memory utilisation,
  * efficiency in operation, and better POSIX standards compliance
  * by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 1997, 2001-2006, 2014, 2017, 2022, MinGW.OSDN Project
+ * Copyright (C) 1997, 2001-2006, 2014, 2017, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -42,6 +42,7 @@
  *
  */
 #include <stdlib.h>
+#include <stddef.h>
 #include <errno.h>
 #include <string.h>
 #include <dirent.h>
@@ -74,6 +75,12 @@ struct __dirstream_t
    */
   struct dirent 	dd_dirent;
 
+  /* Supplementary attributes of the entry currently represented by
+   * dd_dirent, as retrieved by the same search; readdirx() returns
+   * them, so that callers need not stat() each entry in turn.
+   */
+  struct dirent_stat	dd_stat;
+
   /* Handle, for use when performing FindFirstFile()/FindNextFile()
    * file system searches.
    */
@@ -103,6 +110,12 @@ struct __wdirstream_t
    */
   struct _wdirent	dd_dirent;
 
+  /* Supplementary attributes of the entry currently represented by
+   * dd_dirent, as retrieved by the same search; readdirx() returns
+   * them, so that callers need not stat() each entry in turn.
+   */
+  struct dirent_stat	dd_stat;
+
   /* Handle, for use when performing FindFirstFile()/FindNextFile()
    * file system searches.
    */
@@ -160,17 +173,29 @@ struct __wdirstream_t
  */
 #define NUL		((_TCHAR)(0))
 
+static __inline__ __attribute__((__always_inline__))
+__time64_t dirent_time( FILETIME *ft )
+{
+  /* Helper function, to convert a FILETIME, (counting 100ns intervals
+   * from 1-Jan-1601), to the equivalent count of seconds from the Unix
+   * epoch, (1-Jan-1970), as would be reported by stat().
+   */
+  return ((((__int64)(ft->dwHighDateTime) << 32) | ft->dwLowDateTime)
+      / 10000000LL) - 11644473600LL;
+}
+
 static
-void dirent_update( struct _tdirent *dd, WIN32_FIND_DATA *fd )
+void dirent_update( _TDIR *dirp, WIN32_FIND_DATA *fd )
 {
   /* Helper function, used by dirent_findfirst() and dirent_findnext(),
    * to transfer all relevant data from their respective WIN32_FIND_DATA
-   * buffers to the specified dirent structure; in the case of the d_name
-   * field, we want the effect of a snprintf() string transfer, but to
-   * avoid the (perceptually significant) overhead of format parsing,
-   * we simulate it with an inline character-by-character counted
-   * string copy loop...
+   * buffers to the dirent structure within the specified DIR; in the case
+   * of the d_name field, we want the effect of a snprintf() string transfer,
+   * but to avoid the (perceptually significant) overhead of format parsing,
+   * we simulate it with an inline character-by-character counted string
+   * copy loop...
    */
+  struct _tdirent *dd = &dirp->dd_dirent;
   _TCHAR *d_name = dd->d_name;
   for( dd->d_namlen = 0; (*d_name = fd->cFileName[dd->d_namlen]) != NUL; )
     /*
@@ -184,19 +209,71 @@ void dirent_update( struct _tdirent *dd, WIN32_FIND_DATA *fd )
    */
   if( (dd->d_type = fd->dwFileAttributes & DT_VALID_BITS) > DT_DIR )
     dd->d_type = DT_UNKNOWN;
+
+  /* The search has also furnished the size, time stamps, and complete
+   * set of attributes for the entry; keep them, for readdirx().
+   */
+  dirp->dd_stat.d_attrib = fd->dwFileAttributes;
+  dirp->dd_stat.d_size = ((__int64)(fd->nFileSizeHigh) << 32) | fd->nFileSizeLow;
+  dirp->dd_stat.d_atime = dirent_time( &fd->ftLastAccessTime );
+  dirp->dd_stat.d_mtime = dirent_time( &fd->ftLastWriteTime );
+  dirp->dd_stat.d_ctime = dirent_time( &fd->ftCreationTime );
 }
 
+/* Where FindFirstFileEx() is available, we prefer it to FindFirstFile();
+ * from Windows-7 onwards, it accepts the following pair of options, which
+ * our w32api headers do not yet define, to suppress the look-up of 8.3
+ * alternate file names, which we never use, and to have the file system
+ * return entries in large batches, rather than few at a time, to each
+ * FindNextFile() call.  We must resolve the function at run time, since
+ * it is not supported on Win95, and we must fall back to FindFirstFile()
+ * if the options are rejected, as they are prior to Windows-7.
+ */
+#define FIND_EX_INFO_BASIC		1
+#define FIND_FIRST_EX_LARGE_FETCH	2
+
+#ifdef UNICODE
+# define FIND_FIRST_FILE_EX_NAME  "FindFirstFileExW"
+#else
+# define FIND_FIRST_FILE_EX_NAME  "FindFirstFileExA"
+#endif
+
+typedef HANDLE (WINAPI *find_first_ex)
+(const _TCHAR *, int, WIN32_FIND_DATA *, int, void *, DWORD);
+
 static
-void *dirent_findfirst( const _TCHAR *lookup, struct _tdirent *dd )
+void *dirent_findfirst( const _TCHAR *lookup, _TDIR *dirp )
 {
   /* Replacement for Microsoft's _findfirst() function; it temporarily
    * captures the result of a FindFirstFile() call in a local buffer,
-   * whence it updates the specified dirent structure, before returning
+   * whence it updates the specified DIR structure, before returning
    * an opaque handle for subsequent use by FindNextFile().
    */
-  void *fd;
+  void *fd = INVALID_HANDLE_VALUE;
   WIN32_FIND_DATA buf;
-  if( (fd = FindFirstFile( lookup, &buf )) == INVALID_HANDLE_VALUE )
+
+  static find_first_ex find_first_file_ex = (find_first_ex)(-1);
+  if( find_first_file_ex == (find_first_ex)(-1) )
+    find_first_file_ex = (find_first_ex)(GetProcAddress(
+	GetModuleHandleA( "kernel32.dll" ), FIND_FIRST_FILE_EX_NAME
+      ));
+  if( find_first_file_ex != NULL )
+  {
+    /* We have FindFirstFileEx(); try to use it, with the options which
+     * favour bulk retrieval, but if they are rejected, then we must
+     * abandon it, in favour of FindFirstFile().
+     */
+    fd = find_first_file_ex( lookup, FIND_EX_INFO_BASIC, &buf,
+	FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH
+      );
+    if( (fd == INVALID_HANDLE_VALUE)
+    &&  (GetLastError() == ERROR_INVALID_PARAMETER)  )
+      find_first_file_ex = NULL;
+  }
+  if( find_first_file_ex == NULL )
+    fd = FindFirstFile( lookup, &buf );
+
+  if( fd == INVALID_HANDLE_VALUE )
   {
     /* The look-up failed: set errno accordingly; (note that this
      * requires mapping of some system error codes to the equivalent
@@ -212,9 +289,9 @@ void *dirent_findfirst( const _TCHAR *lookup, struct _tdirent *dd )
       errno = EINVAL;
   }
   else
-    /* The look-up was successful: update the dirent structure.
+    /* The look-up was successful: update the DIR structure.
      */
-    dirent_update( dd, &buf );
+    dirent_update( dirp, &buf );
 
   /* Ultimately, return the (possibly invalid) search handle
    * which FindFirstFile() has given us.
@@ -223,24 +300,24 @@ void *dirent_findfirst( const _TCHAR *lookup, struct _tdirent *dd )
 }
 
 #define DIRENT_OPEN(D)	\
-    ((D)->dd_handle = dirent_findfirst((D)->dd_name, &((D)->dd_dirent)))
+    ((D)->dd_handle = dirent_findfirst((D)->dd_name, (D)))
 
 static
-int dirent_findnext( void *fd, struct _tdirent *dd )
+int dirent_findnext( void *fd, _TDIR *dirp )
 {
   /* Replacement for Microsoft's _findnext() function; it temporarily
    * captures the result of calling FindNextFile() in a local buffer,
-   * whence it updates the specified dirent structure, before returning
+   * whence it updates the specified DIR structure, before returning
    * an appropriate status value.
    */
   int status;
   WIN32_FIND_DATA buf;
   if( (status = FindNextFile( fd, &buf )) != 0 )
   {
-    /* The look-up was successful; update the dirent structure, and
+    /* The look-up was successful; update the DIR structure, and
      * immediately return the (non-zero) status.
      */
-    dirent_update( dd, &buf );
+    dirent_update( dirp, &buf );
     return status;
   }
 
@@ -262,7 +339,7 @@ int dirent_findnext( void *fd, struct _tdirent *dd )
 }
 
 #define DIRENT_UPDATE(D)  \
-    dirent_findnext( (D)->dd_handle, &((D)->dd_dirent) )
+    dirent_findnext( (D)->dd_handle, (D) )
 
 /* For consistency, we also provide this simple wrapper for Microsoft's
  * FindClose() function, to clean up residual context from our replaced
@@ -284,7 +361,7 @@ _TDIR *
 __mingw_impl__(_topendir)( const _TCHAR *path_name )
 {
   _TDIR *nd;
-  _TCHAR abs_path[MAX_PATH];
+  _TCHAR abs_path[MAX_PATH], *abs_path_end;
 
   /* Reject any request which passes a NULL or an empty path name;
    * note that POSIX doesn't specify the handling for the NULL case,
@@ -305,9 +382,15 @@ __mingw_impl__(_topendir)( const _TCHAR *path_name )
    * relative) path name we are to process; (this ensures that we
    * may always refer back to this same path name, e.g. to rewind
    * the "directory stream", even after an intervening change of
-   * current working directory).
+   * current working directory).  Note that we reserve space for
+   * two more characters, beyond the path name itself, so that we
+   * may safely append the wild-card matching pattern below.
    */
-  _tfullpath( abs_path, path_name, MAX_PATH );
+  DIRENT_REJECT(
+      (_tfullpath( abs_path, path_name, MAX_PATH - 2 ) == NULL),
+	ENAMETOOLONG, (_TDIR *)(NULL)
+    );
+  abs_path_end = abs_path + _tcslen( abs_path );
 
   /* Ensure that the generated absolute path name ends with a
    * directory separator (backslash) character, so that we may
@@ -316,17 +399,15 @@ __mingw_impl__(_topendir)( const _TCHAR *path_name )
    * every entry in the specified directory; (note that, for now
    * we may simply assume that abs_path refers to a directory;
    * we will verify that when we call dirent_findfirst() on it).
+   * Since we already know where the path name ends, we simply
+   * store the separator, and the "match everything" wild-card
+   * pattern, directly in place, rather than rescanning the
+   * entire path name, to append each in turn.
    */
-  if( *abs_path != _T('\0') )
-    {
-      size_t offset = _tcslen( abs_path ) - 1;
-      if( (abs_path[offset] != _T('/')) && (abs_path[offset] != _T('\\')) )
-	_tcscat( abs_path, _T("\\") );
-    }
-
-  /* Now append the "match everything" wild-card pattern.
-   */
-  _tcscat( abs_path, _T("*") );
+  if( (abs_path_end > abs_path)
+  &&  (abs_path_end[-1] != _T('/')) && (abs_path_end[-1] != _T('\\'))  )
+    *abs_path_end++ = _T('\\');
+  *abs_path_end++ = _T('*'); *abs_path_end = NUL;
 
   /* Allocate space to store DIR structure.  The size MUST be
    * adjusted to accommodate the complete absolute path name for
@@ -336,17 +417,20 @@ __mingw_impl__(_topendir)( const _TCHAR *path_name )
    * since the base size of the DIR structure includes it).
    */
   nd = (_TDIR *)(malloc(
-	 sizeof( _TDIR ) + (_tcslen( abs_path ) * sizeof( _TCHAR ))
+	 sizeof( _TDIR ) + ((abs_path_end - abs_path) * sizeof( _TCHAR ))
        ));
 
   /* Bail out, if insufficient memory.
    */
   DIRENT_REJECT( (nd == NULL), ENOMEM, (_TDIR *)(NULL) );
 
-  /* Copy the extended absolute path name string into place
-   * within the allocated space for the DIR structure.
+  /* Copy the extended absolute path name string, including its
+   * terminating NUL, into place within the allocated space for the
+   * DIR structure.
    */
-  _tcscpy( nd->dd_name, abs_path );
+  memcpy( nd->dd_name, abs_path,
+      (abs_path_end - abs_path + 1) * sizeof( _TCHAR )
+    );
 
   /* Initialize the "directory stream", by calling dirent_findfirst()
    * on it; this leaves the data for the first directory entry in the
@@ -433,6 +517,30 @@ __mingw_impl__(_treaddir)( _TDIR *dirp )
 }
 
 
+/*****
+ *
+ * readdirx()
+ *
+ * A MinGW extension to readdir(); in addition to returning a pointer
+ * to the dirent structure for the next entry, it copies the size, the
+ * time stamps, and the full set of file attributes, all of which were
+ * retrieved by the same directory search, into the dirent_stat struct
+ * referenced by "st", (unless it is NULL), thus sparing the caller the
+ * expense of a stat() call for each entry.
+ */
+struct _tdirent *
+__mingw_impl__(_treaddirx)( _TDIR *dirp, struct dirent_stat *st )
+{
+  /* We simply delegate the fetching of the entry to readdir(), (which
+   * will also validate the DIR stream reference); if it succeeds, then
+   * the supplementary data are already to hand.
+   */
+  struct _tdirent *dd = __mingw_impl__(_treaddir)( dirp );
+  if( (dd != NULL) && (st != NULL) ) *st = dirp->dd_stat;
+  return dd;
+}
+
+
 /*****
  *
  * closedir()
@@ -563,4 +671,115 @@ __mingw_impl__(_tseekdir)( _TDIR * dirp, long loc )
       ;
 }
 
+
+/*****
+ *
+ * scandir()
+ *
+ * Collect all entries from the named directory, for which an optional
+ * "filter" function returns non-zero, into a dynamically allocated array
+ * of pointers to individually allocated dirent structures, each trimmed
+ * to accommodate only the actual length of its d_name field, (with its
+ * d_reclen field adjusted accordingly).  The array is then, optionally,
+ * sorted by qsort(), using the specified "compare" function; a pointer
+ * to it is stored in "namelist", and the number of entries is returned.
+ * The caller is responsible for releasing each entry, and subsequently
+ * the array itself, by calling free().
+ *
+ */
+int
+__mingw_impl__(_tscandir)( const _TCHAR *path_name,
+    struct _tdirent ***namelist, int (*filter)(const struct _tdirent *),
+    int (*compare)(const struct _tdirent **, const struct _tdirent **)
+  )
+{
+  _TDIR *dirp;
+  struct _tdirent *dd, **list = NULL;
+  size_t count = 0, limit = 0;
+  int errno_saved = errno;
+
+  DIRENT_REJECT( (namelist == NULL), EINVAL, -1 );
+  if( (dirp = __mingw_impl__(_topendir)( path_name )) == NULL )
+    return -1;
+
+  /* Since readdir() returns NULL both at the end of the directory
+   * stream, and on error, we must clear errno, in order to be able to
+   * distinguish the two cases.
+   */
+  errno = 0;
+  while( (dd = __mingw_impl__(_treaddir)( dirp )) != NULL )
+  {
+    struct _tdirent *entry;
+    size_t namlen, size;
+
+    if( (filter != NULL) && (filter( dd ) == 0) )
+      continue;
+
+    /* The list is grown geometrically, as required, to keep the cost
+     * of reallocation proportional to the number of entries.
+     */
+    if( count == limit )
+    {
+      struct _tdirent **grow;
+      limit = (limit > 0) ? limit << 1 : 32;
+      if( (grow = realloc( list, limit * sizeof( *list ) )) == NULL )
+	goto nomem;
+      list = grow;
+    }
+
+    /* Note that dirent_update() counts the entire length of any name
+     * which it has truncated; we must store only the truncated form.
+     */
+    if( (namlen = dd->d_namlen) >= FILENAME_MAX )
+      namlen = FILENAME_MAX - 1;
+    size = offsetof( struct _tdirent, d_name ) + (namlen + 1) * sizeof( _TCHAR );
+    if( (entry = malloc( size )) == NULL )
+      goto nomem;
+
+    memcpy( entry, dd, size );
+    entry->d_reclen = size;
+    list[count++] = entry;
+  }
+  if( errno != 0 )
+    goto fail;
+
+  errno = errno_saved;
+  __mingw_impl__(_tclosedir)( dirp );
+  if( (compare != NULL) && (count > 1) )
+    qsort( list, count, sizeof( *list ),
+	(int (*)(const void *, const void *))(compare)
+      );
+  *namelist = list;
+  return count;
+
+nomem:
+  errno = ENOMEM;
+
+fail:
+  /* Some entry could not be stored, or the directory stream could not
+   * be read to its end; discard everything collected so far, and report
+   * failure, while preserving the errno value which describes the cause.
+   */
+  errno_saved = errno;
+  while( count > 0 ) free( list[--count] );
+  free( list );
+  __mingw_impl__(_tclosedir)( dirp );
+  errno = errno_saved;
+  return -1;
+}
+
+
+/*****
+ *
+ * alphasort()
+ *
+ * A comparison function, suitable for passing to scandir(), to sort
+ * the collected entries into the collating order of their names.
+ *
+ */
+int
+__mingw_impl__(_talphasort)
+( const struct _tdirent **a, const struct _tdirent **b )
+{ return _tcscoll( (*a)->d_name, (*b)->d_name ); }
+
 /* $RCSfile$: end of file */
@@ -7,7 +7,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2006, 2007, 2014, 2022, MinGW.OSDN Project
+ * Copyright (C) 2006, 2007, 2014, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -36,16 +36,142 @@
 #include <libgen.h>
 #include <locale.h>
 
+#include "pathscan.h"
+
 #ifndef __cdecl  /* If compiling on any non-Win32 platform ... */
 #define __cdecl  /* this may not be defined.                   */
 #endif
 
+static char *dirname_bytewise( char *path )
+{
+  /* Resolve the directory name of path, when pathscan_is_bytewise()
+   * has confirmed that it may be scanned byte by byte; this follows the
+   * same logic as the wide character scan, in __mingw_dirname(), but it
+   * operates directly on the caller's buffer, with no need for any
+   * transformation, or for any change of locale.
+   */
+  static char retfail[4];
+
+  if( path && *path )
+  {
+    char *refpath = path;
+
+    /* the SUSv3 special case of "//", (or "\\"), is returned unchanged */
+
+    if( (path[1] != '\0') && pathscan_is_separator( path[0] ) )
+    {
+      if( (path[1] == path[0]) && (path[2] == '\0') )
+	return path;
+    }
+
+    /* for all other cases ...
+     * step over the drive designator, if present ...
+     */
+
+    else if( path[1] == ':' )
+      refpath += 2;
+
+    if( *refpath )
+    {
+      /* locate the basename component of the path string,
+       * (but also remember where the dirname component starts).
+       */
+
+      char *refname, *basename;
+      for( refname = basename = refpath ; *refpath ; ++refpath )
+      {
+	if( pathscan_is_separator( *refpath ) )
+	{
+	  while( pathscan_is_separator( *refpath ) )
+	    ++refpath;
+
+	  if( *refpath )
+	    basename = refpath;
+
+	  else
+	    break;
+	}
+      }
+
+      if( basename > refname )
+      {
+	/* we have distinct dirname and basename components;
+	 * backtrack over all trailing separators on the dirname,
+	 * (but preserve exactly two initial dirname separators, if identical),
+	 * and add a NUL terminator in their place.
+	 */
+
+	do --basename;
+	while( (basename > refname) && pathscan_is_separator( *basename ) );
+	if( (basename == refname) && pathscan_is_separator( refname[0] )
+	&&  (refname[1] == refname[0]) && ! pathscan_is_separator( refname[2] ) )
+	  ++basename;
+	*++basename = '\0';
+
+	/* if the resultant dirname begins with EXACTLY two dir separators,
+	 * AND both are identical, then we preserve them.
+	 */
+
+	refpath = path;
+	while( pathscan_is_separator( *refpath ) )
+	  ++refpath;
+	if( ((refpath - path) > 2) || (path[1] != path[0]) )
+	  refpath = path;
+
+	/* remove any residual, redundantly duplicated separators,
+	 * reterminate, and return the dirname, in the caller's buffer.
+	 */
+
+	refname = refpath;
+	while( *refpath )
+	{
+	  if( pathscan_is_separator( *refname++ = *refpath++ ) )
+	  {
+	    while( pathscan_is_separator( *refpath ) )
+	      ++refpath;
+	  }
+	}
+	*refname = '\0';
+	return path;
+      }
+
+      else
+      {
+	/* either there were no dirname separators in the path name,
+	 * or there was nothing else; return, in our own buffer, any
+	 * drive designator, followed by one separator in the latter
+	 * case, or by '.' in the former.
+	 */
+
+	size_t len = refname - path;
+	memcpy( retfail, path, len );
+	retfail[len] = pathscan_is_separator( *refname ) ? *refname : '.';
+	retfail[++len] = '\0';
+	return retfail;
+      }
+    }
+  }
+
+  /* path is NULL, or an empty string; default return value is "."
+   */
+
+  return strcpy( retfail, "." );
+}
+
 __cdecl char *__mingw_dirname( char *path )
 {
   size_t len;
   static char *retfail = NULL;
 
-  /* to handle path names for files in multibyte character locales,
+  /* for a path name which may safely be scanned byte by byte, (which is
+   * always the case for ASCII, UTF-8, or any single byte code page), we
+   * may avoid the overhead of the wide character transformation below.
+   */
+
+  if( pathscan_is_bytewise( path ) )
+    return dirname_bytewise( path );
+
+  /* to handle path names for files in DBCS multibyte character locales,
    * we need to set up LC_CTYPE to match the host file system locale.
    */
 
@@ -7,7 +7,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2014, 2021, 2022, MinGW.OSDN Project
+ * Copyright (C) 2014, 2021, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -53,6 +53,11 @@
  */
 #include <windows.h>
 
+/* Global symbol look-ups are resolved by reference to a hash index of
+ * each module's export directory, rather than by GetProcAddress().
+ */
+#include "pexports.h"
+
 /* In addition to the POSIX constants which are defined in dlfcn.h,
  * we also define some private manifest constants, which POSIX does
  * not specify, but which facilitate our implementation:
@@ -70,6 +75,43 @@
  */
 # define RTLD_ALL_GLOBAL  (void *)(-5)
 
+/* The global modules list, its associated export index, the cache of
+ * dlsym() search outcomes, and the dlerror() message buffers, are all
+ * shared by every thread which calls any dlfcn API function, and any of
+ * them may be grown, or released, by any such call; all access to them
+ * is serialized by a critical section, which is initialized on first
+ * use, (since dlsym() may be called before any constructor has run).
+ *
+ * Note that LoadLibrary(), FreeLibrary(), and GetProcAddress() may each
+ * need to acquire the Windows loader lock; we never call any of these
+ * while holding our own lock, since that could deadlock against another
+ * thread which calls dlsym() from DllMain(), while it holds the loader
+ * lock.  (The sole exception is the one-time initialization, when we
+ * must load PSAPI.DLL).
+ */
+static CRITICAL_SECTION dlfcn_cs;
+static volatile long dlfcn_cs_state = 0;
+
+static void dlfcn_lock( void )
+{
+  /* Acquire the dlfcn lock, initializing it if necessary; the first
+   * thread to get here claims the initialization, while any others spin
+   * until it is complete.
+   */
+  if( dlfcn_cs_state != 2 )
+  { if( InterlockedCompareExchange( &dlfcn_cs_state, 1, 0 ) == 0 )
+    { InitializeCriticalSection( &dlfcn_cs );
+      dlfcn_cs_state = 2;
+    }
+    else while( dlfcn_cs_state != 2 )
+      Sleep( 0 );
+  }
+  EnterCriticalSection( &dlfcn_cs );
+}
+
+static __inline__ void dlfcn_unlock( void )
+{ LeaveCriticalSection( &dlfcn_cs ); }
+
 /* Before anything else, ensure that the dlerror() implementation
  * is in place, so that other components may access it freely.
  *
@@ -90,6 +132,7 @@ static void dlfcn_store_error_message( const char *fmt, ... )
    */
   int msglen;
   va_list argv;
+  dlfcn_lock();
   va_start( argv, fmt );
   msglen = 1 + __mingw_vsnprintf( NULL, 0, fmt, argv );
   if( (dlfcn_error_pending = realloc( dlfcn_error_message, msglen )) != NULL )
@@ -99,6 +142,7 @@ static void dlfcn_store_error_message( const char *fmt, ... )
     __mingw_vsnprintf( dlfcn_error_pending, msglen, fmt, argv );
   dlfcn_error_message = dlfcn_error_pending;
   va_end( argv );
+  dlfcn_unlock();
 }
 
 static char *dlfcn_strerror( int errcode )
@@ -146,9 +190,12 @@ static char *dlfcn_strerror( int errcode )
 static char *dlerror_internal( void )
 {
   /* This is the internal implementation of the public dlerror() API.
-   * POSIX does not require this to be thread safe, so we take no care
-   * to make it such.
+   * POSIX does not require this to be thread safe; we serialize it only
+   * to protect the message buffers, which any other thread may realloc(),
+   * but the message we return may be released by any subsequent call.
    */
+  char *message;
+  dlfcn_lock();
   if( (dlfcn_error_pending == NULL) && (dlfcn_error_message != NULL) )
   {
     /* There is no pending message, but a buffer remains allocated
@@ -160,10 +207,12 @@ static char *dlerror_internal( void )
   /* Mark any pending error message as "retrieved"...
    */
   dlfcn_error_pending = NULL;
+  message = dlfcn_error_message;
+  dlfcn_unlock();
   /*
    * ...and return it.
    */
-  return dlfcn_error_message;
+  return message;
 }
 
 typedef
@@ -250,12 +299,131 @@ typedef struct dltab
   unsigned int   slots;
   unsigned char *flags;
   HMODULE	*modules;
+  pe_export_index **exports;
 } dltab;
 
 /* The global modules list itself, initially empty, but suitable
  * for reallocation on the heap.
  */
-static dltab rtld = { 0, NULL, NULL };
+static dltab rtld = { 0, NULL, NULL, NULL };
+
+/* The export index for each module, in the exports list which runs
+ * parallel to the global modules list, is created on first reference
+ * to the module, in any global symbol search, and is retained until
+ * the module is released by dlclose(); if we cannot maintain the
+ * exports list, (due to memory exhaustion), we discard it, and fall
+ * back to searching by GetProcAddress().
+ */
+static void dlfcn_exports_discard( void )
+{
+  unsigned int index;
+  if( rtld.exports != NULL )
+    for( index = 0; index < rtld.slots; index++ )
+      if( rtld.exports[index] != NULL )
+      { __mingw_pe_export_free( rtld.exports[index] );
+	free( rtld.exports[index] );
+      }
+  free( rtld.exports );
+  rtld.exports = NULL;
+}
+
+/* Additionally, the outcome of each global symbol search, (by name,
+ * and beginning with the first module in the search order), is cached
+ * in a hash table, keyed on the symbol name, and on whether the search
+ * excluded explicitly loaded modules; this cache must be invalidated,
+ * whenever dlopen() or dlclose() changes the set of modules which would
+ * be searched.  Each invalidation advances a generation count, so that
+ * a search which releases the lock, (to call GetProcAddress()), will not
+ * cache an outcome which may have been rendered stale in the interim.
+ */
+typedef struct dlsym_cached
+{
+  char		*name;
+  uint32_t	 hash;
+  unsigned char	 exclude;
+  unsigned int	 index;		/* where the symbol was found, plus one */
+  void		*addr;		/* its address, or NULL if not found */
+} dlsym_cached;
+
+static struct
+{
+  unsigned int	 mask;
+  unsigned int	 used;
+  unsigned int	 generation;
+  dlsym_cached	*entry;
+} dlsym_cache = { 0, 0, 0, NULL };
+
+static void dlsym_cache_invalidate( void )
+{
+  /* Discard all cached search outcomes, retaining the (empty) table.
+   */
+  unsigned int index;
+  if( dlsym_cache.used > 0 )
+    for( index = 0; index <= dlsym_cache.mask; index++ )
+    { free( dlsym_cache.entry[index].name );
+      dlsym_cache.entry[index].name = NULL;
+    }
+  dlsym_cache.used = 0;
+  ++dlsym_cache.generation;
+}
+
+static dlsym_cached *dlsym_cache_slot
+( const char *name, uint32_t hash, unsigned char exclude )
+{
+  /* Locate the cache entry for a NAME, (with pre-computed HASH), and
+   * EXCLUDE qualifier, or the vacant slot which it would occupy.
+   */
+  dlsym_cached *entry;
+  unsigned int index = hash;
+  if( dlsym_cache.entry == NULL )
+    return NULL;
+  while( (entry = dlsym_cache.entry + (index++ & dlsym_cache.mask))->name != NULL )
+    if( (entry->hash == hash) && (entry->exclude == exclude)
+    &&  (strcmp( entry->name, name ) == 0)  )
+      break;
+  return entry;
+}
+
+static void dlsym_cache_store
+( const char *name, uint32_t hash, unsigned char exclude, unsigned int index,
+  void *addr )
+{
+  /* Record the outcome of a global search, growing the cache, when it
+   * becomes three quarters full; (failure to allocate memory, for any
+   * purpose here, simply results in the outcome not being cached).
+   */
+  dlsym_cached *entry;
+  if( 4 * (dlsym_cache.used + 1) > 3 * (dlsym_cache.mask + 1) )
+  {
+    unsigned int slots = (dlsym_cache.entry == NULL) ? 64
+      : 2 * (dlsym_cache.mask + 1);
+    dlsym_cached *old = dlsym_cache.entry, *grown;
+    if( (grown = calloc( slots, sizeof( dlsym_cached ) )) == NULL )
+      return;
+    dlsym_cache.entry = grown;
+    if( old != NULL )
+    { /* Move every existing entry, to its new hashed location.
+       */
+      unsigned int count = dlsym_cache.mask + 1;
+      dlsym_cache.mask = slots - 1;
+      while( count-- > 0 )
+	if( old[count].name != NULL )
+	  *dlsym_cache_slot( old[count].name, old[count].hash,
+	      old[count].exclude ) = old[count];
+      free( old );
+    }
+    dlsym_cache.mask = slots - 1;
+  }
+  if( ((entry = dlsym_cache_slot( name, hash, exclude )) != NULL)
+  &&  ((entry->name = strdup( name )) != NULL)  )
+  {
+    entry->hash = hash;
+    entry->exclude = exclude;
+    entry->index = index;
+    entry->addr = addr;
+    ++dlsym_cache.used;
+  }
+}
 
 /* Microsoft's LoadLibrary() API is explicitly documented as being
  * unable to handle regular slashes as directory separators in module
@@ -320,7 +488,9 @@ static void *dlopen_internal( const char *name, int mode )
      * that it is allocated a slot in our global symbol table, but we
      * must first check that it isn't already present.
      */
-    int index, insertion_point = rtld.slots;
+    int index, insertion_point;
+    dlfcn_lock();
+    insertion_point = rtld.slots;
     for( index = 0; index < rtld.slots; index++ )
     {
       /* As we scan the list of already loaded modules, check for any
@@ -336,19 +506,21 @@ static void *dlopen_internal( const char *name, int mode )
       }
       else if( module == rtld.modules[index] )
       {
-	/* The requested module appears to be loaded already; calling
-	 * LoadLibrary() will have increased its reference count, but
-	 * our management strategy doesn't require this; reduce it...
-	 */
-	FreeLibrary( module );
-	/*
-	 * ...but promote its existing status to RTLD_GLOBAL, if that
-	 * is indicated as required by the requested mode...
+	/* The requested module appears to be loaded already; promote
+	 * its existing status to RTLD_GLOBAL, if that is indicated as
+	 * required by the requested mode, (in which case any cached
+	 * global search outcomes may no longer be valid)...
 	 */
+	if( (mode & ~rtld.flags[index] & RTLD_GLOBAL) != 0 )
+	  dlsym_cache_invalidate();
 	rtld.flags[index] |= mode & RTLD_GLOBAL;
+	dlfcn_unlock();
 	/*
-	 * ...and immediately return the module handle.
+	 * ...then, since calling LoadLibrary() will have increased its
+	 * reference count, which our management strategy doesn't require,
+	 * reduce it, and immediately return the module handle.
 	 */
+	FreeLibrary( module );
 	return module;
       }
     }
@@ -388,6 +560,8 @@ static void *dlopen_internal( const char *name, int mode )
 	     /* ...by simply copying content from the non-vacant slots
 	      * to overwrite content in the preceding slots...
 	      */
+	     if( rtld.exports != NULL )
+	       rtld.exports[insertion_point] = rtld.exports[index];
 	     rtld.modules[insertion_point] = rtld.modules[index];
 	     rtld.flags[insertion_point++] = rtld.flags[index++];
 	   }
@@ -402,7 +576,9 @@ static void *dlopen_internal( const char *name, int mode )
        * are marked accordingly.
        */
       for( index = insertion_point; index < rtld.slots; index++ )
+      { if( rtld.exports != NULL ) rtld.exports[index] = NULL;
 	rtld.flags[index] = 0;
+      }
     }
     else
     { /* There is no vacant slot: we must expand the allocated memory
@@ -416,6 +592,17 @@ static void *dlopen_internal( const char *name, int mode )
 	 * allocation, do likewise for the associated flags...
 	 */
 	unsigned char *flags = rtld.flags;
+	pe_export_index **exports = rtld.exports;
+	if( (exports != NULL)
+	&&  ((exports = realloc( exports, sizeof( *exports ) * slots )) == NULL)  )
+	  /*
+	   * ...(and for the exports list, which we may abandon, if
+	   * necessary)...
+	   */
+	  dlfcn_exports_discard();
+	else if( exports != NULL )
+	  (rtld.exports = exports)[rtld.slots] = NULL;
+
 	if( (flags = realloc( flags, slots )) != NULL )
 	  /*
 	   * ...initializing the new flags register, and incrementing
@@ -440,6 +627,7 @@ static void *dlopen_internal( const char *name, int mode )
 	 * record an appropriate diagnostic message, (but we note that
 	 * this may also fail, due to insufficient memory).
 	 */
+	dlfcn_unlock();
 	FreeLibrary( module );
 	dlopen_store_error_message( name, ERROR_OUTOFMEMORY );
 	return NULL;
@@ -452,6 +640,8 @@ static void *dlopen_internal( const char *name, int mode )
      */
     rtld.flags[insertion_point] = RTLD_EXPLICIT | mode;
     rtld.modules[insertion_point] = module;
+    dlsym_cache_invalidate();
+    dlfcn_unlock();
   }
   /* Finally, we return whatever module handle we got from LoadLibrary(),
    * (which may be NULL, if this failed).
@@ -459,6 +649,63 @@ static void *dlopen_internal( const char *name, int mode )
   return module;
 }
 
+static void *dlsym_unlocked( HMODULE module, const char *name )
+{
+  /* A helper to look up a symbol by NAME, in MODULE, by calling
+   * GetProcAddress(); the caller must hold the dlfcn lock, which
+   * we release for the duration of the call.
+   */
+  void *rtn;
+  dlfcn_unlock();
+  rtn = GetProcAddress( module, name );
+  dlfcn_lock();
+  return rtn;
+}
+
+static void *dlsym_module( unsigned int index, const char *name,
+    uint32_t hash )
+{
+  /* A helper to look up a symbol by NAME, (with pre-computed HASH),
+   * in the module at INDEX within the global modules list, using its
+   * export index, (which we create, if necessary), when possible.
+   */
+  HMODULE module = rtld.modules[index];
+  pe_export_index *exports;
+  uint32_t rva;
+
+  if( (rtld.exports == NULL) || ((uintptr_t)(name) <= 0xFFFF) )
+    /* We have no exports list, or the symbol is specified by ordinal;
+     * leave it to GetProcAddress().
+     */
+    return dlsym_unlocked( module, name );
+
+  if( (exports = rtld.exports[index]) == NULL )
+  { /* This module has not yet been indexed; do it now.  If this fails,
+     * (perhaps due to an unusual image layout), the index is retained,
+     * but marked as unusable, so we don't retry.
+     */
+    if( (exports = malloc( sizeof( pe_export_index ) )) == NULL )
+      return dlsym_unlocked( module, name );
+    __mingw_pe_export_index( exports, module, 0, 1 );
+    rtld.exports[index] = exports;
+  }
+  if( exports->slots == NULL )
+    return dlsym_unlocked( module, name );
+
+  switch( __mingw_pe_export_lookup( exports, name, hash, &rva ) )
+  { case PE_EXPORT_ADDRESS:
+      return (char *)(module) + rva;
+
+    case PE_EXPORT_FORWARDER:
+      /* The symbol is forwarded to another module; let the loader
+       * resolve it, (which may require that module to be loaded).
+       */
+      return dlsym_unlocked( module, name );
+  }
+  SetLastError( ERROR_PROC_NOT_FOUND );
+  return NULL;
+}
+
 static void *dlsym_internal( void *module, const char *name )
 {
   /* This is the formal implementation of the public dlsym() function.
@@ -468,6 +715,10 @@ static void *dlsym_internal( void *module, const char *name )
   static unsigned char rtld_exclude = 0;
   void *rtn;
 
+  /* All of the preceding static search state, in addition to the global
+   * modules list and the search cache, is protected by the dlfcn lock.
+   */
+  dlfcn_lock();
   if( module == RTLD_NEXT )
   {
     /* NOTE: We MUST identify this special case BEFORE any other!
@@ -513,11 +764,50 @@ static void *dlsym_internal( void *module, const char *name )
      * with the RTLD_GLOBAL mode attribute, either until the named
      * symbol is found, or all such modules have been searched
      * without finding it.
-     */ 
-    for( rtn = NULL; (rtn == NULL) && (index < rtld.slots); index++ )
-      if( ((rtld_exclude & rtld.flags[index]) == 0)
-      &&  ((rtld.flags[index] & RTLD_GLOBAL) == RTLD_GLOBAL)  )
-	rtn = GetProcAddress( rtld.modules[index], name );
+     *
+     * Unless the symbol is specified by ordinal, we may avoid repeating
+     * any search which begins with the first module, by reference to
+     * the cache of previous search outcomes.  Since the search itself
+     * may release the lock, it works on private copies of the search
+     * state, which are committed only when it is complete.
+     */
+    uint32_t hash = 0;
+    dlsym_cached *cached;
+    unsigned int slot = index, generation = dlsym_cache.generation;
+    unsigned char exclude = rtld_exclude;
+    int cacheable = (slot == 0) && ((uintptr_t)(name) > 0xFFFF);
+    if( (uintptr_t)(name) > 0xFFFF )
+    {
+      hash = __mingw_pe_hash( name );
+      if( cacheable
+      &&  ((cached = dlsym_cache_slot( name, hash, exclude )) != NULL)
+      &&  (cached->name != NULL)  )
+      {
+	/* This search has been performed before, since the set of
+	 * modules to be searched was last changed; its outcome is known.
+	 */
+	index = cached->index;
+	if( (rtn = cached->addr) == NULL )
+	  SetLastError( ERROR_PROC_NOT_FOUND );
+	last_named_symbol = name;
+	goto resolved;
+      }
+    }
+    for( rtn = NULL; (rtn == NULL) && (slot < rtld.slots); slot++ )
+      if( ((exclude & rtld.flags[slot]) == 0)
+      &&  ((rtld.flags[slot] & RTLD_GLOBAL) == RTLD_GLOBAL)  )
+	rtn = dlsym_module( slot, name, hash );
+
+    /* Cache the outcome of any search which began with the first module,
+     * (being careful to preserve the error status, on failure), unless
+     * the set of modules to be searched changed while it was in progress.
+     */
+    if( cacheable && (generation == dlsym_cache.generation) )
+    { uint32_t status = GetLastError();
+      dlsym_cache_store( name, hash, exclude, slot, rtn );
+      SetLastError( status );
+    }
+    index = slot;
 
     /* Note the symbol named in the current search, so that we may
      * check for consistency in the event that the next search is
@@ -529,7 +819,7 @@ static void *dlsym_internal( void *module, const char *name )
   { /* When a specific module reference is specified, confine the
      * search to the specified module alone...
      */
-    rtn = GetProcAddress( (HMODULE)(module), name );
+    rtn = dlsym_unlocked( (HMODULE)(module), name );
 
     /* ...and inhibit any attempt to follow this search with one
      * specifying RTLD_NEXT; (this would not be valid, since there
@@ -539,6 +829,7 @@ static void *dlsym_internal( void *module, const char *name )
     last_named_symbol = NULL;
   }
 
+resolved:
   if( rtn == NULL )
   {
     /* The named symbol was not found in any module which was searched;
@@ -548,6 +839,7 @@ static void *dlsym_internal( void *module, const char *name )
     dlfcn_store_error_message( "dlsym:'%s': %s", name, reason );
     free( reason );
   }
+  dlfcn_unlock();
 
   /* Return the symbol address, as assigned to the return value;
    * (this will be NULL, if the named symbol was not found).
@@ -582,6 +874,7 @@ static int dlclose_internal( void *module )
    * having been explicitly opened by our dlopen() function.
    */
   int index;
+  dlfcn_lock();
   for( index = 0; index < rtld.slots; index++ )
     if( module == rtld.modules[index] )
     {
@@ -590,28 +883,39 @@ static int dlclose_internal( void *module )
        * prudent to do so in respect of implicitly loaded modules, but for
        * those which we have explicitly loaded...
        */
-      if( ((rtld.flags[index] & RTLD_EXPLICIT) == RTLD_EXPLICIT)
-      /*
-       * ...and which can be successfully released by FreeLibrary()...
-       */
-      &&  (dlclose_internal_check_for_error( FreeLibrary( module )) == 0)  )
-	/*
-	 * ...we mark them as no longer available for dlsym() processing,
-	 * and return immediately, indicating success...
+      if( (rtld.flags[index] & RTLD_EXPLICIT) == RTLD_EXPLICIT )
+      {
+	/* ...we mark them as no longer available for dlsym() processing,
+	 * (discarding any export index, and all cached search outcomes,
+	 * which must not outlive the module's mapping)...
+	 */
+	if( (rtld.exports != NULL) && (rtld.exports[index] != NULL) )
+	{ __mingw_pe_export_free( rtld.exports[index] );
+	  free( rtld.exports[index] );
+	  rtld.exports[index] = NULL;
+	}
+	dlsym_cache_invalidate();
+	rtld.flags[index] = 0;
+	dlfcn_unlock();
+
+	/* ...before releasing them, (without holding the lock), and
+	 * returning the outcome.
 	 */
-	return rtld.flags[index] = 0;
+	return dlclose_internal_check_for_error( FreeLibrary( module ) );
+      }
 
-      /* ...but when we didn't successfully release the module, we have
-       * no need to continue the search for its handle in the global list
-       * of modules, (because we've already found it); we may immediately
+      /* ...but for an implicitly loaded module, we have no need to
+       * continue the search for its handle in the global list of
+       * modules, (because we've already found it); we may immediately
        * abandon the search.
        */
       break;
     }
+  dlfcn_unlock();
 
   /* If we get to here, we either didn't find the specified module handle in
-   * the global list of modules, or we found it but were unable to release
-   * it; in either case, we force a module error condition.
+   * the global list of modules, or we found it, but it was not explicitly
+   * loaded; in either case, we force a module error condition.
    */
   return dlclose_store_error_message( FreeLibrary( NULL ) );
 }
@@ -694,20 +998,36 @@ static void dlfcn_init( void )
        */
       __mingw_dlfcn.dlopen = dlopen_internal;
       __mingw_dlfcn.dlsym = dlsym_internal;
+
+      /* We also need an empty exports list, to accompany the modules
+       * list; if we can't get one, global symbol searches will simply
+       * fall back to using GetProcAddress().
+       */
+      rtld.exports = calloc( rtld.slots, sizeof( *rtld.exports ) );
     }
   }
 }
 
 /* The global symbol table needs to be initialized, before we process
  * the first call to either dlopen() or dlsym(); the following pair of
- * initializer functions take care of this requirement, before passing
- * the first-time request to the appropriate internal handler.
+ * initializer functions take care of this requirement, (exactly once,
+ * even when several threads make their first call concurrently), before
+ * passing the first-time request to the appropriate internal handler.
  */
+static void *dlopen_init( const char *name, int mode );
+static void *dlsym_init( void *module, const char *name );
+
+static void dlfcn_init_once( void )
+{ dlfcn_lock();
+  if( __mingw_dlfcn.dlsym == dlsym_init ) dlfcn_init();
+  dlfcn_unlock();
+}
+
 static void *dlopen_init( const char *name, int mode )
-{ dlfcn_init(); return dlopen_internal( name, mode ); }
+{ dlfcn_init_once(); return dlopen_internal( name, mode ); }
 
 static void *dlsym_init( void *module, const char *name )
-{ dlfcn_init(); return dlsym_internal( module, name ); }
+{ dlfcn_init_once(); return dlsym_internal( module, name ); }
 
 /* Finally, we may define the __mingw_dlfcn structure, and set up its
  * initial function pointers, referring to the four API functions...
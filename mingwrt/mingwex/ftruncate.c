@@ -3,12 +3,14 @@
  *
  * Implement a 64-bit file size capable ftruncate() function; GCC-9.x
  * gratuitously assumes that this is available, via the ftruncate64()
- * entry point.
+ * entry point.  The same file size adjustment helper also supports the
+ * POSIX posix_fallocate() function, and the zero padding of gaps which
+ * __mingw_fwrite() must fill, on Win9x, after a seek beyond EOF.
  *
  * $Id$
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2020, 2022, MinGW.OSDN Project
+ * Copyright (C) 2020, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -31,12 +33,11 @@
  * DEALINGS IN THE SOFTWARE.
  *
  */
-#include <dlfcn.h>
 #include <unistd.h>
 #include <winbase.h>
 #include <stdint.h>
-#include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
 
 /* The following in-line function is provided to facilitate abnormal return
@@ -46,122 +47,177 @@
 static __inline__ __attribute__((__always_inline__))
 int errout( int error_code ){ errno = error_code; return -1L; }
 
-/* When running on Vista, or later, or for applications which have been
- * linked against non-free MSVCR80.DLL, or later, we may be able to simply
- * substitute a call to Microsoft's _chsize_s() function, (which behaves
- * as a 64-bit variant of the universally available _chsize() function).
- * On legacy Windows versions, which are unlikely to provide _chsize_s(),
- * we need to provide our own fallback 64-bit chsize() implementation;
- * this may be static, but cannot be inlined, because we need a physical
- * entry point address to which execution may be redirected.
+/* When the file size is to be changed, we prefer to set the new end of
+ * file directly, by SetFileInformationByHandle(); this doesn't disturb
+ * the file pointer, but it is available only from Vista onward, so we
+ * must resolve it at run time.  Our <winbase.h> declares its associated
+ * information class only when targetting Vista, so we define our own.
  */
-static int mingw_chsize64_fallback( int fd, __off64_t offset )
+#define FILE_END_OF_FILE_INFO_CLASS  6
+
+typedef BOOL WINAPI (*set_file_info)( HANDLE, int, void *, DWORD );
+
+/* When we must fill an extended region of a file with zeros, we write
+ * them in blocks of FILL_BLOCK_SIZE bytes, from a page aligned block of
+ * the same size, (which VirtualAlloc() guarantees to be zero filled).
+ */
+#define FILL_BLOCK_SIZE  (64 * 1024)
+
+static int mingw_fsize_error( void )
+{
+  /* Helper to map a failed Windows API file size operation to
+   * an appropriate errno value, for abnormal return.
+   */
+  switch( GetLastError() )
+  { case ERROR_DISK_FULL:
+    case ERROR_HANDLE_DISK_FULL: return errout( ENOSPC );
+    case ERROR_ACCESS_DENIED:
+    case ERROR_INVALID_HANDLE: return errout( EBADF );
+  }
+  return errout( EIO );
+}
+
+static int mingw_fsize_zero_fill( HANDLE fh, __off64_t from, __off64_t to )
 {
-  /* POSIX.1 requires the file pointer to be unchanged, as a consequence
-   * of calling ftruncate(), (and Microsoft's _chsize() functions do seem
-   * to satisfy this requirement); however, to mark a new end of file, we
-   * need move the file pointer to the new end of file offset, so we need
-   * to save the original pointer now, to restore later.
+  /* Helper to write zeros into the file region between the "from" and
+   * "to" offsets; this is required only on Win9x, which doesn't zero the
+   * space, when a file is extended by SetEndOfFile(); it assumes that the
+   * file pointer is already positioned at "from".
    */
-  __off64_t cur_offset = _lseeki64( fd, 0LL, SEEK_CUR );
-
-  /* In the event that the new end of file offset requires the file to be
-   * extended beyond its current end of file offset, POSIX.1 also requires
-   * NUL byte padding to be written to the extended file space, (and again,
-   * Microsoft's _chsize() functions seem to do this); we may reposition
-   * the file pointer to its current end of file offset, in preparation
-   * for the possibility that we need to fulfil this requirement.
+  static char fallback[BUFSIZ];
+  DWORD count, block = FILL_BLOCK_SIZE;
+  void *zeros = VirtualAlloc( NULL, block, MEM_COMMIT, PAGE_READWRITE );
+
+  /* Should we be unable to allocate the preferred large block, we fall
+   * back to the (always zero) BUFSIZ block, (which is much slower).
    */
-  __off64_t end_offset = _lseeki64( fd, 0LL, SEEK_END );
+  if( zeros == NULL )
+  { zeros = fallback; block = sizeof( fallback ); }
+
+  while( from < to )
+  { if( (__off64_t)(block) > (to - from) ) block = to - from;
+    if( ! WriteFile( fh, zeros, block, &count, NULL ) || (count == 0) )
+      break;
+    from += count;
+  }
+  if( zeros != fallback )
+    VirtualFree( zeros, 0, MEM_RELEASE );
+  return (from < to) ? -1 : 0;
+}
 
-  /* We will eventually need to restore the original file pointer, AFTER
-   * we have evaluated the return status code, so we will need to save
-   * this.
+int __mingw_fsetsize( int fd, __off64_t length, int extend_only )
+{
+  /* Helper to adjust the size of the file associated with descriptor
+   * "fd" to "length" bytes, without changing its file pointer; if the
+   * "extend_only" flag is set, the file will be extended, if necessary,
+   * but never shortened.  POSIX.1 requires any extended space to read
+   * as zeros; on WinNT, all file systems ensure that it will, without
+   * any need for us to write them explicitly.
    */
-  int retval;
+  static set_file_info set_end_of_file = (set_file_info)(-1);
+  union { __off64_t value; LARGE_INTEGER li; } eof, cur, new_eof;
+  HANDLE fh = (HANDLE)(_get_osfhandle( fd ));
 
-  /* There are two possible options for repositioning the end of file
-   * pointer:
+  if( fh == INVALID_HANDLE_VALUE )
+    return errout( EBADF );
+
+  /* Determine the current size of the file, and return immediately,
+   * when no change is required...
    */
-  if( offset > end_offset )
+  eof.li.LowPart = GetFileSize( fh, (DWORD *)(&eof.li.HighPart) );
+  if( (eof.li.LowPart == INVALID_FILE_SIZE) && (GetLastError() != NO_ERROR) )
+    return mingw_fsize_error();
+  if( (length == eof.value) || (extend_only && (length < eof.value)) )
+    return 0;
+
+  /* ...otherwise, except when extending on Win9x, set the new end of
+   * file marker directly, when the API to do so is available.
+   */
+  new_eof.value = length;
+  if( (length < eof.value) || ((_osver & 0x8000) == 0) )
+  {
+    if( set_end_of_file == (set_file_info)(-1) )
+      set_end_of_file = (set_file_info)(GetProcAddress(
+	  GetModuleHandleA( "kernel32.dll" ), "SetFileInformationByHandle"
+	));
+    if( set_end_of_file != NULL )
+      return set_end_of_file( fh, FILE_END_OF_FILE_INFO_CLASS, &new_eof,
+	  sizeof( new_eof ) ) ? 0 : mingw_fsize_error();
+  }
+  /* When we cannot set the end of file marker directly, we must save
+   * the current file pointer, (to restore later), then move it to the
+   * new end of file; on WinNT, (before Vista), that is all we need to
+   * do, but when extending the file on Win9x, we must first fill the
+   * extended space with zeros, by writing them from the current end
+   * of file, (which also moves the file pointer).
+   */
+  cur.value = 0LL;
+  cur.li.LowPart = SetFilePointer( fh, 0L, &cur.li.HighPart, FILE_CURRENT );
+  if( (cur.li.LowPart == INVALID_SET_FILE_POINTER) && (GetLastError() != NO_ERROR) )
+    return mingw_fsize_error();
+
+  if( (length > eof.value) && ((_osver & 0x8000) != 0) )
   {
-    /* In this case, the file is to be extended beyond its current
-     * end of file offset; initialize a NUL filled buffer, which we
-     * may then copy to the extended region of the file, to satisfy
-     * the POSIX.1 requirement that this region shall be NUL filled.
-     */
-    char padding[BUFSIZ];
-    memset( padding, 0, sizeof( padding ) );
-
-    /* Recompute the desired offset, relative to the current end of
-     * file, then repeatedly write copies of the NUL filled buffer,
-     * until the file space represented by this relative offset has
-     * been completely filled; (this results in advancement of the
-     * file pointer to the desired new end of file offset).
-     */
-    offset -= end_offset;
-    while( offset > (__off64_t)(sizeof( padding )) )
-      offset -= write( fd, padding, sizeof( padding ) );
-    write( fd, padding, offset );
+    if( (SetFilePointer( fh, eof.li.LowPart, &eof.li.HighPart, FILE_BEGIN )
+	== INVALID_SET_FILE_POINTER) && (GetLastError() != NO_ERROR)  )
+      return mingw_fsize_error();
+    if( mingw_fsize_zero_fill( fh, eof.value, length ) != 0 )
+    { int retval = mingw_fsize_error();
+      SetFilePointer( fh, cur.li.LowPart, &cur.li.HighPart, FILE_BEGIN );
+      return retval;
+    }
   }
-  else
-    /* In the alternative case, the new end of file pointer will lie
-     * within the space already occupied by the file; we may simply
-     * seek directly to the desired offset.
-     */
-    _lseeki64( fd, offset, SEEK_SET );
+  else if( (SetFilePointer( fh, new_eof.li.LowPart, &new_eof.li.HighPart,
+	FILE_BEGIN ) == INVALID_SET_FILE_POINTER) && (GetLastError() != NO_ERROR) )
+    return mingw_fsize_error();
 
   /* We have now adjusted the file pointer to be coincident with the
    * desired new end of file offset; this is exactly what is required
-   * by the Windows API function, to mark the new end of file.
-   */
-  retval = SetEndOfFile( (void *)(_get_osfhandle( fd )) )
-    ? 0 : errout( EBADF );
-
-  /* Finally, we must restore the originally saved file pointer, before
-   * we return the status code from the ftruncate() operation.
+   * by the Windows API function, to mark the new end of file.  Once
+   * done, we must restore the originally saved file pointer.
    */
-  _lseeki64( fd, cur_offset, SEEK_SET );
-  return retval;
+  { int retval = SetEndOfFile( fh ) ? 0 : mingw_fsize_error();
+    SetFilePointer( fh, cur.li.LowPart, &cur.li.HighPart, FILE_BEGIN );
+    return retval;
+  }
 }
 
 /* Regardless of the platform version, Microsoft do not provide an
  * implementation of ftruncate64(); all link-time references to this
- * function will be resolved by this libmingwex.a implementation.
+ * function will be resolved by this libmingwex.a implementation, (as
+ * will references to ftruncate() itself; we prefer this, to Microsoft's
+ * _chsize() functions, since those fill any extended file space with
+ * explicitly written zeros, in blocks of no more than 4 kB).
  */
 int ftruncate64( int fd, __off64_t offset )
 {
   /* The offset parameter MUST be positive valued; bail out if not.
    */
   if( 0LL > offset ) return errout( EINVAL );
+  return __mingw_fsetsize( fd, offset, 0 );
+}
 
-  /* For offsets which may be represented by a 32-bit integer, we
-   * may ALWAYS delegate this call to Microsoft's _chsize().
+/* The POSIX posix_fallocate() function, (which we provide in terms of
+ * this 64-bit offset variant, as declared in <fcntl.h>), may similarly
+ * be delegated to __mingw_fsetsize(); we may note that, on WinNT, this
+ * ensures that storage is allocated for the entire extended file space,
+ * (unless the file has been explicitly marked as sparse).
+ */
+int posix_fallocate64( int fd, __off64_t offset, __off64_t len )
+{
+  /* Unlike most POSIX functions, posix_fallocate() reports failure by
+   * returning an error number, leaving "errno" unchanged.
    */
-  if( INT32_MAX >= offset ) return _chsize( fd, (off_t)(offset) );
-
-  { /* For offsets which cannot be represented within 32-bits, we
-     * MAY be able to delegate this call, (and also any subsequent
-     * calls), to Microsoft's _chsize_s(); set up a redirector to
-     * handle such delegation...
-     */
-    static int (*redirector_hook)( int, __off64_t ) = NULL;
-
-    /* ...initially checking for _chsize_s() availability...
-     */
-    if(  (redirector_hook == NULL)
-    &&  ((redirector_hook = dlsym( RTLD_DEFAULT, "_chsize_s" )) == NULL)  )
-
-      /* ...and setting up a suitable fallback if not...
-       */
-      redirector_hook = mingw_chsize64_fallback;
-
-    /* ...and ultimately, on initial selection, (and directly on
-     * all subsequent calls), hand off execution to the selected
-     * delegate function.
-     */
-    return redirector_hook( fd, offset );
-  }
+  int errno_saved = errno, retval = 0;
+
+  if( (offset < 0LL) || (len <= 0LL) )
+    return EINVAL;
+  if( offset > (INT64_MAX - len) )
+    return EFBIG;
+  if( __mingw_fsetsize( fd, offset + len, 1 ) != 0 )
+    retval = errno;
+  errno = errno_saved;
+  return retval;
 }
 
 /* $RCSfile$: end of file */
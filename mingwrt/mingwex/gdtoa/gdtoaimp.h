@@ -528,6 +528,7 @@ __hi0bits_D2A (ULong y)
 #define strcp_D2A __strcp_D2A
 #define strcp __strcp_D2A
 #define strtoIg __strtoIg_D2A
+#define strtodg_fast __strtodg_fast_D2A
 #define sum __sum_D2A
 #define tens __tens_D2A
 #define tinytens __tinytens_D2A
@@ -574,6 +575,7 @@ extern char *rv_alloc (int);
 extern Bigint *s2b (const char*, int, int, ULong, int);
 extern Bigint *set_ones (Bigint*, int);
 extern char *strcp (char*, const char*);
+extern int strtodg_fast (const char*, char**, FPI*, Long*, ULong*);
 extern Bigint *sum (Bigint*, Bigint*);
 extern int trailz (Bigint*);
 extern double ulp (dbl_union *);
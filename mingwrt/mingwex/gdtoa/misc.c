@@ -35,87 +35,86 @@ THIS SOFTWARE.
    headers, otherwise defines cause conflicts. */
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#endif	/* __MINGW32__ / __MINGW64__ */
 
-#define NLOCKS 2
-
-#ifdef USE_WIN32_SL
-/* Use spin locks. */
-static long dtoa_sl[NLOCKS];
-
-#define ACQUIRE_DTOA_LOCK(n) \
-  while (InterlockedCompareExchange (&dtoa_sl[n], 1, 0) != 0) \
-     Sleep (0);
-#define FREE_DTOA_LOCK(n) InterlockedExchange (&dtoa_sl[n], 0);
+#include "gdtoaimp.h"
 
-#else	/* USE_WIN32_SL */
+/* Rather than sharing one set of Bigint free lists among all threads,
+ * under the protection of a global lock, each thread keeps its own;
+ * thus Balloc() and Bfree() need no lock.  A Bigint may still be freed
+ * by a thread other than that which allocated it; it simply migrates
+ * to the free list of the thread which releases it.  We cap the length
+ * of each list, returning any surplus to the heap, and when the thread
+ * exits, a thread-local destructor returns the remainder.
+ */
+#define FREELIST_MAX 8
 
-#include <stdlib.h>
-static CRITICAL_SECTION dtoa_CritSec[NLOCKS];
-static long dtoa_CS_init = 0;
-/*
-   1 = initializing
-   2 = initialized
-   3 = deleted
-*/
-static void dtoa_lock_cleanup (void)
-{
-	long last_CS_init = InterlockedExchange (&dtoa_CS_init,3);
-	if (2 == last_CS_init) {
-		int i;
-		for (i = 0; i < NLOCKS; i++)
-			DeleteCriticalSection (&dtoa_CritSec[i]);
-	}
-}
+static __thread struct
+{ Bigint *head[Kmax+1];
+  int count[Kmax+1];
+  int registered;
+} freelist;
 
-static void dtoa_lock (int n)
-{
-	if (2 == dtoa_CS_init) {
-		EnterCriticalSection (&dtoa_CritSec[n]);
-		return;
-	}
-	else if (0 == dtoa_CS_init) {
-		long last_CS_init = InterlockedExchange (&dtoa_CS_init, 1);
-		if (0 == last_CS_init) {
-			int i;
-			for (i = 0; i < NLOCKS;  i++)
-				InitializeCriticalSection (&dtoa_CritSec[i]);
-			atexit (dtoa_lock_cleanup);
-			dtoa_CS_init = 2;
-		}
-		else if (2 == last_CS_init)
-			dtoa_CS_init = 2;
-	}
-	/*  Another thread is initializing. Wait. */
-	while (1 == dtoa_CS_init)
-		Sleep (1);
+extern int __cdecl __cxa_thread_atexit_impl (void (*)(void *), void *, void *);
 
-	/* It had better be initialized now. */
-	if (2 == dtoa_CS_init)
-		EnterCriticalSection(&dtoa_CritSec[n]);
-}
+#ifndef Omit_Private_Memory
+#ifndef PRIVATE_MEM
+#define PRIVATE_MEM 2304
+#endif
+#define PRIVATE_mem ((PRIVATE_MEM+sizeof(double)-1)/sizeof(double))
+static double private_mem[PRIVATE_mem];
+static volatile LONG pmem_used = 0;
 
-static void dtoa_unlock (int n)
+static Bigint *pmem_claim (unsigned int len)
 {
-	if (2 == dtoa_CS_init)
-		LeaveCriticalSection (&dtoa_CritSec[n]);
+	/* Claim len doubles from the process-wide private memory pool,
+	 * without any lock; a failed claim may leave pmem_used beyond
+	 * the end of the pool, but that is harmless, since the pool is
+	 * then exhausted in any case.
+	 */
+	LONG used;
+
+	if (pmem_used + len > PRIVATE_mem)
+		return NULL;
+	used = InterlockedExchangeAdd (&pmem_used, len);
+	if (used + len > PRIVATE_mem)
+		return NULL;
+	return (Bigint*)(private_mem + used);
 }
 
-#define ACQUIRE_DTOA_LOCK(n) dtoa_lock(n)
-#define FREE_DTOA_LOCK(n) dtoa_unlock(n)
-#endif	/* USE_WIN32_SL */
-
-#endif	/* __MINGW32__ / __MINGW64__ */
+#define pmem_owns(v) \
+	((double*)(v) >= private_mem && (double*)(v) < private_mem + PRIVATE_mem)
+#endif
 
-#include "gdtoaimp.h"
+static void freelist_drain (void *unused __attribute__((__unused__)))
+{
+	/* Thread exit destructor: release every Bigint remaining on the
+	 * exiting thread's free lists, (other than any which have been
+	 * carved from private_mem, which must simply be abandoned).  Such
+	 * abandoned blocks are not a leak; private_mem is a static pool,
+	 * which is never returned to the heap, and is small enough, (at
+	 * PRIVATE_MEM bytes, for the whole process), that it is cheaper
+	 * to forgo reuse of whatever an exiting thread held, than to pass
+	 * such blocks between threads.
+	 */
+	Bigint *v;
+	int k;
 
-static Bigint *freelist[Kmax+1];
+	for (k = 0; k <= Kmax; k++) {
+		while ((v = freelist.head[k]) != NULL) {
+			freelist.head[k] = v->next;
 #ifndef Omit_Private_Memory
-#ifndef PRIVATE_MEM
-#define PRIVATE_MEM 2304
-#endif
-#define PRIVATE_mem ((PRIVATE_MEM+sizeof(double)-1)/sizeof(double))
-static double private_mem[PRIVATE_mem], *pmem_next = private_mem;
+			if (!pmem_owns(v))
 #endif
+			free((void*)v);
+		}
+		freelist.count[k] = 0;
+	}
+	/* A later destructor may yet use gdtoa, so we must be prepared
+	 * to register again, should the lists be repopulated.
+	 */
+	freelist.registered = 0;
+}
 
 Bigint *Balloc (int k)
 {
@@ -125,11 +124,9 @@ Bigint *Balloc (int k)
 	unsigned int len;
 #endif
 
-	ACQUIRE_DTOA_LOCK(0);
-	/* The k > Kmax case does not need ACQUIRE_DTOA_LOCK(0), */
-	/* but this case seems very unlikely. */
-	if (k <= Kmax && (rv = freelist[k]) !=0) {
-		freelist[k] = rv->next;
+	if (k <= Kmax && (rv = freelist.head[k]) !=0) {
+		freelist.head[k] = rv->next;
+		freelist.count[k]--;
 	}
 	else {
 		x = 1 << k;
@@ -140,11 +137,7 @@ Bigint *Balloc (int k)
 #else
 		len = (sizeof(Bigint) + (x-1)*sizeof(ULong) + sizeof(double) - 1)
 			/sizeof(double);
-		if (k <= Kmax && pmem_next - private_mem + len <= PRIVATE_mem) {
-			rv = (Bigint*)pmem_next;
-			pmem_next += len;
-		}
-		else
+		if (k > Kmax || (rv = pmem_claim(len)) == NULL)
       {
 			rv = (Bigint*)MALLOC(len*sizeof(double));
       if (rv == NULL)
@@ -154,7 +147,6 @@ Bigint *Balloc (int k)
 		rv->k = k;
 		rv->maxwds = x;
 	}
-	FREE_DTOA_LOCK(0);
 	rv->sign = rv->wds = 0;
 	return rv;
 }
@@ -164,11 +156,19 @@ void Bfree (Bigint *v)
 	if (v) {
 		if (v->k > Kmax)
 			free((void*)v);
+		else if (freelist.count[v->k] >= FREELIST_MAX
+#ifndef Omit_Private_Memory
+		&& !pmem_owns(v)
+#endif
+		)
+			free((void*)v);
 		else {
-			ACQUIRE_DTOA_LOCK(0);
-			v->next = freelist[v->k];
-			freelist[v->k] = v;
-			FREE_DTOA_LOCK(0);
+			if (!freelist.registered
+			&& __cxa_thread_atexit_impl (freelist_drain, NULL, NULL) == 0)
+				freelist.registered = 1;
+			v->next = freelist.head[v->k];
+			freelist.head[v->k] = v;
+			freelist.count[v->k]++;
 		}
 	}
 }
@@ -420,70 +420,132 @@ Bigint *mult (Bigint *a, Bigint *b)
 	return c;
 }
 
-static Bigint *p5s;
+/* Powers of five, 5^(2^(n+2)) for n = 0..8, as used by pow5mult(),
+ * laid out as Bigints.  These were formerly computed on first use, and
+ * cached in a linked list, under the protection of a lock; as constant
+ * data, they may be shared by all threads, with no locking.
+ */
+#define P5_BIGINT(W) \
+	struct { Bigint *next; int k, maxwds, sign, wds; ULong x[W]; }
+
+static const P5_BIGINT(1) p5_4 = { NULL, 1, 2, 0, 1, {
+	0x00000271
+}};
+static const P5_BIGINT(1) p5_8 = { NULL, 1, 2, 0, 1, {
+	0x0005f5e1
+}};
+static const P5_BIGINT(2) p5_16 = { NULL, 1, 2, 0, 2, {
+	0x86f26fc1, 0x00000023
+}};
+static const P5_BIGINT(3) p5_32 = { NULL, 2, 4, 0, 3, {
+	0x85acef81, 0x2d6d415b, 0x000004ee
+}};
+static const P5_BIGINT(5) p5_64 = { NULL, 3, 8, 0, 5, {
+	0xbf6a1f01, 0x6e38ed64, 0xdaa797ed, 0xe93ff9f4, 0x00184f03
+}};
+static const P5_BIGINT(10) p5_128 = { NULL, 4, 16, 0, 10, {
+	0x2e953e01, 0x03df9909, 0x0f1538fd, 0x2374e42f, 0xd3cff5ec,
+	0xc404dc08, 0xbccdb0da, 0xa6337f19, 0xe91f2603, 0x0000024e
+}};
+static const P5_BIGINT(19) p5_256 = { NULL, 5, 32, 0, 19, {
+	0x982e7c01, 0xbed3875b, 0xd8d99f72, 0x12152f87, 0x6bde50c6,
+	0xcf4a6e70, 0xd595d80f, 0x26b2716e, 0xadc666b0, 0x1d153624,
+	0x3c42d35a, 0x63ff540e, 0xcc5573c0, 0x65f9ef17, 0x55bc28f2,
+	0x80dcc7f7, 0xf46eeddc, 0x5fdcefce, 0x000553f7
+}};
+static const P5_BIGINT(38) p5_512 = { NULL, 6, 64, 0, 38, {
+	0xfc6cf801, 0x77f27267, 0x8f9546dc, 0x5d96976f, 0xb83a8a97,
+	0xc31e1ad9, 0x46c40513, 0x94e65747, 0xc88976c1, 0x4475b579,
+	0x28f8733b, 0xaa1da1bf, 0x703ed321, 0x1e25cfea, 0xb21a2f22,
+	0xbc51fb2e, 0x96e14f5d, 0xbfa3edac, 0x329c57ae, 0xe7fc7153,
+	0xc3fc0695, 0x85a91924, 0xf95f635e, 0xb2908ee0, 0x93abade4,
+	0x1366732a, 0x9449775c, 0x69be5b0e, 0x7343afac, 0xb099bc81,
+	0x45a71d46, 0xa2699748, 0x8cb07303, 0x8a0b1f13, 0x8cab8a97,
+	0xc1d238d9, 0x633415d4, 0x0000001c
+}};
+static const P5_BIGINT(75) p5_1024 = { NULL, 7, 128, 0, 75, {
+	0x2919f001, 0xf55b2b72, 0x6e7c215b, 0x1ec29f86, 0x991c4e87,
+	0x15c51a88, 0x140ac535, 0x4c7d1e1a, 0xcc2cd819, 0x0ed1440e,
+	0x896634ee, 0x7de16cfb, 0x1e43f61f, 0x9fce837d, 0x231d2b9c,
+	0x233e55c7, 0x65dc60d7, 0xf451218b, 0x1c5cd134, 0xc9635986,
+	0x922bbb9f, 0xa7e89431, 0x9f9f2a07, 0x62be695a, 0x8e1042c4,
+	0x045b7a74, 0x1abe1de3, 0x8ad822a5, 0xba34c411, 0xd814b505,
+	0xbf3fdeb3, 0x8fc51a16, 0xb1b896bc, 0xf56deeec, 0x31fb6bfd,
+	0xb6f4654b, 0x101a3616, 0x6b7595fb, 0xdc1a47fe, 0x80d98089,
+	0x80bda5a5, 0x9a202882, 0x31eb0f66, 0xfc8f1f90, 0x976a3310,
+	0xe26a7b7e, 0xdf68368a, 0x3ce3a0b8, 0x8e4262ce, 0x75a351a2,
+	0x6cb0b6c9, 0x44597583, 0x31b5653f, 0xc356e38a, 0x35faaba6,
+	0x0190fba0, 0x9fc4ed52, 0x88bc491b, 0x1640114a, 0x005b8041,
+	0xf4f3235e, 0x1e8d4649, 0x36a8de06, 0x73c55349, 0xa7e6bd2a,
+	0xc1a6970c, 0x47187094, 0xd2db49ef, 0x926c3f5b, 0xae6209d4,
+	0x2d433949, 0x34f4a3c6, 0xd4305d94, 0xd9d61a05, 0x00000325
+}};
+
+static Bigint *const p5s[] = {
+	(Bigint *)(&p5_4), (Bigint *)(&p5_8), (Bigint *)(&p5_16),
+	(Bigint *)(&p5_32), (Bigint *)(&p5_64), (Bigint *)(&p5_128),
+	(Bigint *)(&p5_256), (Bigint *)(&p5_512), (Bigint *)(&p5_1024)
+};
+
+#define P5S_COUNT (int)(sizeof(p5s)/sizeof(*p5s))
 
 Bigint *pow5mult (Bigint *b, int k)
 {
-	Bigint *b1, *p5, *p51;
+	Bigint *b1, *p5, *p51, *p5t;
 	int i;
 	static int p05[3] = { 5, 25, 125 };
 
+	/* On failure, b is released, (as it would have been, on success),
+	 * together with any power of five computed beyond the table.
+	 */
 	if ( (i = k & 3) !=0)
     {
-      b = multadd(b, p05[i-1], 0);
-      if (b == NULL)
+      b1 = multadd(b, p05[i-1], 0);
+      if (b1 == NULL)
+      {
+        Bfree(b);
         return NULL;
+      }
+      b = b1;
     }
 
 	if (!(k >>= 2))
 		return b;
-	if ((p5 = p5s) == 0) {
-		/* first time */
-#ifdef MULTIPLE_THREADS
-		ACQUIRE_DTOA_LOCK(1);
-		if (!(p5 = p5s)) {
-			p5 = p5s = i2b(625);
-      if (p5 == NULL)
-        return NULL;
-			p5->next = 0;
-		}
-		FREE_DTOA_LOCK(1);
-#else
-		p5 = p5s = i2b(625);
-    if (p5 == NULL)
-      return NULL;
-		p5->next = 0;
-#endif
-	}
+	p5 = p5s[i = 0];
+	p5t = NULL;
 	for(;;) {
 		if (k & 1) {
 			b1 = mult(b, p5);
       if (b1 == NULL)
+      {
+        Bfree(p5t);
+        Bfree(b);
         return NULL;
+      }
 			Bfree(b);
 			b = b1;
 		}
 		if (!(k >>= 1))
 			break;
-		if ((p51 = p5->next) == 0) {
-#ifdef MULTIPLE_THREADS
-			ACQUIRE_DTOA_LOCK(1);
-			if (!(p51 = p5->next)) {
-				p51 = p5->next = mult(p5,p5);
-        if (p51 == NULL)
-          return NULL;
-				p51->next = 0;
-			}
-			FREE_DTOA_LOCK(1);
-#else
-			p51 = p5->next = mult(p5,p5);
+		if (++i < P5S_COUNT)
+			p5 = p5s[i];
+		else {
+			/* Beyond the end of the table; such huge powers
+			 * are rarely needed, so compute them as required,
+			 * and discard them when done.
+			 */
+			p51 = mult(p5,p5);
       if (p51 == NULL)
+      {
+        Bfree(p5t);
+        Bfree(b);
         return NULL;
-			p51->next = 0;
-#endif
+      }
+			Bfree(p5t);
+			p5 = p5t = p51;
 		}
-		p5 = p51;
 	}
+	Bfree(p5t);
 	return b;
 }
 
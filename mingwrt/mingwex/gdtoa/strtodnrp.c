@@ -45,7 +45,8 @@ double __strtod (const char *s, char **sp)
 	int k;
 	union { ULong L[2]; double d; } u;
 
-	k = __strtodg(s, sp, &fpi, &exp, bits);
+	if ((k = strtodg_fast(s, sp, &fpi, &exp, bits)) < 0)
+		k = __strtodg(s, sp, &fpi, &exp, bits);
 	switch(k & STRTOG_Retmask) {
 	  case STRTOG_NoNumber:
 	  case STRTOG_Zero:
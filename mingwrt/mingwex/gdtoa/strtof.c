@@ -44,7 +44,8 @@ float __strtof (const char *s, char **sp)
 #define fpi &fpi0
 #endif
 
-	k = __strtodg(s, sp, fpi, &exp, bits);
+	if ((k = strtodg_fast(s, sp, fpi, &exp, bits)) < 0)
+		k = __strtodg(s, sp, fpi, &exp, bits);
 	switch(k & STRTOG_Retmask) {
 	  case STRTOG_NoNumber:
 	  case STRTOG_Zero:
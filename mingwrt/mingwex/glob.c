@@ -7,7 +7,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2011-2014, 2017, 2018, 2022, MinGW.OSDN Project.
+ * Copyright (C) 2011-2014, 2017, 2018, 2022, 2026, MinGW.OSDN Project.
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -346,163 +346,189 @@ static const char *glob_in_set( const char *set, int test, int flags )
   return NULL;
 }
 
-static int glob_strcmp( const char *pattern, const char *text, int flags )
+struct glob_token
 {
-  /* Compare "text" to a specified globbing "pattern" using semantics
-   * comparable to "strcmp()"; returns zero for a complete match, else
-   * non-zero for a mismatch.
+  /* A private data structure, representing one element of a globbing
+   * pattern, as compiled by glob_compile(); it is either a '*' wild
+   * card, or a map of every character which may satisfy a match for
+   * one character of candidate text, as specified by a literal, (with
+   * case folding applied, as appropriate), a '?' wild card, or a set.
+   */
+  int			 star;
+  unsigned char 	 map[32];
+};
+
+struct glob_matcher
+{
+  /* A private data structure, representing one globbing pattern, (or
+   * path name component thereof), compiled to a sequence of tokens;
+   * it is compiled once, for matching against any number of entries
+   * within any number of directories.
+   */
+  int			 period;
+  struct glob_token	*end;
+  struct glob_token	 token[];
+};
+
+GLOB_INLINE void glob_map_char( struct glob_token *token, int c )
+{
+  token->map[(unsigned char)(c) >> 3] |= 1 << ((unsigned char)(c) & 7);
+}
+
+static struct glob_matcher *glob_compile( const char *pattern, int flags )
+{
+  /* Compile "pattern" into a glob_matcher, for use by glob_matches();
+   * returns NULL, if there is insufficient memory.
    *
    * Within "pattern":
    *   '?'     matches any one character in "text" (except '\0')
    *   '*'     matches any sequence of zero or more characters in "text"
    *   [SET]   matches any one character in "text" which is also in "SET"
    *   [!SET]  matches any one character in "text" which is NOT in "SET"
+   *
+   * Every element, other than '*', matches exactly one character; we
+   * compile each to a map of all characters which it will match, by
+   * applying the appropriate comparison to every possible character,
+   * once only, rather than once per character of each candidate text.
    */
-  register const char *p = pattern, *t = text;
-  register int c;
+  register const char *p = pattern;
+  register int c, test;
+  struct glob_token *token;
+  struct glob_matcher *matcher;
 
-  if( (*t == '.') && (*p != '.') && ((flags & GLOB_PERIOD) == 0) )
-    /*
-     * The special GNU extension allowing wild cards to match a period
-     * as first character is NOT in effect; "text" DOES have an initial
-     * period character AND "pattern" DOES NOT match it EXPLICITLY, so
-     * this comparison must report a MISMATCH.
-     */
-    return *p - *t;
+  /* There can be no more tokens than there are characters in "pattern".
+   */
+  if( (matcher = malloc( sizeof( struct glob_matcher )
+	+ strlen( pattern ) * sizeof( struct glob_token ))) == NULL  )
+    return NULL;
 
-  /* Attempt to match "pattern", character by character...
+  /* Unless the GNU extension, which allows wild cards to match a period
+   * as first character, is in effect, a candidate text with an initial
+   * period may be matched only if "pattern" matches it EXPLICITLY.
    */
-  while( (c = *p++) != '\0' )
+  matcher->period = (*p == '.') || ((flags & GLOB_PERIOD) != 0);
+
+  for( token = matcher->token; (c = *p++) != '\0'; token++ )
   {
-    /* ...so long as we haven't exhausted it...
-     */
-    switch( c )
+    if( (token->star = (c == '*')) != 0 )
     {
-      case '?':
-	/* Match any one character...
-	 */
-	if( *t++ == '\0' )
-	  /* ...but when there isn't one left to be matched,
-	   * then we must report a mismatch.
-	   */
-	  return '?';
-	break;
+      /* Match any sequence of zero or more characters; any repeated
+       * '*' in the pattern is redundant, so we simply ignore it.
+       */
+      while( *p == '*' )
+	p++;
+      continue;
+    }
+    memset( token->map, 0, sizeof( token->map ) );
 
-      case '*':
-	/* Match any sequence of zero or more characters...
-	 */
-	while( *p == '*' )
-	  /*
-	   * ...ignoring any repeated '*' in the pattern...
-	   */
-	  p++;
+    if( c == '?' )
+    {
+      /* Match any one character.
+       */
+      memset( token->map, 0xff, sizeof( token->map ) );
+    }
 
-	/* ...and if we've exhausted the pattern...
-	 */
-	if( *p == '\0' )
-	  /*
-	   * ...then we simply match all remaining characters,
-	   * to the end of "text", so we may return immediately,
-	   * reporting a successful match.
-	   */
-	  return 0;
-
-	/* When we haven't exhausted the pattern, then we may
-	 * attempt to recursively match the remainder of the
-	 * pattern to some terminal substring of "text"; we do
-	 * this iteratively, stepping over as many characters
-	 * of "text" as necessary, (and which thus match the '*'
-	 * in "pattern"), until we either find the start of this
-	 * matching substring, or we exhaust "text" without any
-	 * possible match...
-	 */
-	do { c = glob_strcmp( p, t, flags | GLOB_PERIOD );
-	   } while( (c != 0) && (*t++ != '\0') );
+    else if( c == '[' )
+    {
+      /* Match (or not match) exactly one character with any one of
+       * a set of characters in the pattern; note that, if the set is
+       * malformed, the resultant map will be empty, so the token will
+       * match nothing, and it must be the last token compiled.
+       */
+      const char *set = p, *end;
+      int exclude = (*set == '!');
+      set += exclude;
+
+      /* Locate the end of the set, taking care that a ']' which appears
+       * as its first character is a literal member...
+       */
+      if( (end = glob_set_adjusted( set + (*set == ']'), flags )) != NULL )
 	/*
-	 * ...and ultimately, we return the result of this
-	 * recursive attempt to find a match.
+	 * ...then map every character, (except NUL), which is included
+	 * in, (or for [!SET], which is excluded from), the set.
 	 */
-	return c;
+	for( test = 1; test < 256; test++ )
+	  if( (glob_in_set( set, (char)(test), flags ) == NULL) == (exclude != 0) )
+	    glob_map_char( token, test );
 
-      case '[':
-	/* Here we need to match (or not match) exactly one
-	 * character from the candidate text with any one of
-	 * a set of characters in the pattern...
-	 */
-	if( (c = *t++) == '\0' )
-	  /*
-	   * ...but, we must return a mismatch if there is no
-	   * candidate character left to match.
-	   */
-	  return '[';
+      if( (p = end) == NULL )
+      { ++token; break; }
+    }
 
-	if( *p == '!' )
-	{
-	  /* Match any one character which is NOT in the SET
-	   * specified by [!SET].
-	   */
-	  if( glob_in_set( ++p, c, flags ) == NULL )
-	  {
-	    if( *p == ']' )
-	      p++;
-	    p = glob_set_adjusted( p, flags );
-	  }
-	}
-	else
-	{ /* Match any one character which IS in the SET
-	   * specified by [SET].
-	   */
-	  p = glob_in_set( p, c, flags );
-	}
-	if( p == NULL )
-	  /*
-	   * The character under test didn't satisfy the SET
-	   * matching criterion; return as unmatched.
-	   */
-	  return ']';
-	break;
-
-      default:
-	/* The escape character cannot be handled as a regular
-	 * switch case, because the escape character is specified
-	 * as a variable, (to better support Microsoft nuisances).
-	 * The escape mechanism may have been disabled within the
-	 * glob() call...
+    else
+    { /* The escape character cannot be handled as a regular case,
+       * because the escape character is specified as a variable, (to
+       * better support Microsoft nuisances).  The escape mechanism may
+       * have been disabled within the glob() call...
+       */
+      if(  ((flags & GLOB_NOESCAPE) == 0)
+	/*
+	 * ...but when it is active, and we find an escape character...
 	 */
-	if(  ((flags & GLOB_NOESCAPE) == 0)
-	  /*
-	   * ...but when it is active, and we find an escape
-	   * character without exhausting the pattern...
-	   */
-	&& (c == glob_escape_char) && ((c = *p) != 0)  )
-	  /*
-	   * ...then we handle the escaped character here, as
-	   * a literal, and step over it, within the pattern.
-	   */
-	  ++p;
-
-	/* When we get to here, a successful match requires that
-	 * the current pattern character "c" is an exact literal
-	 * match for the next available character "t", if any,
-	 * in the candidate text string...
+      && (c == glob_escape_char) && (*p != '\0')  )
+	/*
+	 * ...without exhausting the pattern, then we handle the escaped
+	 * character as a literal; (an escape character which appears at
+	 * the end of the pattern has nothing to escape, so it remains as
+	 * a literal match for itself).
 	 */
-	if( (*t == '\0') || (glob_case_match( flags, c, *t ) != 0) )
-	  /*
-	   * ...otherwise we return a mismatch.
-	   */
-	  return c - *t;
+	c = *p++;
 
-	/* No mismatch yet; proceed to test the following character
-	 * within the candidate text string.
-	 */
-	t++;
+      /* A literal matches itself, and when case is not significant,
+       * it also matches any other character which compares equal.
+       */
+      for( test = 1; test < 256; test++ )
+	if( glob_case_match( flags, c, (char)(test) ) == 0 )
+	  glob_map_char( token, test );
     }
   }
-  /* When we've exhausted the pattern, then this final check will return
-   * a match if we've simultaneously exhausted the candidate text string,
-   * or a mismatch otherwise.
+  matcher->end = token;
+  return matcher;
+}
+
+static int glob_matches( const struct glob_matcher *matcher, const char *text )
+{
+  /* Check if "text" matches the compiled globbing pattern represented
+   * by "matcher"; returns non-zero for a complete match, else zero.
+   *
+   * We match tokens sequentially, while noting the text position at
+   * which the most recent '*' was encountered; on any mismatch, we
+   * need only resume matching from the token which follows that '*',
+   * having extended its match by one more character.  Since each of
+   * the intervening tokens matches exactly one character, there is
+   * never any need to revisit an earlier '*', and thus the cost of
+   * the match is bounded by the product of the pattern and text
+   * lengths, rather than growing exponentially with the number of
+   * '*' wild cards in the pattern.
+   */
+  register const unsigned char *t = (const unsigned char *)(text);
+  register const struct glob_token *token = matcher->token;
+  const struct glob_token *resume = NULL; const unsigned char *retry = t;
+
+  if( (*t == '.') && (matcher->period == 0) )
+    return 0;
+
+  while( *t != '\0' )
+  {
+    if( (token < matcher->end) && token->star )
+      resume = ++token, retry = t;
+
+    else if( (token < matcher->end)
+    && ((token->map[*t >> 3] & (1 << (*t & 7))) != 0)  )
+      ++token, ++t;
+
+    else if( resume != NULL )
+      token = resume, t = ++retry;
+
+    else return 0;
+  }
+  /* When we've exhausted the text, we have a match only if we have
+   * simultaneously exhausted the pattern, (or all that remains of it
+   * is '*', which may match an empty sequence).
    */
-  return c - *t;
+  while( (token < matcher->end) && token->star )
+    ++token;
+  return token == matcher->end;
 }
 
 #ifdef DT_DIR
@@ -543,6 +569,20 @@ static int glob_strcmp( const char *pattern, const char *text, int flags )
 # define D_NAMLEN( entry )  (strlen( (entry)->d_name ))
 #endif
 
+GLOB_INLINE size_t glob_slots( size_t entries )
+{
+  /* Inline helper to compute the number of slots to be allocated for
+   * gl_buf->gl_pathv, when it must accommodate "entries" pointers; by
+   * rounding up to a power of two, we ensure that the cost of storing
+   * each new glob result, (including any required expansion of the
+   * allocation), is amortised to a constant.
+   */
+  size_t slots = 8;
+  while( slots < entries )
+    slots <<= 1;
+  return slots;
+}
+
 static int glob_initialise( glob_t *gl_data )
 {
   /* Helper routine to initialise a glob_t structure
@@ -555,7 +595,7 @@ static int glob_initialise( glob_t *gl_data )
      * for storage of the globbed paths vector...
      */
     int entries = gl_data->gl_offs + 1;
-    if( (gl_data->gl_pathv = malloc( entries * sizeof( char ** ) )) == NULL )
+    if( (gl_data->gl_pathv = malloc( glob_slots( entries ) * sizeof( char ** ) )) == NULL )
       /*
        * ...bailing out, if insufficient free heap memory.
        */
@@ -575,32 +615,38 @@ static int glob_initialise( glob_t *gl_data )
   return GLOB_SUCCESS;
 }
 
-GLOB_INLINE int glob_expand( glob_t *gl_buf )
+GLOB_INLINE size_t glob_expand( glob_t *gl_buf )
 {
   /* Inline helper to compute the new size allocation required
-   * for buf->gl_pathv, prior to adding a new glob result.
+   * for buf->gl_pathv, prior to adding a new glob result; returns
+   * zero, when the existing allocation is sufficient.
    */
-  return ((2 + gl_buf->gl_pathc + gl_buf->gl_offs) * sizeof( char ** ));
+  size_t entries = 1 + gl_buf->gl_pathc + gl_buf->gl_offs;
+  if( glob_slots( entries + 1 ) == glob_slots( entries ) )
+    return 0;
+  return glob_slots( entries + 1 ) * sizeof( char ** );
 }
 
 static int glob_store_entry( char *path, glob_t *gl_buf )
 {
   /* Local helper routine to add a single path name entity
    * to the globbed path vector, after first expanding the
-   * allocated memory space to accommodate it.
+   * allocated memory space to accommodate it, if necessary.
    */
-  char **pathv;
+  char **pathv; size_t size;
   if(  (path != NULL)  &&  (gl_buf != NULL)
-  &&  ((pathv = realloc( gl_buf->gl_pathv, glob_expand( gl_buf ))) != NULL)  )
+  &&  (((size = glob_expand( gl_buf )) == 0)
+    || ((pathv = realloc( gl_buf->gl_pathv, size )) != NULL))  )
   {
-    /* Memory expansion was successful; store the new path name
-     * in place of the former NULL pointer at the end of the old
-     * vector...
+    /* Any required memory expansion was successful; store the new
+     * path name in place of the former NULL pointer at the end of
+     * the old vector...
      */
-    gl_buf->gl_pathv = pathv;
+    if( size != 0 )
+      gl_buf->gl_pathv = pathv;
     gl_buf->gl_pathv[gl_buf->gl_offs + gl_buf->gl_pathc++] = path;
     /*
-     * ...then place a further NULL pointer into the newly allocated
+     * ...then place a further NULL pointer into the next available
      * slot, to mark the new end of the vector...
      */
     gl_buf->gl_pathv[gl_buf->gl_offs + gl_buf->gl_pathc] = NULL;
@@ -614,72 +660,80 @@ static int glob_store_entry( char *path, glob_t *gl_buf )
   return GLOB_ABORTED;
 }
 
+struct glob_collated
+{
+  /* One globbed path name, as accumulated in a glob_collator, and its
+   * collation key, as computed by strxfrm(); comparison of such keys,
+   * by strcmp(), is equivalent to comparison of the original names,
+   * by strcoll(), but without repeating the transformation each time.
+   */
+  char			*key;
+  char			*path;
+};
+
 struct glob_collator
 {
-  /* A private data structure, used to keep an ordered collection
-   * of globbed path names in collated sequence within a (possibly
-   * unbalanced) binary tree.
+  /* A private data structure, used to accumulate the globbed path
+   * names matched within any one directory, each together with its
+   * collation key, so that all may be sorted into collated sequence
+   * in a single pass.
    */
-  struct glob_collator	*prev;
-  struct glob_collator	*next;
-  char  		*entry;
+  size_t		 count;
+  size_t		 limit;
+  struct glob_collated	*entry;
 };
 
-GLOB_INLINE struct glob_collator
-*glob_collate_entry( struct glob_collator *collator, char *entry, int flags )
+static int
+glob_collate_entry( struct glob_collator *collator, char *path, int flags )
 {
-  /* Inline helper function to construct a binary tree representation
-   * of a collated collection of globbed path name entities.
+  /* Helper function to add a globbed path name entity to a collator;
+   * returns GLOB_SUCCESS, or GLOB_NOSPACE if memory is exhausted.
    */
-  int seq = 0;
-  struct glob_collator *ref = collator;
-  struct glob_collator *lastref = collator;
-  while( ref != NULL )
+  size_t len = strlen( path );
+  char folded[1 + len], *key;
+  const char *src = path;
+
+  if( collator->count == collator->limit )
   {
-    /* Walk the tree, to find the leaf node representing the insertion
-     * point, in correctly collated sequence order, for the new entry,
-     * noting whether we must insert the new entry before or after the
-     * original entry at that leaf.
+    /* The collator is full; expand it, doubling its capacity each
+     * time, so that the cost of doing so is amortised.
      */
-    lastref = ref;
-    if( flags & GLOB_CASEMATCH )
-      seq = strcoll( entry, ref->entry );
-    else
-      seq = stricoll( entry, ref->entry );
-    ref = (seq > 0) ? ref->next : ref->prev;
+    struct glob_collated *entry;
+    size_t limit = (collator->limit > 0) ? collator->limit << 1 : 64;
+    if( (entry = realloc( collator->entry, limit * sizeof( *entry ))) == NULL )
+      return GLOB_NOSPACE;
+    collator->entry = entry; collator->limit = limit;
   }
-  /* Allocate storage for a new leaf node, and if successful...
-   */
-  if( (ref = malloc( sizeof( struct glob_collator ))) != NULL )
+  if( (flags & GLOB_CASEMATCH) == 0 )
   {
-    /* ...place the new entry on this new leaf...
+    /* When case is not significant, we must collate as stricoll()
+     * would do, so we transform a case folded copy of the path name.
      */
-    ref->entry = entry;
-    ref->prev = ref->next = NULL;
-
-    /* ...and attach it to the tree...
-     */
-    if( lastref != NULL )
-    {
-      /* ...either...
-       */
-      if( seq > 0 )
-	/*
-	 * ...after...
-	 */
-	lastref->next = ref;
-
-      else
-	/* ...or before...
-	 */
-	lastref->prev = ref;
-
-      /* ...the original leaf,as appropriate. */
-    }
+    char *p = folded;
+    do { *p++ = tolower( (unsigned char)(*src) ); } while( *src++ );
+    src = folded;
   }
-  /* When done, return a pointer to the root node of the resultant tree.
+  /* Compute the collation key, and store it, together with the path
+   * name itself, in the next available collator slot.
    */
-  return (collator == NULL) ? ref : collator;
+  len = strxfrm( NULL, src, 0 );
+  if( (key = malloc( 1 + len )) == NULL )
+    return GLOB_NOSPACE;
+  strxfrm( key, src, 1 + len );
+  collator->entry[collator->count].key = key;
+  collator->entry[collator->count++].path = path;
+  return GLOB_SUCCESS;
+}
+
+static int glob_collated_order( const void *a, const void *b )
+{
+  /* qsort() comparator for glob_collated entries; it orders them by
+   * collation key, and then, (to ensure a deterministic outcome for
+   * names which collate equally), by the path names themselves.
+   */
+  const struct glob_collated *x = a, *y = b;
+  int seq = strcmp( x->key, y->key );
+  return (seq != 0) ? seq : strcmp( x->path, y->path );
 }
 
 static void
@@ -687,34 +741,22 @@ glob_store_collated_entries( struct glob_collator *collator, glob_t *gl_buf )
 {
   /* A local helper routine to store a collated collection of globbed
    * path name entities into the path vector within a glob_t structure;
-   * it performs a recursive inorder traversal of a glob_collator tree,
-   * deleting it leaf by leaf, branch by branch, as it stores the path
-   * data contained thereon.
-   */
-  if( collator->prev != NULL )
-    /*
-     * Recurse into the sub-tree of entries which collate before the
-     * root of the current (sub-)tree.
-     */
-    glob_store_collated_entries( collator->prev, gl_buf );
-
-  /* Store the path name entry at the root of the current (sub-)tree.
-   */
-  glob_store_entry( collator->entry, gl_buf );
-
-  if( collator->next != NULL )
-    /*
-     * Recurse into the sub-tree of entries which collate after the
-     * root of the current (sub-)tree.
-     */
-    glob_store_collated_entries( collator->next, gl_buf );
-
-  /* Finally, delete the root node of the current (sub-)tree; since
-   * recursion visits every node of the tree, ultimately considering
-   * each leaf as a sub-tree of only one node, unwinding recursion
-   * will cause this to delete the entire tree.
+   * it sorts the entities into collated sequence, then stores each in
+   * turn, while releasing the collator's own storage.
    */
-  free( collator );
+  size_t index;
+  qsort( collator->entry, collator->count, sizeof( *collator->entry ),
+      glob_collated_order
+    );
+  for( index = 0; index < collator->count; index++ )
+  {
+    if( glob_store_entry( collator->entry[index].path, gl_buf ) != GLOB_SUCCESS )
+      free( collator->entry[index].path );
+    free( collator->entry[index].key );
+  }
+  free( collator->entry );
+  collator->entry = NULL;
+  collator->count = collator->limit = 0;
 }
 
 GLOB_INLINE int
@@ -1059,6 +1101,7 @@ glob_match( const char *pattern, int flags, int (*errfn)(), glob_t *gl_buf )
     char dirbuf[1 + strlen( pattern )];
     const char *dir = dirname( memcpy( dirbuf, pattern, sizeof( dirbuf )) );
     char **dirp, preferred_dirsep = GLOB_DIRSEP;
+    struct glob_matcher *matcher;
 
     /* Initialise a temporary local glob_t structure, to capture the
      * intermediate results at the current level of recursion...
@@ -1126,6 +1169,11 @@ glob_match( const char *pattern, int flags, int (*errfn)(), glob_t *gl_buf )
      */
     status = GLOB_NOMATCH;
 
+    /* Compile the pattern, once only, for matching against all entries
+     * in all of the candidate directories.
+     */
+    matcher = glob_compile( pattern, flags );
+
     /* When the caller has enabled the GLOB_NOCHECK option, then in the
      * case of any pattern with no prefix, and which contains no explicit
      * globbing token...
@@ -1145,14 +1193,19 @@ glob_match( const char *pattern, int flags, int (*errfn)(), glob_t *gl_buf )
      */
     else for( dirp = local_gl_buf.gl_pathv; *dirp != NULL; free( *dirp++ ) )
     {
-      /* Provided an earlier cycle hasn't scheduled an abort...
+      /* Provided we were able to compile the pattern...
        */
-      if( status != GLOB_ABORTED )
+      if( matcher == NULL )
+	status = GLOB_NOSPACE;
+
+      /* ...and an earlier cycle hasn't scheduled an abort...
+       */
+      else if( status != GLOB_ABORTED )
       {
 	/* ...take each candidate directory in turn, and prepare
 	 * to collate any matched entities within it...
 	 */
-	struct glob_collator *collator = NULL;
+	struct glob_collator collator = { 0, 0, NULL };
 
 	/* ...attempt to open the current candidate directory...
 	 */
@@ -1173,7 +1226,7 @@ glob_match( const char *pattern, int flags, int (*errfn)(), glob_t *gl_buf )
 	       * ...provided we don't require it to be a subdirectory,
 	       * or it actually is one...
 	       */
-	    && (glob_strcmp( pattern, entry->d_name, flags ) == 0)   )
+	    && glob_matches( matcher, entry->d_name )  )
 	    {
 	      /* ...and it is a globbed match for the pattern, then
 	       * we allocate a temporary local buffer of sufficient
@@ -1224,7 +1277,14 @@ glob_match( const char *pattern, int flags, int (*errfn)(), glob_t *gl_buf )
 		   * collating sequence order; divert the current
 		   * match into the collator.
 		   */
-		  collator = glob_collate_entry( collator, found, flags );
+		  if( glob_collate_entry( &collator, found, flags ) != GLOB_SUCCESS )
+		  {
+		    /* ...but, if it cannot be accommodated, we must
+		     * discard it, and report the shortage of memory.
+		     */
+		    free( found );
+		    status = GLOB_NOSPACE;
+		  }
 		}
 		else
 		{ /* Sorting has been suppressed for this glob;
@@ -1253,7 +1313,7 @@ glob_match( const char *pattern, int flags, int (*errfn)(), glob_t *gl_buf )
 
 	/* When we diverted the glob results for collation...
 	 */
-	if( collator != NULL )
+	if( collator.limit > 0 )
 	  /*
 	   * ...then we redirect them to gl_buf->gl_pathv now, before we
 	   * begin a new cycle, to process any further prefix directories
@@ -1261,14 +1321,15 @@ glob_match( const char *pattern, int flags, int (*errfn)(), glob_t *gl_buf )
 	   * we scheduled an abort, so that we may return any results we
 	   * may have already collected before the error occurred.
 	   */
-	  glob_store_collated_entries( collator, gl_buf );
+	  glob_store_collated_entries( &collator, gl_buf );
       }
     }
-    /* Finally, free the memory block allocated for the results vector
-     * in the internal glob buffer, to avoid leaking memory, before we
-     * return the resultant status code.
+    /* Finally, free the compiled pattern, and the memory block allocated
+     * for the results vector in the internal glob buffer, to avoid leaking
+     * memory, before we return the resultant status code.
      */
     free( local_gl_buf.gl_pathv );
+    free( matcher );
   }
   return status;
 }
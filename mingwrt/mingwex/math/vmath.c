@@ -0,0 +1,510 @@
+/*
+ * vmath.c
+ *
+ * SSE2 implementations of the exp(), log(), pow(), sin(), cos(), atan2(),
+ * and sqrt() functions, which evaluate two double precision arguments in
+ * each pass; each is delivered both as a scalar function, and as an array
+ * function, which applies the operation to every element of an array.
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * Microsoft's exp(), log(), pow(), etc. evaluate their arguments one at
+ * a time, on the x87 FPU; the alternatives provided here evaluate them in
+ * pairs, in SSE2 registers, using the algorithms of Sun Microsystems'
+ * fdlibm, (i.e. reduction of the argument to a small primary interval,
+ * followed by minimax polynomial approximation), adapted to avoid any
+ * data dependent branching.  In the pow() case, the logarithm of the
+ * base is carried to approximately twice double precision, before it
+ * is scaled by the exponent, so that the result remains accurate for
+ * the full range of exponents which do not cause overflow.
+ *
+ * Only arguments within the domain for which the SSE2 code is known to
+ * be accurate, and for which it cannot raise any exception, are handled
+ * by it; all others, (including zeros, infinities, NaNs, and those for
+ * which the result would overflow or underflow), are referred to the
+ * corresponding scalar function, which thus determines both the return
+ * value, and any errno assignment, in every special case.  Similarly,
+ * when running on a CPU which does not support SSE2, every argument is
+ * referred to the scalar function.
+ *
+ */
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+
+#include "cpu_features.h"
+
+/* Every function which manipulates SSE2 vectors, (or any data in SSE2
+ * registers), must be compiled for SSE2, but nothing else may be; they
+ * must not be called unless __cpu_features indicates SSE2 support.
+ */
+#define SSE2_FUNCTION	__attribute__((__target__ ("sse2,fpmath=sse")))
+
+/* Callers compiled for i386 need not have aligned the stack, as SSE2
+ * spill slots require, so any function which may be called from code
+ * which is not compiled for SSE2 must realign it.
+ */
+#define SSE2_ENTRY	SSE2_FUNCTION __attribute__((__force_align_arg_pointer__))
+
+typedef double   v2df __attribute__((__vector_size__ (16)));
+typedef int64_t  v2di __attribute__((__vector_size__ (16)));
+typedef uint64_t v2du __attribute__((__vector_size__ (16)));
+
+#define V2DF(c)  ((v2df){ (c), (c) })
+#define V2DU(c)  ((v2du){ (c), (c) })
+
+static __inline__ SSE2_FUNCTION
+v2df select( v2di mask, v2df a, v2df b )
+{ /* Compose a vector from elements of a, where mask is set, and from
+   * elements of b, where it is clear.
+   */
+  return (v2df)(((v2di)(a) & mask) | ((v2di)(b) & ~mask));
+}
+
+static __inline__ SSE2_FUNCTION
+v2df fabs_sse2( v2df x )
+{ return (v2df)((v2du)(x) & V2DU(0x7fffffffffffffffULL)); }
+
+/* Adding, and then subtracting, 1.5 * 2^52 rounds any double of lesser
+ * magnitude than 2^51 to the nearest integer; the intermediate sum then
+ * has this integer in the low order bits of its representation.
+ */
+#define ROUND_SHIFT	6755399441055744.0
+
+/* Split ln(2), and pi/2, into parts which may be multiplied by integers
+ * of limited magnitude, without loss of precision.
+ */
+#define LN2_HI		6.93147180369123816490e-01
+#define LN2_LO		1.90821492927058770002e-10
+#define INV_LN2 	1.44269504088896338700e+00
+
+#define TWO_THIRDS_HI	6.66666666666666629659e-01
+#define TWO_THIRDS_LO	3.70074341541718826e-17
+
+#define PIO2_1		1.57079632673412561417e+00
+#define PIO2_2		6.07710050630396597660e-11
+#define PIO2_3		2.02226624871116645580e-21
+#define PIO2_3T 	8.47842766036889956997e-32
+#define INV_PIO2	6.36619772367581382433e-01
+
+/* Bounds of the domains which are evaluated in SSE2 registers.
+ */
+#define EXP_MIN 	(-708.0)
+#define EXP_MAX 	(+709.0)
+#define POW_Y_MAX	8.452712498170644e+270	/* 2^900 */
+#define SINCOS_MAX	823549.0		/* 2^19 * pi/2 */
+#define SINCOS_TINY	1.490116119384765625e-08	/* 2^-26 */
+
+static __inline__ SSE2_FUNCTION
+v2df exp_kernel( v2df x, v2df xl )
+{ /* Compute e^(x + xl), for EXP_MIN <= x <= EXP_MAX, and |xl| no greater
+   * than one ulp of x, as 2^k * e^r, where k is the integer nearest to
+   * x / ln(2), and r = x + xl - k * ln(2), such that |r| <= ln(2)/2.
+   */
+  v2df t = x * V2DF( INV_LN2 ) + V2DF( ROUND_SHIFT );
+  v2df k = t - V2DF( ROUND_SHIFT );
+  v2df hi = x - k * V2DF( LN2_HI ), lo = k * V2DF( LN2_LO ) - xl;
+  v2df r = hi - lo, z = r * r, c, e;
+
+  /* e^r = 1 + r + r * c / (2 - c), where c = r - r^2 * P(r^2), and P is
+   * a minimax polynomial approximation, on the interval |r| <= ln(2)/2.
+   */
+  c = r - z * (V2DF( 1.66666666666666019037e-01 )
+    + z * (V2DF( -2.77777777770155933842e-03 )
+    + z * (V2DF( 6.61375632143793436117e-05 )
+    + z * (V2DF( -1.65339022054652515390e-06 )
+    + z * V2DF( 4.13813679705723846039e-08 )))));
+  e = V2DF( 1.0 ) - ((lo - (r * c) / (V2DF( 2.0 ) - c)) - hi);
+
+  /* Scale by 2^k, which we construct directly from the low order bits
+   * of t, in which k has been represented, by the rounding operation.
+   */
+  return e * (v2df)(((v2du)(t) + V2DU( 1023 )) << 52);
+}
+
+static __inline__ SSE2_FUNCTION
+v2df exp_sse2( v2df x, v2di *fail )
+{
+  *fail = ~((x >= V2DF( EXP_MIN )) & (x <= V2DF( EXP_MAX )));
+  return exp_kernel( select( *fail, V2DF( 0.0 ), x ), V2DF( 0.0 ) );
+}
+
+static __inline__ SSE2_FUNCTION
+v2df log_reduce( v2df x, v2df *k )
+{ /* Express positive, finite, normal x as 2^k * (1 + f), such that
+   * sqrt(2)/2 <= 1 + f < sqrt(2); return f, (which is exact), and
+   * store k, as a double, in the location referenced by k.
+   */
+  v2du ix = (v2du)(x) + V2DU( 0x00095f6200000000ULL );
+  *k = (v2df)((ix >> 52) | V2DU( 0x4330000000000000ULL ))
+    - V2DF( 4503599627371519.0 );	/* 2^52 + 1023 */
+  ix = (ix & V2DU( 0x000fffffffffffffULL )) + V2DU( 0x3fe6a09e00000000ULL );
+  return (v2df)(ix) - V2DF( 1.0 );
+}
+
+static __inline__ SSE2_FUNCTION
+v2df log_sse2( v2df x, v2di *fail )
+{
+  v2df k, f, s, z, w, hfsq, R;
+
+  *fail = ~((x >= V2DF( DBL_MIN )) & (x <= V2DF( DBL_MAX )));
+  f = log_reduce( select( *fail, V2DF( 1.0 ), x ), &k );
+
+  /* log(1 + f) = 2s + 2s^3/3 + 2s^5/5 + ..., where s = f / (2 + f); of
+   * this, f - f^2/2 is evaluated exactly, and the remainder by a minimax
+   * polynomial in s^2, on the interval 0 <= s^2 <= 0.1716^2.
+   */
+  hfsq = V2DF( 0.5 ) * f * f; s = f / (V2DF( 2.0 ) + f); z = s * s; w = z * z;
+  R = w * (V2DF( 3.999999999940941908e-01 )
+    + w * (V2DF( 2.222219843214978396e-01 )
+    + w * V2DF( 1.531383769920937332e-01 )))
+    + z * (V2DF( 6.666666666666735130e-01 )
+    + w * (V2DF( 2.857142874366239149e-01 )
+    + w * (V2DF( 1.818357216161805012e-01 )
+    + w * V2DF( 1.479819860511658591e-01 ))));
+  return s * (hfsq + R) + k * V2DF( LN2_LO ) - hfsq + f + k * V2DF( LN2_HI );
+}
+
+/* Dekker's exact product: for any a and b, (of magnitude less than about
+ * 2^995), a * b == p + *e, exactly, where p is the rounded product.
+ */
+static __inline__ SSE2_FUNCTION
+v2df split( v2df a, v2df *lo )
+{
+  v2df c = V2DF( 134217729.0 ) * a, hi = c - (c - a);
+  *lo = a - hi; return hi;
+}
+
+static __inline__ SSE2_FUNCTION
+v2df mul_exact( v2df a, v2df b, v2df *e )
+{
+  v2df al, ah = split( a, &al ), bl, bh = split( b, &bl ), p = a * b;
+  *e = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+  return p;
+}
+
+static __inline__ SSE2_FUNCTION
+v2df two_sum( v2df a, v2df b, v2df *e )
+{ /* Knuth's exact sum: a + b == s + *e, exactly, where s is the rounded
+   * sum, for any a and b, (in the absence of overflow).
+   */
+  v2df s = a + b, bb = s - a;
+  *e = (a - (s - bb)) + (b - bb);
+  return s;
+}
+
+static __inline__ SSE2_FUNCTION
+v2df pow_sse2( v2df x, v2df y, v2di *fail )
+{
+  v2df k, f, uh, ul, sh, sl, p, e, z, ze, c, ce, t, h, l, lh, ll, yh, yl;
+
+  *fail = ~((x >= V2DF( DBL_MIN )) & (x <= V2DF( DBL_MAX ))
+      & (fabs_sse2( y ) <= V2DF( POW_Y_MAX )));
+  x = select( *fail, V2DF( 1.0 ), x ); y = select( *fail, V2DF( 0.0 ), y );
+  f = log_reduce( x, &k );
+
+  /* As for log(), but we now require s = f / (2 + f) to double-double
+   * precision, sh + sl; note that 2 + f == uh + ul, exactly.
+   */
+  uh = V2DF( 2.0 ) + f; ul = f - (uh - V2DF( 2.0 ));
+  sh = f / uh; p = mul_exact( sh, uh, &e );
+  sl = (((f - p) - e) - sh * ul) / uh;
+
+  /* The remaining terms of the series, 2s^3/3 + 2s^5/5 + ..., amount
+   * to less than 1% of log(x), but their rounding error may still be
+   * amplified by a large y; thus, the leading term is also evaluated
+   * to double-double precision, as c + ce, and the remainder, t, is
+   * evaluated to more terms than the minimax polynomial of log()
+   * would require.
+   */
+  z = mul_exact( sh, sh, &ze ); c = mul_exact( z, sh, &ce );
+  ce = ce + ze * sh; z = z + ze;
+  t = c * z * (V2DF( 2.0 / 5.0 ) + z * (V2DF( 2.0 / 7.0 )
+    + z * (V2DF( 2.0 / 9.0 ) + z * (V2DF( 2.0 / 11.0 )
+    + z * (V2DF( 2.0 / 13.0 ) + z * (V2DF( 2.0 / 15.0 )
+    + z * (V2DF( 2.0 / 17.0 ) + z * (V2DF( 2.0 / 19.0 )
+    + z * (V2DF( 2.0 / 21.0 ) + z * V2DF( 2.0 / 23.0 ))))))))));
+  ce = ce * V2DF( TWO_THIRDS_HI ) + c * V2DF( TWO_THIRDS_LO )
+    + V2DF( 2.0 ) * z * sl;
+  c = mul_exact( c, V2DF( TWO_THIRDS_HI ), &e ); ce = ce + e;
+
+  /* Accumulate log(x) = k * ln(2) + 2 * (sh + sl) + c + ce + t, as
+   * lh + ll, recovering the errors of the two principal additions.
+   */
+  p = k * V2DF( LN2_HI ); sh = sh + sh;
+  h = p + sh; e = h - p; l = (p - (h - e)) + (sh - e);
+  p = h; h = p + c; e = h - p; l = l + ((p - (h - e)) + (c - e));
+  l = l + (k * V2DF( LN2_LO ) + (sl + sl + (ce + t)));
+  lh = h + l; ll = l - (lh - h);
+
+  /* Scale by y, and raise e to the resultant power.
+   */
+  yh = mul_exact( y, lh, &yl ); yl = yl + y * ll;
+  h = yh + yl; l = yl - (h - yh);
+  *fail |= ~((h >= V2DF( EXP_MIN )) & (h <= V2DF( EXP_MAX )));
+  return exp_kernel(
+      select( *fail, V2DF( 0.0 ), h ), select( *fail, V2DF( 0.0 ), l )
+    );
+}
+
+static __inline__ SSE2_FUNCTION
+v2df sincos_reduce( v2df x, v2df *yl, v2du *q )
+{ /* Reduce |x| <= SINCOS_MAX to y + *yl = x - n * pi/2, where n is the
+   * integer nearest to x * 2/pi, so that |y| <= pi/4; the low order bits
+   * of *q identify the quadrant, (n mod 4).  Each partial product of n,
+   * and a component of pi/2, is exact; the errors of the two principal
+   * subtractions are recovered exactly, and accumulated in *yl.
+   */
+  v2df t = x * V2DF( INV_PIO2 ) + V2DF( ROUND_SHIFT );
+  v2df n = t - V2DF( ROUND_SHIFT );
+  v2df a = x - n * V2DF( PIO2_1 ), b = n * V2DF( PIO2_2 );
+  v2df c = n * V2DF( PIO2_3 ), r, s, d, e;
+
+  r = a - b; d = r - a; e = (a - (r - d)) - (b + d);
+  s = r - c; d = s - r; e = e + ((r - (s - d)) - (c + d));
+  e = e - n * V2DF( PIO2_3T );
+  r = s + e; *yl = e - (r - s); *q = (v2du)(t);
+  return r;
+}
+
+static __inline__ SSE2_FUNCTION
+v2df sin_kernel( v2df y, v2df yl )
+{ /* sin(y + yl), for |y| <= pi/4, |yl| <= ulp(y)/2
+   */
+  v2df z = y * y, v = z * y, r;
+  r = V2DF( 8.33333333332248946124e-03 )
+    + z * (V2DF( -1.98412698298579493134e-04 )
+    + z * (V2DF( 2.75573137070700676789e-06 )
+    + z * (V2DF( -2.50507602534068634195e-08 )
+    + z * V2DF( 1.58969099521155010221e-10 ))));
+  return y - ((z * (V2DF( 0.5 ) * yl - v * r) - yl)
+      - v * V2DF( -1.66666666666666324348e-01 ));
+}
+
+static __inline__ SSE2_FUNCTION
+v2df cos_kernel( v2df y, v2df yl )
+{ /* cos(y + yl), for |y| <= pi/4, |yl| <= ulp(y)/2
+   */
+  v2df z = y * y, w = z * z, r, hz;
+  r = z * (V2DF( 4.16666666666666019037e-02 )
+    + z * (V2DF( -1.38888888888741095749e-03 )
+    + z * V2DF( 2.48015872894767294178e-05 )))
+    + w * w * (V2DF( -2.75573143513906633035e-07 )
+    + z * (V2DF( 2.08757232129817482790e-09 )
+    + z * V2DF( -1.13596475577881948265e-11 )));
+  hz = V2DF( 0.5 ) * z; w = V2DF( 1.0 ) - hz;
+  return w + (((V2DF( 1.0 ) - w) - hz) + (z * r - y * yl));
+}
+
+static __inline__ SSE2_FUNCTION
+v2df sin_sse2( v2df x, v2di *fail )
+{
+  v2df y, yl, r; v2du q;
+
+  *fail = ~(fabs_sse2( x ) <= V2DF( SINCOS_MAX ));
+  x = select( *fail, V2DF( 0.0 ), x );
+  y = sincos_reduce( x, &yl, &q );
+
+  /* sin(x) is sin(y), cos(y), -sin(y), or -cos(y), in quadrants 0..3;
+   * tiny x is returned unchanged, (which preserves the sign of zero).
+   */
+  r = select( -(v2di)(q & V2DU( 1 )), cos_kernel( y, yl ), sin_kernel( y, yl ) );
+  r = (v2df)((v2du)(r) ^ ((q & V2DU( 2 )) << 62));
+  return select( fabs_sse2( x ) < V2DF( SINCOS_TINY ), x, r );
+}
+
+static __inline__ SSE2_FUNCTION
+v2df cos_sse2( v2df x, v2di *fail )
+{
+  v2df y, yl, r; v2du q;
+
+  *fail = ~(fabs_sse2( x ) <= V2DF( SINCOS_MAX ));
+  x = select( *fail, V2DF( 0.0 ), x );
+  y = sincos_reduce( x, &yl, &q );
+
+  /* cos(x) is cos(y), -sin(y), -cos(y), or sin(y), in quadrants 0..3.
+   */
+  r = select( -(v2di)(q & V2DU( 1 )), sin_kernel( y, yl ), cos_kernel( y, yl ) );
+  return (v2df)((v2du)(r) ^ (((q + V2DU( 1 )) & V2DU( 2 )) << 62));
+}
+
+static __inline__ SSE2_FUNCTION
+v2df atan2_sse2( v2df y, v2df x, v2di *fail )
+{
+  /* Reduction of z = |y/x| to t = (a * |y| - b * |x|) / (a * |x| + b * |y|),
+   * where b = b1 + b2, with |t| <= 7/16, within each of five intervals of
+   * z, for which atan(z) = atan(hi + lo) + atan(t).
+   */
+  static const struct { double a, b1, b2, hi, lo; } range[] =
+  { { 1.0, 0.0, 0.0, 0.0, 0.0 },	/* 0 <= z < 7/16 */
+    { 2.0, 1.0, 0.0,			/* 7/16 <= z < 11/16 */
+      4.63647609000806093515e-01, 2.26987774529616870924e-17 },
+    { 1.0, 1.0, 0.0,			/* 11/16 <= z < 19/16 */
+      7.85398163397448278999e-01, 3.06161699786838301793e-17 },
+    { 1.0, 1.0, 0.5,			/* 19/16 <= z < 39/16 */
+      9.82793723247329054082e-01, 1.39033110312309984516e-17 },
+    { 0.0, 1.0, 0.0,			/* 39/16 <= z */
+      1.57079632679489655800e+00, 6.12323399573676603587e-17 }
+  };
+  v2df ax = fabs_sse2( x ), ay = fabs_sse2( y ), t, tl, w, v, s1, s2, r, rl;
+  v2df nh, nl, dh, dl, p, q, e, f;
+  v2di i;
+
+  *fail = ~((ax <= V2DF( DBL_MAX )) & (ay <= V2DF( DBL_MAX ))
+      & (ax > V2DF( 0.0 )) & (ay > V2DF( 0.0 )));
+  ax = select( *fail, V2DF( 1.0 ), ax ); ay = select( *fail, V2DF( 1.0 ), ay );
+
+  /* Scale |x| and |y| by a common power of two, such that the larger
+   * lies in [2^900, 2^901), or by 2^1023, if it is less than 2^-123;
+   * t is unchanged, but none of the exact products which follow may
+   * then overflow, or underflow, (unless t itself is negligible).
+   */
+  v = select( ay > ax, ay, ax );
+  v = select( v >= V2DF( 0x1p-123 ),
+      (v2df)((V2DU( 2946 ) - ((v2du)(v) >> 52)) << 52), V2DF( 0x1p1023 )
+    );
+  ax = ax * v; ay = ay * v;
+
+  /* Selection of the interval need not be exact; t remains within the
+   * domain of the polynomial, if z lies marginally outside it.
+   */
+  i = -((ay >= V2DF( 7.0 / 16.0 ) * ax) + (ay >= V2DF( 11.0 / 16.0 ) * ax)
+      + (ay >= V2DF( 19.0 / 16.0 ) * ax) + (ay >= V2DF( 39.0 / 16.0 ) * ax));
+# define RANGE(FIELD)  ((v2df){ range[i[0]].FIELD, range[i[1]].FIELD })
+
+  /* Evaluate t as t + tl, to double-double precision.  Every product of
+   * a, b1, or b2, is exact, as is the numerator, nh + nl, since its terms
+   * are within a factor of two of each other, (when neither is zero); we
+   * recover the errors of the sums, and of the quotient.
+   */
+  p = RANGE(b1) * ax; e = RANGE(b2) * ax; q = p + e; f = (p - q) + e;
+  nh = RANGE(a) * ay - q; nl = -f;
+  p = RANGE(b1) * ay; e = RANGE(b2) * ay; q = p + e; f = (p - q) + e;
+  dh = two_sum( RANGE(a) * ax, q, &dl ); dl = dl + f;
+  r = V2DF( 1.0 ) / dh; t = nh * r;
+  p = mul_exact( t, dh, &e );
+  tl = (((nh - p) - e) + (nl - t * dl)) * r;
+
+  /* atan(t + tl) = t - t * (s1 + s2) + tl / (1 + t^2), where s1 and s2
+   * are the odd and even terms of a minimax polynomial in t^2, on the
+   * interval |t| <= 7/16; tl is so small, that three terms of the series
+   * for 1 / (1 + t^2) will suffice.
+   */
+  w = t * t; v = w * w;
+  s1 = w * (V2DF( 3.33333333333329318027e-01 )
+    + v * (V2DF( 1.42857142725034663711e-01 )
+    + v * (V2DF( 9.09088713343650656196e-02 )
+    + v * (V2DF( 6.66107313738753120669e-02 )
+    + v * (V2DF( 4.97687799461593236017e-02 )
+    + v * V2DF( 1.62858201153657823623e-02 ))))));
+  s2 = v * (V2DF( -1.99999999998764832476e-01 )
+    + v * (V2DF( -1.11111104054623557880e-01 )
+    + v * (V2DF( -7.69187620504482999495e-02 )
+    + v * (V2DF( -5.83357013379057348645e-02 )
+    + v * V2DF( -3.65315727442169155270e-02 )))));
+  v = t - ((t * (s1 + s2) - RANGE(lo)) - tl * (V2DF( 1.0 ) - w + v));
+  r = RANGE(hi) + v; rl = v - (r - RANGE(hi));
+# undef RANGE
+
+  /* Adjust for the quadrant, as identified by the signs of x and y;
+   * when x is negative, the result is pi - (r + rl), which we evaluate
+   * without an intermediate rounding of r.
+   */
+  v = V2DF( 3.1415926535897931160e+00 ) - r;
+  w = (V2DF( 3.1415926535897931160e+00 ) - v) - r;
+  r = select( x < V2DF( 0.0 ),
+      v + ((w + V2DF( 1.2246467991473531772e-16 )) - rl), r
+    );
+  return (v2df)((v2du)(r) | ((v2du)(y) & V2DU( 0x8000000000000000ULL )));
+}
+
+static __inline__ SSE2_FUNCTION
+v2df sqrt_sse2( v2df x, v2di *fail )
+{
+  *fail = ~(x >= V2DF( 0.0 ));
+  return __builtin_ia32_sqrtpd( select( *fail, V2DF( 0.0 ), x ) );
+}
+
+/* Each array function processes its arguments in pairs, (duplicating
+ * the last, if their number is odd), referring any which the SSE2 code
+ * rejects to the scalar function; the result array may coincide with
+ * any of the argument arrays, but must not otherwise overlap them.
+ */
+#define __VMATH_UNARY(FN)						\
+static SSE2_ENTRY							\
+void FN##_array( double *r, const double *x, size_t n )		\
+{ v2df v; v2di fail; size_t i;						\
+  for( i = 0; n - i >= 2; i += 2 )					\
+  { v = FN##_sse2( (v2df){ x[i], x[i + 1] }, &fail );			\
+    r[i] = fail[0] ? FN( x[i] ) : v[0];					\
+    r[i + 1] = fail[1] ? FN( x[i + 1] ) : v[1];				\
+  }									\
+  if( i < n )								\
+  { v = FN##_sse2( (v2df){ x[i], x[i] }, &fail );			\
+    r[i] = fail[0] ? FN( x[i] ) : v[0];					\
+  }									\
+}									\
+void __mingw_v##FN( double *r, const double *x, size_t n )		\
+{ if( __cpu_features & _CRT_SSE2 ) FN##_array( r, x, n );		\
+  else while( n-- > 0 ) *r++ = FN( *x++ );				\
+}									\
+double __mingw_sse2_##FN( double x )					\
+{ __mingw_v##FN( &x, &x, 1 ); return x; }
+
+#define __VMATH_BINARY(FN)						\
+static SSE2_ENTRY							\
+void FN##_array( double *r, const double *x, const double *y, size_t n ) \
+{ v2df v; v2di fail; size_t i;						\
+  for( i = 0; n - i >= 2; i += 2 )					\
+  { v = FN##_sse2(							\
+	(v2df){ x[i], x[i + 1] }, (v2df){ y[i], y[i + 1] }, &fail	\
+      );								\
+    r[i] = fail[0] ? FN( x[i], y[i] ) : v[0];				\
+    r[i + 1] = fail[1] ? FN( x[i + 1], y[i + 1] ) : v[1];		\
+  }									\
+  if( i < n )								\
+  { v = FN##_sse2( (v2df){ x[i], x[i] }, (v2df){ y[i], y[i] }, &fail );	\
+    r[i] = fail[0] ? FN( x[i], y[i] ) : v[0];				\
+  }									\
+}									\
+void __mingw_v##FN( double *r, const double *x, const double *y, size_t n ) \
+{ if( __cpu_features & _CRT_SSE2 ) FN##_array( r, x, y, n );		\
+  else while( n-- > 0 ) *r++ = FN( *x++, *y++ );			\
+}									\
+double __mingw_sse2_##FN( double x, double y )				\
+{ __mingw_v##FN( &x, &x, &y, 1 ); return x; }
+
+__VMATH_UNARY(exp)
+__VMATH_UNARY(log)
+__VMATH_UNARY(sin)
+__VMATH_UNARY(cos)
+__VMATH_UNARY(sqrt)
+__VMATH_BINARY(pow)
+__VMATH_BINARY(atan2)
+
+/* $RCSfile$: end of file */
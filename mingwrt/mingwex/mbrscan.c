@@ -8,7 +8,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2020, 2022, MinGW.OSDN Project
+ * Copyright (C) 2020, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -89,6 +89,18 @@ int __mingw_mbtowc_convert
   unsigned int flags = MB_ERR_INVALID_CHARS;
   if( n == 0 ) n = (size_t)(-1);
 
+  if( __mingw_utfconv_codeset( codeset ) )
+  { /* For UTF-8, and ISO-8859-1, we perform the conversion directly;
+     * note that this will stop at a NUL byte, even within the bounds
+     * of "n", (but that NUL will have been converted, and counted).
+     */
+    size_t count = __mingw_utfconv_decode( ((wc == NULL) || (wmax == 0))
+	? NULL : (uint16_t *)(wc), wmax, &s, n, __mingw_utfconv_flags( codeset ),
+	&st
+      );
+    return ((st == UTFCONV_NUL) || (st == UTFCONV_END)) ? count : 0;
+  }
+
   do { SetLastError( 0 );
        st = MultiByteToWideChar( codeset, flags, s, n, wc, wmax );
      } while( (st == (flags = 0)) && (GetLastError() == ERROR_INVALID_FLAGS) );
@@ -10,7 +10,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2020, 2022, MinGW.OSDN Project
+ * Copyright (C) 2020, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -155,15 +155,60 @@ static __mb_inline__ size_t __mbsrtowcs_internal
   return count;
 }
 
+static __mb_inline__ size_t __mbsrtowcs_direct
+( wchar_t *restrict wcs, const char **restrict src, size_t len,
+  mbstate_t *restrict ps, unsigned int codeset
+)
+{ /* Alternative internal implementation of the mbsrtowcs() function,
+   * for use when a conversion buffer has been designated, and the MBCS
+   * sequence is encoded in a codeset which we may decode directly; in
+   * this case, we require only a single pass, both storing, and counting
+   * the converted wchar_t elements.
+   */
+  int status;
+  size_t count, extra;
+
+  /* As in the general case, we must first complete any pending state;
+   * if this remains incomplete, we can proceed no further.
+   */
+  count = __mingw_mbrscan_begin( &wcs, src, &len, ps );
+  if( (count == (size_t)(-1)) || (*ps != (mbstate_t)(0)) ) return count;
+
+  /* Convert the remainder of the MBCS sequence, until we store its NUL
+   * terminator, or we either exhaust the buffer space, or encounter an
+   * invalid MBCS sequence.
+   */
+  extra = __mingw_utfconv_decode( (uint16_t *)(wcs), len, src, (size_t)(-1),
+      __mingw_utfconv_flags( codeset ), &status
+    );
+  if( status == UTFCONV_EILSEQ ) return errout( EILSEQ, (size_t)(-1) );
+
+  /* On storing the terminating NUL, ISO-C99 decrees that we must reset
+   * the MBCS pointer to NULL, and that the NUL must not be counted;
+   * otherwise, the MBCS pointer has already been advanced to the start
+   * of the first sequence which could not be stored.
+   */
+  if( status == UTFCONV_NUL )
+  { *src = NULL;
+    --extra;
+  }
+  return count + extra;
+}
+
 size_t mbsrtowcs
 ( wchar_t *restrict wcs, const char **restrict src, size_t len,
   mbstate_t *restrict ps
 )
 { /* Implementation of ISO-C99 mbsrtowcs() function, in libmingwex.a;
    * this stores the effective codeset properties, before returning the
-   * result from expansion of the preceding inline implementation.
+   * result from expansion of the appropriate preceding inline function.
    */
-  (void)(__mingw_mbrlen_cur_max_init( __mingw_mbrtowc_codeset_init() ));
+  unsigned int codeset = __mingw_mbrtowc_codeset_init();
+  (void)(__mingw_mbrlen_cur_max_init( codeset ));
+
+  if( (wcs != NULL) && (src != NULL) && (*src != NULL)
+  &&  __mingw_utfconv_codeset( codeset )  )
+    return __mbsrtowcs_direct( wcs, src, len, __mbrtowc_state( ps ), codeset );
   return __mbsrtowcs_internal( wcs, src, len, __mbrtowc_state( ps ) );
 }
 
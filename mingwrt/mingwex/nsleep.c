@@ -3,12 +3,13 @@
  *
  * Core implementation of the __mingw_sleep() API, which facilitates the
  * provision of (mostly) POSIX compliant sleep(), usleep(), and nanosleep()
- * functions, (per inline implementations in unistd.h).
+ * functions, (per inline implementations in unistd.h), together with the
+ * POSIX clock_nanosleep() function.
  *
  * $Id$
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2014, 2022, MinGW.OSDN Project
+ * Copyright (C) 2014, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -31,15 +32,192 @@
  * DEALINGS IN THE SOFTWARE.
  *
  */
-#include <errno.h>
+#include "clockapi.h"
+#include "nsleep.h"
+
 #include <limits.h>
 #include <unistd.h>
 
-/* Including windows.h, just to declare Sleep(), seems like overkill; we
- * prefer to declare it directly, to ensure we get the kernel DLL import,
- * without the overhead of redirection through a libkernel.a trampoline.
+/* The following are not defined by our <winbase.h>; they are required
+ * only for the CreateWaitableTimerExW() API, (which is not available
+ * prior to Vista, so we must resolve it at run time).
  */
-__declspec(dllimport) _stdcall void Sleep( unsigned long );
+#define CREATE_WAITABLE_TIMER_MANUAL_RESET	0x00000001
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION	0x00000002
+
+typedef HANDLE WINAPI (*nsleep_timer_ex)( LPSECURITY_ATTRIBUTES, LPCWSTR,
+    DWORD, DWORD );
+
+/* Each thread keeps its own waitable timer, which is created when it
+ * is first required, and is then reused for every subsequent sleep, to
+ * be closed by a thread-local destructor, when the thread exits; each
+ * thread also keeps its own estimate of that timer's wait overshoot.
+ */
+static __thread struct
+{ HANDLE	 timer;
+  uint32_t	 slack;
+  int		 registered;
+} nsleep_thread;
+
+extern int __cdecl __cxa_thread_atexit_impl (void (*)(void *), void *, void *);
+
+static void nsleep_thread_exit( void *unused __attribute__((__unused__)) )
+{
+  /* Thread exit destructor: close the exiting thread's timer, if it
+   * has one, (and prepare to create another, and to register again,
+   * should a later destructor sleep).
+   */
+  if( (nsleep_thread.timer != NULL)
+  &&  (nsleep_thread.timer != INVALID_HANDLE_VALUE)  )
+    CloseHandle( nsleep_thread.timer );
+  nsleep_thread.timer = NULL;
+  nsleep_thread.registered = 0;
+}
+
+static uint64_t nsleep_now( struct nsleep_clock *clock __attribute__((__unused__)) )
+{
+  /* Method to read CLOCK_MONOTONIC, as a count of nanoseconds.
+   */
+  struct timespec now;
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static HANDLE nsleep_create_timer( void )
+{
+  /* Helper to create a waitable timer, preferring a high resolution
+   * timer, when the host supports it, (i.e. Win10-1803, or later)...
+   */
+  static nsleep_timer_ex create_ex = (nsleep_timer_ex)(-1);
+  if( create_ex == (nsleep_timer_ex)(-1) )
+    create_ex = (nsleep_timer_ex)(GetProcAddress(
+	GetModuleHandleA( "kernel32.dll" ), "CreateWaitableTimerExW"
+      ));
+  if( create_ex != NULL )
+  { HANDLE timer = create_ex( NULL, NULL, CREATE_WAITABLE_TIMER_MANUAL_RESET
+	| CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS
+      );
+    if( timer != NULL )
+      return timer;
+  }
+  /* ...otherwise, falling back to a conventional timer, (which ticks
+   * only at each system clock interrupt).
+   */
+  return CreateWaitableTimerA( NULL, TRUE, NULL );
+}
+
+static void nsleep_wait( struct nsleep_clock *clock __attribute__((__unused__)),
+    uint64_t interval )
+{
+  /* Method to suspend the calling thread, for the specified number of
+   * nanoseconds, (or a little longer), using the thread's own waitable
+   * timer, (creating it, if this is the thread's first timed wait, and
+   * arranging for it to be closed, when the thread exits)...
+   */
+  if( nsleep_thread.timer == NULL )
+  { if( (nsleep_thread.timer = nsleep_create_timer()) == NULL )
+      nsleep_thread.timer = INVALID_HANDLE_VALUE;
+
+    else if( (nsleep_thread.registered == 0)
+    &&  (__cxa_thread_atexit_impl( nsleep_thread_exit, NULL, NULL ) == 0)  )
+      nsleep_thread.registered = 1;
+  }
+  if( nsleep_thread.timer != INVALID_HANDLE_VALUE )
+  { /* ...with a due time specified as a negative count of 100ns units,
+     * to indicate that it is relative to the current time...
+     */
+    LARGE_INTEGER due_time;
+    due_time.QuadPart = -(LONGLONG)(interval / 100ULL);
+    if( SetWaitableTimer( nsleep_thread.timer, &due_time, 0, NULL, NULL, FALSE )
+    &&  (WaitForSingleObject( nsleep_thread.timer, INFINITE ) == WAIT_OBJECT_0)  )
+      return;
+  }
+  /* ...or, if no timer is available, falling back to Sleep(), (with the
+   * interval truncated to whole milliseconds, and broken into cycles of
+   * no more than LONG_MAX milliseconds, lest it be interpreted as "sleep
+   * forever"); the calibration of the expected overshoot will then adapt
+   * to the coarser granularity of this fallback.
+   */
+  interval /= 1000000ULL;
+  while( interval > (unsigned long long)(LONG_MAX) )
+  { Sleep( (unsigned long)(LONG_MAX) );
+    interval -= (unsigned long long)(LONG_MAX);
+  }
+  Sleep( (unsigned long)(interval) );
+}
+
+static void nsleep_spin( struct nsleep_clock *clock __attribute__((__unused__)) )
+{
+  /* Method to perform one iteration of a busy wait; the PAUSE hint,
+   * (encoded as REP NOP, so that it is understood by any assembler,
+   * and executes as a plain NOP on pre-SSE2 processors), relieves the
+   * pressure which the wait loop would otherwise place on a sibling
+   * hyper-thread, and on the memory subsystem.
+   */
+  __asm__ __volatile__( "rep; nop" );
+}
+
+static int nsleep_interval( int relative, uint64_t interval )
+{
+  /* Helper to suspend the calling thread for the specified interval,
+   * in nanoseconds, when "relative" is non-zero, or until the specified
+   * interval has elapsed on CLOCK_MONOTONIC, otherwise; returns zero on
+   * success, or -1 if CLOCK_MONOTONIC is not available.
+   */
+  struct nsleep_clock clock = { nsleep_now, nsleep_wait, nsleep_spin };
+  int errno_saved = errno;
+
+  /* Confirm that CLOCK_MONOTONIC is available, (without corrupting
+   * errno, if it is not)...
+   */
+  if( __clock_api_is_valid( CLOCK_MONOTONIC ) == NULL )
+  { errno = errno_saved;
+    return -1;
+  }
+  /* ...then wait until the deadline has passed, spinning for no more
+   * than NSLEEP_SPIN_MAX nanoseconds, however coarse the timer may be.
+   */
+  if( nsleep_thread.slack == 0 )
+    nsleep_thread.slack = NSLEEP_SLACK_INIT;
+  if( relative )
+    interval += nsleep_now( &clock );
+  nsleep_until( &clock, interval, &nsleep_thread.slack, NSLEEP_SPIN_MAX );
+  return 0;
+}
+
+static void nsleep_legacy( unsigned long secs, unsigned long nsecs )
+{
+  /* Fallback for __mingw_sleep(), used only when CLOCK_MONOTONIC is not
+   * available; we combine the seconds and nanoseconds components into
+   * a millisecond representation, as required by the kernel's Sleep()
+   * API, (using a 64-bit representation, to avoid overflow).
+   */
+  unsigned long long interval = (secs > 0UL)
+    ? secs * 1000ULL + ((nsecs > 0UL) ? nsecs / 1000000ULL : 0ULL)
+    : (nsecs + 999999ULL) / 1000000ULL;
+
+  /* It is unlikely that we should ever need this, (but it is
+   * possible, so we proceed defensively)...
+   */
+  while( interval > (unsigned long long)(LONG_MAX) )
+  {
+    /* ...breaking excessively long intervals into cycles of
+     * LONG_MAX milliseconds, (~25 days, and we may be asked
+     * to sleep through up to 2000 cycles, or ~136 years), so
+     * that we avoid any interval value with the high bit set
+     * (lest that be interpreted as "sleep forever").
+     */
+    Sleep( (unsigned long)(LONG_MAX) );
+    interval -= (unsigned long long)(LONG_MAX);
+  }
+  /* Since suspension requests of 25 days are unlikely, in
+   * the majority of cases we should simply skip over the
+   * preceding loop; we must still call Sleep(), either to
+   * satisfy the original request in its entirety, or the
+   * residual from the loop.
+   */
+  Sleep( (unsigned long)(interval) );
+}
 
 int __mingw_sleep( unsigned long secs, unsigned long nsecs )
 {
@@ -56,36 +234,13 @@ int __mingw_sleep( unsigned long secs, unsigned long nsecs )
     {
       /* POSIX requires the nanoseconds component of the specified
        * interval to be less than one full second (1,000,000,000 ns);
-       * we've satisfied that requirement, so we proceed to combine
-       * the seconds and nanoseconds components into a millisecond
-       * representation, as required by the kernel's Sleep() API,
-       * (using a 64-bit representation, to avoid overflow).
-       */
-      unsigned long long interval = (secs > 0UL)
-	? secs * 1000ULL + ((nsecs > 0UL) ? nsecs / 1000000ULL : 0ULL)
-	: (nsecs + 999999ULL) / 1000000ULL;
-
-      /* It is unlikely that we should ever need this, (but it is
-       * possible, so we proceed defensively)...
+       * we've satisfied that requirement, so we may proceed to wait
+       * for the specified interval, timed by CLOCK_MONOTONIC, with
+       * nanosecond precision, or, if that isn't available, rounded
+       * to milliseconds, as timed by the kernel's Sleep() API.
        */
-      while( interval > (unsigned long long)(LONG_MAX) )
-      {
-	/* ...breaking excessively long intervals into cycles of
-	 * LONG_MAX milliseconds, (~25 days, and we may be asked
-	 * to sleep through up to 2000 cycles, or ~136 years), so
-	 * that we avoid any interval value with the high bit set
-	 * (lest that be interpreted as "sleep forever").
-	 */
-	Sleep( (unsigned long)(LONG_MAX) );
-	interval -= (unsigned long long)(LONG_MAX);
-      }
-      /* Since suspension requests of 25 days are unlikely, in
-       * the majority of cases we should simply skip over the
-       * preceding loop; we must still call Sleep(), either to
-       * satisfy the original request in its entirety, or the
-       * residual from the loop.
-       */
-      Sleep( (unsigned long)(interval) );
+      if( nsleep_interval( 1, secs * 1000000000ULL + nsecs ) != 0 )
+	nsleep_legacy( secs, nsecs );
     }
     else
     { /* We were given a nanoseconds component value, within the
@@ -104,4 +259,78 @@ int __mingw_sleep( unsigned long secs, unsigned long nsecs )
   return 0;
 }
 
+CLOCK_INLINE
+uint64_t nsleep_nanoseconds( const struct timespec *ts )
+{
+  /* Helper to express a (non-negative) timespec value as a count of
+   * nanoseconds, saturating at ~292 years, (which is effectively
+   * eternity).
+   */
+  if( ts->tv_sec >= (__time64_t)(INT64_MAX / 1000000000LL) )
+    return INT64_MAX;
+  return ts->tv_sec * 1000000000ULL + ts->tv_nsec;
+}
+
+int clock_nanosleep( clockid_t clock_id, int flags,
+    const struct timespec *request, struct timespec *residual )
+{
+  /* POSIX.1-2001 API function, to suspend the calling thread for the
+   * interval specified by "request", as measured by the clock specified
+   * by "clock_id", or, when "flags" includes TIMER_ABSTIME, until that
+   * clock indicates the time specified by "request"; unlike most POSIX
+   * functions, this returns an error number, rather than setting errno.
+   */
+  struct timespec now; uint64_t interval;
+  int errno_saved = errno;
+
+  if( (request == NULL) || (request->tv_nsec < 0L)
+  ||  (request->tv_nsec >= 1000000000L)  )
+    return EINVAL;
+
+  /* We support only CLOCK_REALTIME and CLOCK_MONOTONIC; (POSIX would
+   * prefer ENOTSUP, for any other valid clock, but we have no such
+   * error number, so we report EINVAL for all others).
+   */
+  if( ((clock_id != CLOCK_REALTIME) && (clock_id != CLOCK_MONOTONIC))
+  ||  (clock_gettime( clock_id, &now ) != 0)  )
+  { errno = errno_saved;
+    return EINVAL;
+  }
+  if( (flags & TIMER_ABSTIME) == 0 )
+  {
+    /* For a relative interval, the time remaining is always zero, on
+     * completion, (since we cannot be interrupted by signals); POSIX
+     * considers negative intervals to be invalid.
+     */
+    if( request->tv_sec < 0LL )
+      return EINVAL;
+    if( residual != NULL )
+      residual->tv_sec = (__time64_t)(residual->tv_nsec = 0);
+    interval = nsleep_nanoseconds( request );
+  }
+  else
+  { /* For an absolute time, we do nothing, if it has already passed...
+     */
+    if( (request->tv_sec < now.tv_sec) || ((request->tv_sec == now.tv_sec)
+    &&  (request->tv_nsec <= now.tv_nsec))  )
+      return 0;
+
+    /* ...but otherwise, for CLOCK_MONOTONIC, we may simply wait until
+     * the requested time, since our timing is itself referred to that
+     * clock...
+     */
+    if( clock_id == CLOCK_MONOTONIC )
+      return nsleep_interval( 0, nsleep_nanoseconds( request ) ) ? EINVAL : 0;
+
+    /* ...whereas, for CLOCK_REALTIME, we convert to the equivalent
+     * interval, relative to the current time, (so we will not track
+     * any adjustment to the system time, while we wait).
+     */
+    interval = nsleep_nanoseconds( request ) - nsleep_nanoseconds( &now );
+  }
+  if( nsleep_interval( 1, interval ) != 0 )
+    return EINVAL;
+  return 0;
+}
+
 /* $RCSfile$: end of file */
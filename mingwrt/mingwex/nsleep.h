@@ -0,0 +1,114 @@
+/*
+ * nsleep.h
+ *
+ * Private header, providing the decision logic for the hybrid timer and
+ * spin scheduler, on which the __mingw_sleep() and clock_nanosleep() APIs
+ * depend; the clock, and the timer, are accessed only through the methods
+ * of a struct nsleep_clock, (and this header depends on no more than the
+ * <stdint.h> header), so that the logic may be checked, on any host, by
+ * substitution of a simulated clock.
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdint.h>
+
+#define NSLEEP_INLINE  static __inline__ __attribute__((__always_inline__))
+
+/* The amount by which a timer wait is expected to overshoot its nominal
+ * interval, (which we call "slack"), is calibrated at run time; it starts
+ * at NSLEEP_SLACK_INIT nanoseconds, and is then constrained to remain in
+ * the range from NSLEEP_SLACK_MIN to NSLEEP_SLACK_MAX nanoseconds.
+ */
+#define NSLEEP_SLACK_MIN	50000UL
+#define NSLEEP_SLACK_INIT	2000000UL
+#define NSLEEP_SLACK_MAX	20000000UL
+
+/* However large the slack estimate may become, (as it will when only a
+ * conventional timer, ticking at each system clock interrupt, is at our
+ * disposal), we prefer to accept a late wake up, rather than busy wait
+ * for more than NSLEEP_SPIN_MAX nanoseconds, in any one sleep.
+ */
+#define NSLEEP_SPIN_MAX 	2000000UL
+
+struct nsleep_clock
+{ /* Methods to read the current time, in nanoseconds, on a monotonic
+   * time scale, to suspend the calling thread for a specified number
+   * of nanoseconds, (possibly with some overshoot), and to execute a
+   * single iteration of a busy wait loop.
+   */
+  uint64_t	(*now)( struct nsleep_clock * );
+  void  	(*wait)( struct nsleep_clock *, uint64_t );
+  void  	(*spin)( struct nsleep_clock * );
+};
+
+NSLEEP_INLINE
+uint32_t nsleep_calibrate( uint32_t slack, uint64_t overshoot )
+{ /* Helper to update the slack estimate, after a timer wait has been
+   * observed to overshoot by the specified number of nanoseconds; any
+   * increase is adopted immediately, so that we seldom wake late, but
+   * we decay only gradually towards any lesser overshoot.
+   */
+  if( overshoot > slack )
+    slack = (overshoot > NSLEEP_SLACK_MAX) ? NSLEEP_SLACK_MAX : overshoot;
+  else
+    slack -= (slack - overshoot) >> 4;
+  return (slack < NSLEEP_SLACK_MIN) ? NSLEEP_SLACK_MIN : slack;
+}
+
+NSLEEP_INLINE
+void nsleep_until( struct nsleep_clock *clock, uint64_t deadline,
+    uint32_t *slack, uint32_t spin_max )
+{ /* Suspend the calling thread until the specified deadline, on the
+   * time scale of the specified clock; while more than the expected
+   * slack, (but capped at "spin_max"), remains, we wait on the timer,
+   * for all but that slack, and we then busy wait through whatever
+   * remains.
+   */
+  uint64_t now;
+  while( (now = clock->now( clock )) < deadline )
+  {
+    uint64_t remaining = deadline - now;
+    uint32_t spin = (*slack > spin_max) ? spin_max : *slack;
+    if( remaining > spin )
+    {
+      /* Wait on the timer, then measure how far it overshot, so that
+       * we may refine the slack estimate for subsequent waits.
+       */
+      uint64_t interval = remaining - spin, elapsed;
+      clock->wait( clock, interval );
+      elapsed = clock->now( clock ) - now;
+      *slack = nsleep_calibrate( *slack,
+	  (elapsed > interval) ? elapsed - interval : 0
+	);
+    }
+    else
+      clock->spin( clock );
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,88 @@
+/*
+ * pathscan.h
+ *
+ * Private header, used by basename() and dirname(), to decide whether a
+ * path name may be scanned for directory separators one byte at a time,
+ * rather than by transformation to, and back from, the wide character
+ * domain; (apart from its Win32 specific code page check, it depends on
+ * nothing but standard C, so that it may be checked on any host).
+ *
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifdef _WIN32
+#include <winnls.h>
+
+unsigned int __mb_cur_max_for_codeset( unsigned int );
+#endif
+
+#define PATHSCAN_INLINE  static __inline__ __attribute__((__always_inline__))
+
+PATHSCAN_INLINE
+int pathscan_codeset_is_bytewise( void )
+{ /* Check whether the ANSI code page, in which the file system presents
+   * path names, is either a single byte code page, or UTF-8; in neither
+   * of these may any byte with the value of '/', or of '\\', ever form
+   * part of any character other than the directory separator itself.
+   * It is only in DBCS code pages, where such a byte may occur as the
+   * trailing byte of a double byte character, that we must perform the
+   * wide character transformation.  Since the ANSI code page is fixed
+   * for the life of the process, we check it once only.
+   */
+#ifdef _WIN32
+  static int bytewise = -1;
+  if( bytewise < 0 )
+  { unsigned int codeset = GetACP();
+    bytewise = (codeset == CP_UTF8) || (__mb_cur_max_for_codeset( codeset ) == 1);
+  }
+  return bytewise;
+#else
+  /* On any other host, path names are assumed to be UTF-8 encoded.
+   */
+  return 1;
+#endif
+}
+
+PATHSCAN_INLINE
+int pathscan_is_bytewise( const char *path )
+{ /* Check whether "path" may be scanned bytewise; this is always so for
+   * a NULL pointer, or for a path name comprising only ASCII characters,
+   * (since, in the absence of any byte with its high bit set, there can
+   * be no DBCS lead byte, and thus no trailing byte), and for any path
+   * name at all, when the code page check above is satisfied.
+   */
+  if( path != NULL ) while( *path != '\0' )
+    if( (*(const unsigned char *)(path++) & 0x80) != 0 )
+      return pathscan_codeset_is_bytewise();
+  return 1;
+}
+
+PATHSCAN_INLINE
+int pathscan_is_separator( char c ){ return (c == '/') || (c == '\\'); }
+
+/* $RCSfile$: end of file */
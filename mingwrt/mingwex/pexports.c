@@ -0,0 +1,289 @@
+/*
+ * pexports.c
+ *
+ * Implementation of a hash-indexed look-up facility for the export
+ * directory of a PE image; dlsym() uses this to resolve names in each
+ * module, after a single pass over its export name pointer table, in
+ * place of repeated calls to GetProcAddress().
+ *
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * This module deliberately avoids any dependency on the Windows API,
+ * and on the host's byte order, or alignment constraints; all fields
+ * are read as little-endian byte sequences, and every access is bounds
+ * checked, so that it may also be used, (and tested), to examine PE
+ * files which have been read into memory as plain data, on any host.
+ *
+ */
+#include "pexports.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Helpers to read little-endian fields, at arbitrary alignment.
+ */
+static __inline__ uint16_t pe_u16( const unsigned char *p )
+{ return p[0] | (p[1] << 8); }
+
+static __inline__ uint32_t pe_u32( const unsigned char *p )
+{ return pe_u16( p ) | ((uint32_t)(pe_u16( p + 2 )) << 16); }
+
+/* Offsets of the PE header fields which we need to interpret.
+ */
+#define PE_DOS_LFANEW		0x3C	/* offset of "PE\0\0" signature */
+#define PE_COFF_NSECTIONS	6	/* from the signature */
+#define PE_COFF_OPTSIZE 	20
+#define PE_OPT_HEADER		24
+#define PE_OPT_SIZEOFIMAGE	56	/* from the optional header */
+#define PE_OPT_NDIRS_PE32	92
+#define PE_OPT_NDIRS_PE32PLUS	108
+#define PE_SECTION_SIZE 	40
+#define PE_SECTION_VSIZE	8	/* from each section header */
+#define PE_SECTION_RVA		12
+#define PE_SECTION_RAWSIZE	16
+#define PE_SECTION_RAWPTR	20
+#define PE_EXPORT_DIR_SIZE	40
+#define PE_EXPORT_NFUNCTIONS	20	/* from the export directory */
+#define PE_EXPORT_NNAMES	24
+#define PE_EXPORT_FUNCTIONS	28
+#define PE_EXPORT_NAMES 	32
+#define PE_EXPORT_ORDINALS	36
+
+uint32_t __mingw_pe_hash( const char *name )
+{
+  /* The FNV-1a hash, of a NUL terminated name.
+   */
+  uint32_t hash = 2166136261U;
+  while( *name ) hash = (hash ^ (unsigned char)(*name++)) * 16777619U;
+  return hash;
+}
+
+static const unsigned char *pe_at( const pe_export_index *x, size_t offset,
+    size_t len )
+{
+  /* Return a pointer to LEN bytes at OFFSET within the image, or NULL
+   * if they do not lie entirely within it.
+   */
+  return ((offset <= x->size) && (len <= x->size - offset))
+    ? x->image + offset : NULL;
+}
+
+const void *__mingw_pe_rva( const pe_export_index *x, uint32_t rva,
+    uint32_t len )
+{
+  /* Map LEN bytes at RVA to a pointer within the image; for a mapped
+   * image, this is a simple offset, but for raw data, we must find the
+   * section which contains RVA, and map it to a file offset.
+   */
+  const unsigned char *section = x->sections;
+  unsigned int count;
+
+  if( section == NULL )
+    return pe_at( x, rva, len );
+
+  for( count = x->nsections; count > 0; --count )
+  { uint32_t base = pe_u32( section + PE_SECTION_RVA );
+    uint32_t size = pe_u32( section + PE_SECTION_RAWSIZE );
+    if( (rva >= base) && (rva - base < size) )
+      return (len <= size - (rva - base))
+	? pe_at( x, pe_u32( section + PE_SECTION_RAWPTR ) + (rva - base), len )
+	: NULL;
+    section += PE_SECTION_SIZE;
+  }
+  return NULL;
+}
+
+static const char *pe_name( const pe_export_index *x, uint32_t n,
+    size_t *len )
+{
+  /* Retrieve the Nth exported name, storing its length in LEN, and
+   * confirming that it is NUL terminated within the image.
+   */
+  const unsigned char *ref = x->names + 4 * n;
+  const char *name = __mingw_pe_rva( x, pe_u32( ref ), 1 );
+  if( name != NULL )
+  { /* The name is terminated within the image, if it lies within the
+     * data which remains after its mapped start.
+     */
+    const char *end = (const char *)(x->image + x->size);
+    const char *nul = memchr( name, '\0', end - name );
+    if( nul != NULL ) *len = nul - name;
+    else name = NULL;
+  }
+  return name;
+}
+
+int __mingw_pe_export_index( pe_export_index *x, const void *image,
+    size_t size, int mapped )
+{
+  /* Populate the export index X, for the PE image, which is either as
+   * MAPPED by the Windows loader, (when SIZE may be given as zero, to
+   * use the SizeOfImage recorded in its optional header), or read as
+   * SIZE bytes of raw data.  Returns zero on success, or -1 if the image
+   * is malformed, or memory is exhausted; on failure, X->slots is NULL.
+   */
+  const unsigned char *pe, *opt, *dir;
+  uint32_t count, ndirs, n;
+
+  memset( x, 0, sizeof( *x ) );
+  x->image = image;
+  x->size = (size == 0) ? 0x1000 : size;
+
+  /* Locate, and validate, the PE signature and the optional header...
+   */
+  if( ((pe = pe_at( x, 0, PE_DOS_LFANEW + 4 )) == NULL)
+  ||  (pe[0] != 'M') || (pe[1] != 'Z')
+  ||  ((pe = pe_at( x, pe_u32( pe + PE_DOS_LFANEW ), PE_OPT_HEADER )) == NULL)
+  ||  (memcmp( pe, "PE\0\0", 4 ) != 0)
+  ||  ((opt = pe_at( x, pe - x->image + PE_OPT_HEADER,
+	    pe_u16( pe + PE_COFF_OPTSIZE ) )) == NULL)
+  ||  (pe_u16( pe + PE_COFF_OPTSIZE ) < PE_OPT_NDIRS_PE32 + 12)  )
+    return -1;
+
+  /* ...noting that the data directories follow a 32-bit or 64-bit
+   * image base, and associated fields, as identified by its magic.
+   */
+  switch( pe_u16( opt ) )
+  { case 0x10B: ndirs = PE_OPT_NDIRS_PE32; break;
+    case 0x20B: ndirs = PE_OPT_NDIRS_PE32PLUS; break;
+    default: return -1;
+  }
+  if( (pe_u32( opt + ndirs ) == 0)
+  ||  (pe_u16( pe + PE_COFF_OPTSIZE ) < ndirs + 12)  )
+    return -1;
+
+  if( mapped )
+  { /* RVAs are offsets from the image base; we may now determine the
+     * actual image size, if the caller didn't know it.
+     */
+    if( size == 0 ) x->size = pe_u32( opt + PE_OPT_SIZEOFIMAGE );
+  }
+  else
+  { /* RVAs must be mapped to file offsets, via the section table.
+     */
+    x->nsections = pe_u16( pe + PE_COFF_NSECTIONS );
+    if( (x->sections = pe_at( x, opt - x->image + pe_u16( pe + PE_COFF_OPTSIZE ),
+	    x->nsections * PE_SECTION_SIZE )) == NULL  )
+      return -1;
+  }
+
+  /* The export directory is the first data directory entry; locate it,
+   * and from it, the three tables which it describes.
+   */
+  x->dir_rva = pe_u32( opt + ndirs + 4 );
+  x->dir_size = pe_u32( opt + ndirs + 8 );
+  if( (x->dir_rva == 0) || (x->dir_size < PE_EXPORT_DIR_SIZE) )
+  { /* This is a valid image, which simply has no exports.
+     */
+    x->mask = 0;
+    return ((x->slots = calloc( 1, sizeof( pe_export_slot ) )) == NULL) ? -1 : 0;
+  }
+  if( (dir = __mingw_pe_rva( x, x->dir_rva, PE_EXPORT_DIR_SIZE )) == NULL )
+    return -1;
+
+  x->nfunctions = pe_u32( dir + PE_EXPORT_NFUNCTIONS );
+  x->nnames = pe_u32( dir + PE_EXPORT_NNAMES );
+  if( (x->nfunctions > 0x10000) || (x->nnames > x->nfunctions)
+  ||  ((x->functions = __mingw_pe_rva( x, pe_u32( dir + PE_EXPORT_FUNCTIONS ),
+	    4 * x->nfunctions )) == NULL)
+  ||  ((x->names = __mingw_pe_rva( x, pe_u32( dir + PE_EXPORT_NAMES ),
+	    4 * x->nnames )) == NULL)
+  ||  ((x->ordinals = __mingw_pe_rva( x, pe_u32( dir + PE_EXPORT_ORDINALS ),
+	    2 * x->nnames )) == NULL)  )
+    return -1;
+
+  /* Allocate a hash table with at least twice as many slots as there
+   * are names, and populate it.
+   */
+  for( count = 8; count < 2 * x->nnames; count <<= 1 )
+    ;
+  if( (x->slots = calloc( count, sizeof( pe_export_slot ) )) == NULL )
+    return -1;
+  x->mask = count - 1;
+
+  for( n = 0; n < x->nnames; n++ )
+  { size_t len;
+    const char *name = pe_name( x, n, &len );
+    if( name != NULL )
+    { /* Insert at the first free slot, following the slot nominated
+       * by the name's hash; (we never delete, so linear probing will
+       * always find the name again, at or before the first free slot
+       * encountered on look-up).
+       */
+      uint32_t hash = __mingw_pe_hash( name ), i = hash;
+      while( x->slots[i &= x->mask].index != 0 ) ++i;
+      x->slots[i].hash = hash;
+      x->slots[i].index = n + 1;
+    }
+  }
+  return 0;
+}
+
+int __mingw_pe_export_lookup( const pe_export_index *x, const char *name,
+    uint32_t hash, uint32_t *rva )
+{
+  /* Look up NAME, (with pre-computed HASH), in the export index X; on
+   * success, store either the RVA of the exported entity, or of the
+   * forwarder string which represents it, in RVA, and return the
+   * appropriate PE_EXPORT_ADDRESS or PE_EXPORT_FORWARDER status; if the
+   * name is not exported, return PE_EXPORT_NONE.
+   */
+  uint32_t i = hash;
+  size_t len = strlen( name );
+
+  while( x->slots[i &= x->mask].index != 0 )
+  { const pe_export_slot *slot = x->slots + i++;
+    size_t reflen;
+    const char *ref;
+    if( (slot->hash == hash)
+    &&  ((ref = pe_name( x, slot->index - 1, &reflen )) != NULL)
+    &&  (reflen == len) && (memcmp( ref, name, len ) == 0)  )
+    { /* We've found the name; map it, via its ordinal, to the export
+       * address table entry, checking for a forwarder reference.
+       */
+      uint32_t ordinal = pe_u16( x->ordinals + 2 * (slot->index - 1) );
+      if( (ordinal >= x->nfunctions)
+      ||  ((*rva = pe_u32( x->functions + 4 * ordinal )) == 0)  )
+	return PE_EXPORT_NONE;
+      return (*rva - x->dir_rva < x->dir_size)
+	? PE_EXPORT_FORWARDER : PE_EXPORT_ADDRESS;
+    }
+  }
+  return PE_EXPORT_NONE;
+}
+
+void __mingw_pe_export_free( pe_export_index *x )
+{
+  /* Release the hash table associated with export index X.
+   */
+  free( x->slots );
+  x->slots = NULL;
+}
+
+/* $RCSfile$: end of file */
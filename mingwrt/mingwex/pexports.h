@@ -0,0 +1,91 @@
+/*
+ * pexports.h
+ *
+ * Private header file, declaring the MinGW.OSDN PE export directory
+ * indexing API, which is used by dlsym() to resolve symbols without
+ * repeated calls to GetProcAddress().
+ *
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef PEXPORTS_H
+#define PEXPORTS_H  1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Each slot in an export index hash table records the hash of one
+ * exported name, together with the (one-based) position of that name
+ * within the export name pointer table; a zero position marks a slot
+ * which is unused.
+ */
+typedef struct pe_export_slot
+{ uint32_t		 hash;
+  uint32_t		 index;
+} pe_export_slot;
+
+/* The export index itself refers to an image, which may be either as
+ * mapped into memory by the Windows loader, (in which case an RVA is a
+ * simple offset from the image base), or as the raw content of a PE
+ * file, (when each RVA must be mapped to a file offset, by reference
+ * to the section table); note that the index refers directly to data
+ * within the image, which must therefore remain accessible for as long
+ * as the index remains in use.
+ */
+typedef struct pe_export_index
+{ const unsigned char	*image;
+  size_t		 size;
+  const unsigned char	*sections;	/* section table, (raw data only) */
+  unsigned int		 nsections;
+  uint32_t		 dir_rva;	/* extent of the export directory, */
+  uint32_t		 dir_size;	/* (which contains any forwarders) */
+  uint32_t		 nfunctions;
+  uint32_t		 nnames;
+  const unsigned char	*functions;	/* export address table */
+  const unsigned char	*names;		/* export name pointer table */
+  const unsigned char	*ordinals;	/* export ordinal table */
+  uint32_t		 mask;		/* hash table size, less one */
+  pe_export_slot	*slots;		/* hash table, or NULL if unindexed */
+} pe_export_index;
+
+/* Possible outcomes of a look-up, in an export index.
+ */
+enum
+{ PE_EXPORT_NONE = 0,		/* the name is not exported */
+  PE_EXPORT_ADDRESS,		/* RVA of the exported entity */
+  PE_EXPORT_FORWARDER		/* RVA of a forwarder string */
+};
+
+uint32_t __mingw_pe_hash( const char * );
+const void *__mingw_pe_rva( const pe_export_index *, uint32_t, uint32_t );
+int __mingw_pe_export_index( pe_export_index *, const void *, size_t, int );
+int __mingw_pe_export_lookup
+( const pe_export_index *, const char *, uint32_t, uint32_t * );
+void __mingw_pe_export_free( pe_export_index * );
+
+#endif /* !PEXPORTS_H: $RCSfile$: end of file */
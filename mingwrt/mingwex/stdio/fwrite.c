@@ -8,7 +8,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2018, 2022, MinGW.OSDN Project.
+ * Copyright (C) 2018, 2022, 2026, MinGW.OSDN Project.
  *
  *
  * Replaces mingw-fseek.c implementation
@@ -51,6 +51,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+/* The helper which ftruncate64() uses to adjust file size; we use it to
+ * fill any gap which fseek() has created beyond EOF, on Win9x.
+ */
+extern int __mingw_fsetsize( int, __off64_t, int );
+
 /* The fseek() handler control structures.
  */
 static void fseek_handler_init( FILE * );
@@ -228,43 +233,27 @@ size_t __mingw_fwrite( const void *buffer, size_t size, size_t count, FILE *fp )
      * EOF, in the intervening space, (where ISO-C requires the effect
      * of zero bytes); check for this anomaly now.
      */
-    __off64_t eof_pos, fwrite_pos = fseek_handler_reset( trap );
-    if( fwrite_pos > (eof_pos = _lseeki64( fileno( fp ), 0LL, SEEK_END )) )
+    __off64_t fwrite_pos = fseek_handler_reset( trap );
+    if( fwrite_pos > _lseeki64( fileno( fp ), 0LL, SEEK_END ) )
     { /* The original seek request HAD moved the fwrite position to
-       * some point beyond EOF!  We've now moved it back to EOF, so
-       * prepare to fill with zeros, to pad out the file until we
-       * return to the original seek position.
-       */
-      char zero_bytes[BUFSIZ] = {'\0'};
-      __int64 fill_len = fwrite_pos - eof_pos;
-
-      /* Emit the requisite number of padding zeros, in blocks of
-       * no more than BUFSIZ bytes...
+       * some point beyond EOF!  Extend the file, to the original seek
+       * position, using the same helper as ftruncate64(), which will
+       * fill the extension with zeros, in large blocks...
        */
-      while( fill_len > 0LL )
-      { size_t len = (fill_len > BUFSIZ) ? BUFSIZ : fill_len;
-	if( fwrite( zero_bytes, 1, len, fp ) != len )
-	{ /* ...but, if any block falls short of its expected size,
-	   * then an error has occurred; attempt to restore to the
-	   * original seek position, and abort the fwrite request,
-	   * having written NONE of its requested data.
-	   */
-	  __mingw_fseeki64( fp, fwrite_pos, SEEK_SET );
-	  return 0;
-	}
-	/* A padding block has been successfully written; adjust
-	 * the residual padding length, to account for it.
+      if( __mingw_fsetsize( fileno( fp ), fwrite_pos, 1 ) != 0 )
+      { /* ...but, if this fails, then attempt to restore to the
+	 * original seek position, and abort the fwrite request,
+	 * having written NONE of its requested data.
 	 */
-	fill_len -= len;
+	__mingw_fseeki64( fp, fwrite_pos, SEEK_SET );
+	return 0;
       }
     }
-    else
-      /* The preceding seek was not beyond end of file, so there is no
-       * danger of leaving random garbage, but our check has moved the
-       * fwrite position to end of file; move it back to the position
-       * set by the original seek request.
-       */
-      __mingw_fseeki64( fp, fwrite_pos, SEEK_SET );
+    /* In either case, our check has moved the underlying file position
+     * to end of file; move it back to the position set by the original
+     * seek request.
+     */
+    __mingw_fseeki64( fp, fwrite_pos, SEEK_SET );
   }
   /* Ultimately, complete the original fwrite request, at the expected
    * position within the output file.
@@ -8,7 +8,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2012, 2015, 2022, MinGW.OSDN Project
+ * Copyright (C) 2012, 2015, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -32,8 +32,10 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include <errno.h>
+#include <dlfcn.h>
 
 #ifndef EOVERFLOW
 /* This is one of the errno failure states specified by POSIX, for both
@@ -55,6 +57,68 @@ CRT_INLINE ssize_t getline_abort( int error_code )
   return (ssize_t)(-1);
 }
 
+/* When the line buffer must be expanded, we grow it geometrically,
+ * doubling its size on each occasion, but never allocating less than
+ * this minimum size.
+ */
+#define GETLINE_BUFSIZ_MIN  128
+
+CRT_INLINE int getline_reserve( char **linebuf, size_t *len, size_t want )
+{
+  /* A local helper, to ensure that the line buffer can accommodate at
+   * least "want" bytes; returns zero on success, or non-zero if the
+   * buffer needed to be expanded, but could not be.
+   */
+  if( want > *len )
+  { char *newbuf; size_t newlen = (*len < GETLINE_BUFSIZ_MIN)
+      ? GETLINE_BUFSIZ_MIN : *len;
+    while( newlen < want )
+      newlen = ((newlen << 1) > newlen) ? (newlen << 1) : want;
+    if( (newbuf = realloc( *linebuf, newlen )) == NULL )
+      return -1;
+
+    /* Buffer expansion was successful; update reference data.
+     */
+    *linebuf = newbuf;
+    *len = newlen;
+  }
+  return 0;
+}
+
+static void getline_lock( FILE *stream, int unlock )
+{
+  /* A local helper, to acquire, or release, exclusive access to the
+   * stream; this is available only if the running MSVCRT.DLL exports
+   * the (undocumented) _lock_file() and _unlock_file() pair, and when
+   * it doesn't, this becomes a no-op.
+   */
+  typedef void (*lock_fn)( FILE * );
+  static lock_fn lock[2]; static int initialized = 0;
+
+  if( ! initialized )
+  {
+    lock_fn fn[2];
+    fn[0] = (lock_fn)(dlsym( RTLD_DEFAULT, "_lock_file" ));
+    fn[1] = (lock_fn)(dlsym( RTLD_DEFAULT, "_unlock_file" ));
+    if( (fn[0] == NULL) || (fn[1] == NULL) )
+      fn[0] = fn[1] = NULL;
+    lock[0] = fn[0]; lock[1] = fn[1]; initialized = 1;
+  }
+  if( lock[unlock] != NULL )
+    lock[unlock]( stream );
+}
+
+CRT_INLINE int getline_getc_nolock( FILE *stream )
+{
+  /* A local helper, equivalent to Microsoft's _getc_nolock(), (which
+   * MSVCRT.DLL does not provide); the caller is expected to already
+   * hold the stream lock, (if any).
+   */
+  return (--stream->_cnt >= 0)
+    ? (int)(unsigned char)(*stream->_ptr++)
+    : _filbuf( stream );
+}
+
 #define RESTRICT  __restrict__
 
 ssize_t getdelim
@@ -71,7 +135,7 @@ ssize_t getdelim
    *  { return getdelim( linebuf, len, '\n', stream ); }
    *
    */
-  int nextchar = EOF;
+  int nextchar = EOF, error = 0;
   ssize_t count = (ssize_t)(0);
 
   /* Caller MUST pass us valid references to locations where the
@@ -117,56 +181,115 @@ ssize_t getdelim
     *len = 0;
 
   /* Okay to accept input...
-   * read character by character, until "brk" or EOF...
+   * read until "brk" or EOF, holding the stream lock, (if available),
+   * throughout, since we access the stream buffer directly...
    */
-  while( (nextchar != brk) && ((nextchar = fgetc( stream )) != EOF) )
+  getline_lock( stream, 0 );
+  while( nextchar != brk )
   {
-    if( ferror( stream ) )
-      /* We caught an I/O error; bail out, assuming that fgetc() has
-       * already set errno appropriately, and returning nothing.
+    if( (stream->_cnt > 0) && (stream->_flag & _IOREAD) )
+    {
+      /* There is buffered data, which has not yet been consumed; we
+       * may scan it in place, (just as the getc() inline function in
+       * <stdio.h> does), to locate the delimiter...
        */
-      return (ssize_t)(-1);
+      char *ptr = stream->_ptr;
+      char *brkptr = ((unsigned)(brk) <= UCHAR_MAX)
+	? memchr( ptr, brk, stream->_cnt ) : NULL;
+      ssize_t take = (brkptr != NULL) ? brkptr - ptr + 1 : stream->_cnt;
 
-    if( count == SSIZE_MAX )
-      /* We've read another character, but we've already accumulated
-       * as many as we can account for in the return value; POSIX says
-       * that we MAY fail, in this case.
-       */
-      return getline_abort( EOVERFLOW );
+      if( take > (SSIZE_MAX - count) )
+      {	/* We've found more characters, but we cannot accumulate them
+	 * all, and still account for them in the return value; POSIX
+	 * says that we MAY fail, in this case.
+	 */
+	error = EOVERFLOW;
+	break;
+      }
 
-    /* We will store the resultant string into the buffer located
-     * at the address pointed to by *linebuf; this MUST be a dynamically
-     * allocated buffer of size as specified by *len, so we may increase
-     * its size if necessary, (allowing space to accommodate the current
-     * input character, and a terminating NUL).
-     */
-    if( (count + 2) > *len )
-    { char *newbuf = realloc( *linebuf, *len + 64 );
-      if( newbuf == NULL )
-	/* Failed to expand the buffer; report insufficient memory.
+      /* We will store the resultant string into the buffer located
+       * at the address pointed to by *linebuf; this MUST be a dynamically
+       * allocated buffer of size as specified by *len, so we may increase
+       * its size if necessary, (allowing space to accommodate all of the
+       * characters to be taken, and a terminating NUL).
+       */
+      if( getline_reserve( linebuf, len, count + take + 1 ) != 0 )
+      {	/* Failed to expand the buffer; report insufficient memory.
 	 */
-	return getline_abort( ENOMEM );
+	error = ENOMEM;
+	break;
+      }
 
-      /* Buffer expansion was successful; update reference data.
+      /* Append all characters, up to and including any delimiter, to
+       * the buffer, as a single block, and consume them from the stream.
        */
-      *linebuf = newbuf;
-      *len += 64;
+      memcpy( *linebuf + count, ptr, take );
+      stream->_ptr += take; stream->_cnt -= take;
+      count += take;
+
+      if( brkptr != NULL )
+	/* Stop scanning when we've seen the delimiter.
+	 */
+	break;
     }
+    else if( (nextchar = getline_getc_nolock( stream )) == EOF )
+      /*
+       * Stop scanning when there is no more input.
+       */
+      break;
 
-    /* We successfully read a character; append it to the buffer.
-     */
-    (*linebuf)[count++] = nextchar;
+    else
+    {
+      /* The stream buffer was empty, (or the stream is unbuffered);
+       * _filbuf() has refilled it, as may be appropriate, and has also
+       * returned the first character which it now provides...
+       */
+      if( ferror( stream ) )
+      {	/* ...or, we caught an I/O error; bail out, assuming that
+	 * _filbuf() has already set errno appropriately, and returning
+	 * nothing.
+	 */
+	error = -1;
+	break;
+      }
+
+      if( count == SSIZE_MAX )
+      {	/* We've read another character, but we've already accumulated
+	 * as many as we can account for in the return value.
+	 */
+	error = EOVERFLOW;
+	break;
+      }
+
+      if( getline_reserve( linebuf, len, count + 2 ) != 0 )
+      { error = ENOMEM;
+	break;
+      }
+
+      /* We successfully read a character; append it to the buffer.
+       */
+      (*linebuf)[count++] = nextchar;
+    }
   }
+  getline_lock( stream, 1 );
 
-  /* Finished the current string capture; ensure that the buffer
-   * is properly terminated, by appending a NUL.
+  /* If we bailed out on an error, we return nothing, (setting errno,
+   * unless the error was reported by _filbuf(), which has set it)...
    */
-  (*linebuf)[count] = '\0';
+  if( error != 0 )
+    return (error > 0) ? getline_abort( error ) : (ssize_t)(-1);
 
-  /* If we've successfully read at least one character, then we
-   * return the count of characters read, else we return nothing.
+  /* ...otherwise, if we've successfully read at least one character,
+   * then we ensure that the buffer is properly terminated, by appending a NUL,
+   * and we return the count of characters read...
+   */
+  if( count > (ssize_t)(0) )
+  { (*linebuf)[count] = '\0';
+    return count;
+  }
+  /* ...otherwise we return nothing.
    */
-  return (count > (ssize_t)(0)) ? count : (ssize_t)(-1);
+  return (ssize_t)(-1);
 }
 
 /* $RCSfile$: end of file */
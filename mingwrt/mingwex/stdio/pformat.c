@@ -8,7 +8,7 @@
  * to support Microsoft's non-standard format specifications.
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2008, 2009, 2011, 2014-2018, 2020, 2022, MinGW.OSDN Project
+ * Copyright (C) 2008, 2009, 2011, 2014-2018, 2020, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -260,6 +260,16 @@ typedef enum
   sizeof( type ) == sizeof( char )      ? PFORMAT_LENGTH_CHAR  : \
   /* should never need this default */    PFORMAT_LENGTH_INT
 
+/* When output is directed to a FILE stream, rather than to a memory
+ * buffer, it is staged in a local buffer of this size, (allocated on
+ * the stack, within `__pformat()'), and is then transferred to the
+ * stream in bulk, by `fwrite()', whenever this buffer becomes full,
+ * and on completion of the `__pformat()' request; this avoids the
+ * overhead of a stream lock, and associated buffer bounds check, for
+ * every individual character emitted.
+ */
+#define PFORMAT_BUFSIZ      512
+
 typedef struct
 { /* Formatting and output control data...
    * An instance of this control block is created, (on the stack),
@@ -278,9 +288,107 @@ typedef struct
   int            tslen;
   wchar_t        tschr;
   char *         grouping;
+  char *         buf;
+  int            buflen;
 } __pformat_t;
 
 static
+void __pformat_flush( __pformat_t *stream )
+{
+  /* Transfer any output which has been staged in the local buffer,
+   * to the FILE stream which is its ultimate destination.
+   */
+  if( stream->buflen > 0 )
+    fwrite( stream->buf, 1, stream->buflen, (FILE *)(stream->dest) );
+  stream->buflen = 0;
+}
+
+static __pformat_inline__
+int __pformat_room( int count, __pformat_t *stream )
+{
+  /* Helper to establish how many of `count' characters, offered for
+   * output, may actually be placed into the `__pformat()' output queue,
+   * without exceeding any specified output quota.
+   */
+  if( ((stream->flags & PFORMAT_NOLIMIT) == 0)
+  &&  (count > (stream->quota - stream->count))  )
+    return (stream->quota > stream->count) ? stream->quota - stream->count : 0;
+  return count;
+}
+
+static
+void __pformat_putn( const char *s, int count, __pformat_t *stream )
+{
+  /* Place a run of `count' characters, copied from the buffer at `s',
+   * into the `__pformat()' output queue, truncating it as necessary to
+   * honour any specified output quota; (the output character count is
+   * nonetheless advanced by the full length of the run).
+   */
+  int len;
+  if( (len = __pformat_room( count, stream )) > 0 )
+  {
+    if( stream->flags & PFORMAT_TO_FILE )
+    {
+      /* This is output to a FILE stream; stage it in the local buffer,
+       * flushing that first, if it has insufficient free space...
+       */
+      if( len > (PFORMAT_BUFSIZ - stream->buflen) )
+	__pformat_flush( stream );
+
+      if( len < PFORMAT_BUFSIZ )
+      {	memcpy( stream->buf + stream->buflen, s, len );
+	stream->buflen += len;
+      }
+      else
+	/* ...or, for any run which is too long to be staged at all,
+	 * write it directly to the stream.
+	 */
+	fwrite( s, 1, len, (FILE *)(stream->dest) );
+    }
+    else
+      /* Whereas, this is to an internal memory buffer...
+       */
+      memcpy( (char *)(stream->dest) + stream->count, s, len );
+  }
+  stream->count += count;
+}
+
+static
+void __pformat_fill( int c, int count, __pformat_t *stream )
+{
+  /* Place a run of `count' copies of the character `c', (typically
+   * padding spaces or zeros), into the `__pformat()' output queue,
+   * again subject to truncation at any specified output quota.
+   */
+  int len;
+  if( (count > 0) && ((len = __pformat_room( count, stream )) > 0) )
+  {
+    if( stream->flags & PFORMAT_TO_FILE )
+    {
+      /* For FILE stream output, we must pass the run through the
+       * local staging buffer, in as many segments as required...
+       */
+      while( len > 0 )
+      { int seg;
+	if( stream->buflen == PFORMAT_BUFSIZ )
+	  __pformat_flush( stream );
+	if( (seg = PFORMAT_BUFSIZ - stream->buflen) > len )
+	  seg = len;
+	memset( stream->buf + stream->buflen, c, seg );
+	stream->buflen += seg; len -= seg;
+      }
+    }
+    else
+      /* ...whereas, for memory buffer output, we may simply fill
+       * the appropriate region of the destination buffer.
+       */
+      memset( (char *)(stream->dest) + stream->count, c, len );
+  }
+  if( count > 0 )
+    stream->count += count;
+}
+
+static __pformat_inline__
 void __pformat_putc( int c, __pformat_t *stream )
 {
   /* Place a single character into the `__pformat()' output queue,
@@ -292,11 +400,14 @@ void __pformat_putc( int c, __pformat_t *stream )
      * or the active quota has not yet been reached.
      */
     if( stream->flags & PFORMAT_TO_FILE )
-      /*
-       * This is single character output to a FILE stream...
+    {
+      /* This is single character output to a FILE stream; it is
+       * staged in the local buffer, flushing that when it fills...
        */
-      fputc( c, (FILE *)(stream->dest) );
-
+      if( stream->buflen == PFORMAT_BUFSIZ )
+	__pformat_flush( stream );
+      stream->buf[stream->buflen++] = c;
+    }
     else
       /* Whereas, this is to an internal memory buffer...
        */
@@ -305,18 +416,51 @@ void __pformat_putc( int c, __pformat_t *stream )
   ++stream->count;
 }
 
+static __pformat_inline__
+void __pformat_pad( int c, __pformat_t *stream )
+{
+  /* Emit copies of `c', as a single run, to consume any residual
+   * field width; on return, `width' is left exactly as it would have
+   * been after an equivalent `while( width-- > 0 )' emission loop, so
+   * that any subsequent field width adjustment remains valid.
+   */
+  if( stream->width > 0 )
+  {
+    __pformat_fill( c, stream->width, stream );
+    stream->width = 0;
+  }
+  --stream->width;
+}
+
+static
+void __pformat_emit_digits( char **value, int count, __pformat_t *stream )
+{
+  /* Helper to emit `count' digits from the ASCII digit string at
+   * `*value', as a single run, advancing `*value' past those emitted;
+   * if the string is exhausted before `count' digits have been taken
+   * from it, the balance is filled with (insignificant) zeros.
+   */
+  if( count > 0 )
+  {
+    char *end = memchr( *value, '\0', count );
+    int len = (end == NULL) ? count : end - *value;
+    __pformat_putn( *value, len, stream ); *value += len;
+    __pformat_fill( '0', count - len, stream );
+  }
+}
+
 static
 void __pformat_putchars( const char *s, int count, __pformat_t *stream )
 {
   /* Handler for `%c' and (indirectly) `%s' conversion specifications.
    *
-   * Transfer characters from the string buffer at `s', character by
-   * character, up to the number of characters specified by `count', or
-   * if `precision' has been explicitly set to a value less than `count',
+   * Transfer characters from the string buffer at `s', as a single
+   * run, up to the number of characters specified by `count', or if
+   * `precision' has been explicitly set to a value less than `count',
    * stopping after the number of characters specified for `precision',
    * to the `__pformat()' output stream.
    *
-   * Characters to be emitted are passed through `__pformat_putc()', to
+   * Characters to be emitted are passed through `__pformat_putn()', to
    * ensure that any specified output quota is honoured.
    */
   if( (stream->precision >= 0) && (count > stream->precision) )
@@ -341,28 +485,25 @@ void __pformat_putchars( const char *s, int count, __pformat_t *stream )
     stream->width = PFORMAT_IGNORE;
 
   if( (stream->width > 0) && ((stream->flags & PFORMAT_LJUSTIFY) == 0) )
-    /*
-     * When not doing flush left justification, (i.e. the `-' flag
+  {
+    /* When not doing flush left justification, (i.e. the `-' flag
      * is not set), any residual unreserved field width must appear
      * as blank padding, to the left of the output string.
      */
-    while( stream->width-- )
-      __pformat_putc( '\x20', stream );
+    __pformat_fill( '\x20', stream->width, stream );
+    stream->width = PFORMAT_IGNORE;
+  }
 
-  /* Emit the data...
+  /* Emit the data, copying the requisite number of characters
+   * from the input...
    */
-  while( count-- )
-    /*
-     * copying the requisite number of characters from the input.
-     */
-    __pformat_putc( *s++, stream );
+  __pformat_putn( s, count, stream );
 
   /* If we still haven't consumed the entire specified field width,
    * we must be doing flush left justification; any residual width
    * must be filled with blanks, to the right of the output value.
    */
-  while( stream->width-- > 0 )
-    __pformat_putc( '\x20', stream );
+  __pformat_fill( '\x20', stream->width, stream );
 }
 
 static __pformat_inline__
@@ -390,11 +531,13 @@ void __pformat_wputchars( const wchar_t *s, int count, __pformat_t *stream )
   /* Handler for `%C'(`%lc') and `%S'(`%ls') conversion specifications;
    * (this is a wide character variant of `__pformat_putchars()').
    *
-   * Each multibyte character sequence to be emitted is passed, byte
-   * by byte, through `__pformat_putc()', to ensure that any specified
-   * output quota is honoured.
+   * Multibyte character sequences to be emitted are accumulated in
+   * a local buffer, which is passed through `__pformat_putn()' each
+   * time it approaches capacity, to ensure that any specified output
+   * quota is honoured.
    */
-  char buf[16]; mbstate_t state; int len = wcrtomb( buf, L'\0', &state );
+  char buf[PFORMAT_BUFSIZ]; int buflen = 0;
+  mbstate_t state; int len = wcrtomb( buf, L'\0', &state );
 
   if( (stream->precision >= 0) && (count > stream->precision) )
     /*
@@ -418,30 +561,40 @@ void __pformat_wputchars( const wchar_t *s, int count, __pformat_t *stream )
     stream->width = PFORMAT_IGNORE;
 
   if( (stream->width > 0) && ((stream->flags & PFORMAT_LJUSTIFY) == 0) )
-    /*
-     * When not doing flush left justification, (i.e. the `-' flag
+  {
+    /* When not doing flush left justification, (i.e. the `-' flag
      * is not set), any residual unreserved field width must appear
      * as blank padding, to the left of the output string.
      */
-    while( stream->width-- )
-      __pformat_putc( '\x20', stream );
+    __pformat_fill( '\x20', stream->width, stream );
+    stream->width = PFORMAT_IGNORE;
+  }
 
   /* Emit the data, converting each character from the wide
    * to the multibyte domain as we go...
    */
-  while( (count-- > 0) && ((len = wcrtomb( buf, *s++, &state )) > 0) )
+  while( count-- > 0 )
   {
-    char *p = buf;
-    while( len-- > 0 )
-      __pformat_putc( *p++, stream );
+    /* ...ensuring that the local buffer can always accommodate
+     * the longest possible multibyte character sequence...
+     */
+    if( buflen > (PFORMAT_BUFSIZ - MB_LEN_MAX) )
+    { __pformat_putn( buf, buflen, stream );
+      buflen = 0;
+    }
+    if( (len = wcrtomb( buf + buflen, *s++, &state )) <= 0 )
+      break;
+    buflen += len;
   }
+  /* ...and flush out whatever remains, after the last conversion.
+   */
+  __pformat_putn( buf, buflen, stream );
 
   /* If we still haven't consumed the entire specified field width,
    * we must be doing flush left justification; any residual width
    * must be filled with blanks, to the right of the output value.
    */
-  while( stream->width-- > 0 )
-    __pformat_putc( '\x20', stream );
+  __pformat_fill( '\x20', stream->width, stream );
 }
 
 static __pformat_inline__
@@ -581,9 +734,7 @@ int __pformat_emit_punct( wchar_t code, int len, __pformat_t *stream )
     {
       /* ...and copy to the output destination, when valid.
        */
-      char *p = buf;
-      while( len-- > 0 )
-	__pformat_putc( *p++, stream );
+      __pformat_putn( buf, len, stream );
 
       /* The requested output has been completed; inform the caller
        * that no further fall back output is required.
@@ -674,6 +825,43 @@ void __pformat_emit_digit( int c, __pformat_t *stream )
   }
 }
 
+/* Two digit decimal representations of all values in the range 0..99,
+ * used by `__pformat_utoa()' to convert integers two digits at a time.
+ */
+static const char __pformat_digit_pairs[200] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+/* The maximum number of decimal digits required to represent any
+ * `unsigned long long' value.
+ */
+#define PFORMAT_ULLONG_DIG  20
+
+static __pformat_inline__
+char *__pformat_utoa( unsigned long value, char *p )
+{
+  /* Helper to store the decimal digits of a (32-bit) unsigned value,
+   * working backwards from `p', which is assumed to point just beyond
+   * the end of a buffer of sufficient size; returns a pointer to the
+   * most significant digit stored, (or `p' itself, for a value of zero,
+   * for which no digits are stored).
+   */
+  while( value >= 100 )
+  { const char *pair = __pformat_digit_pairs + ((value % 100) << 1);
+    value /= 100; *--p = pair[1]; *--p = pair[0];
+  }
+  if( value >= 10 )
+  { const char *pair = __pformat_digit_pairs + (value << 1);
+    *--p = pair[1]; *--p = pair[0];
+  }
+  else if( value > 0 )
+    *--p = '0' + value;
+  return p;
+}
+
 static
 void __pformat_int( __pformat_intarg_t value, __pformat_t *stream )
 {
@@ -683,20 +871,16 @@ void __pformat_int( __pformat_intarg_t value, __pformat_t *stream )
    * formatted as a decimal number, to the `__pformat()' output queue;
    * output will be truncated, if any specified quota is exceeded.
    */
-  char buf[__pformat_int_bufsiz(1, PFORMAT_OSHIFT, stream)];
-  char *p = buf, *grouping = NULL; int precision, groupsize = 0;
+  char digits[PFORMAT_ULLONG_DIG], *end = digits + PFORMAT_ULLONG_DIG;
+  char sep[MB_LEN_MAX], *p = end, *grouping = NULL, sign = '\0';
+  int ndigits, nsep = 0, seplen = 0, zeros = 0, count;
 
   /* First check if thousands grouping can be supported, and has been
-   * requested, for the digits of this integer valued field; (note that
-   * supportability has already been verified, as a side effect of the
-   * computation of the necessary transfer buffer size)...
-   */
-  if(  (stream->grouping != NULL)
-  &&  ((stream->flags & PFORMAT_GROUPED) == PFORMAT_GROUPED)
-  /*
-   * ...and initialise the grouping counter controls accordingly.
+   * requested, for the digits of this integer valued field...
    */
-  &&  ((groupsize = *stream->grouping) > 0) && (groupsize != CHAR_MAX)  )
+  if(  __pformat_enable_thousands_grouping( stream )
+  &&  (stream->grouping != NULL) && (*stream->grouping > 0)
+  &&  (*stream->grouping != CHAR_MAX)  )
     grouping = stream->grouping;
 
   if( stream->flags & PFORMAT_NEGATIVE )
@@ -717,55 +901,78 @@ void __pformat_int( __pformat_intarg_t value, __pformat_t *stream )
       stream->flags &= ~PFORMAT_NEGATIVE;
   }
 
-  /* Encode the input value for display...
+  /* Encode the input value for display, decomposing it into its
+   * constituent decimal digits, in order from least significant to
+   * most significant, working backwards from the end of the digits
+   * buffer; while the value does not fit into 32-bits, we peel off
+   * nine digits at a time, so that all remaining digit extraction
+   * may be performed using only 32-bit arithmetic.
    */
-  while( value.__pformat_ullong_t )
+  while( value.__pformat_ullong_t > ULONG_MAX )
+  {
+    unsigned long long q = value.__pformat_ullong_t / 1000000000ULL;
+    char *group = p - 9;
+    p = __pformat_utoa( value.__pformat_ullong_t - q * 1000000000ULL, p );
+    while( p > group )
+      *--p = '0';
+    value.__pformat_ullong_t = q;
+  }
+  p = __pformat_utoa( (unsigned long)(value.__pformat_ullong_t), p );
+  ndigits = end - p;
+
+  if( grouping != NULL )
   {
-    /* decomposing it into its constituent decimal digits...
+    /* Thousands grouping is in effect; count the group separators
+     * which must be inserted between the digits, noting that a group
+     * size of CHAR_MAX, (or any which is not positive), places all
+     * remaining digits within a single group.
      */
-    if( (grouping != NULL) && (groupsize-- == 0) )
+    int size = *grouping, left = ndigits;
+    while( left > size )
     {
-      /* noting that, when thousands grouping is in effect, and
-       * we are currently at a group boundary, we must reset the
-       * grouping counter...
-       */
-      groupsize = (grouping[1] != '\0') ? *++grouping : *grouping;
-      if( groupsize-- == CHAR_MAX )
-	grouping = NULL;
-
-      /* and store a group separator mark, using a simple ASCII
-       * comma to represent it internally...
-       */
-      *p++ = ',';
+      ++nsep; left -= size;
+      size = (grouping[1] != '\0') ? *++grouping : *grouping;
+      if( (size <= 0) || (size == CHAR_MAX) )
+	break;
     }
-    /* before recording each digit from the decomposition, in
-     * order from least significant to most significant, using
-     * the local buffer as a LIFO queue in which to store them.
+    grouping = stream->grouping;
+
+    /* Each separator will be emitted as the multibyte representation
+     * of its localised character code, (or not at all, if there is no
+     * such representation), but it occupies only one character space
+     * within the output field.
      */
-    *p++ = '0' + (unsigned char)(value.__pformat_ullong_t % 10LL);
-    value.__pformat_ullong_t /= 10LL;
+    if( (nsep > 0) && (stream->tschr != (wchar_t)(0)) )
+    { mbstate_t state; memset( &state, 0, sizeof( state ) );
+      if( (seplen = wcrtomb( sep, stream->tschr, &state )) < 0 )
+	seplen = 0;
+    }
   }
 
   if(  (stream->precision > 0)
-  &&  ((precision = stream->precision - (p - buf)) > 0)  )
+  &&  ((zeros = stream->precision - (count = ndigits + nsep)) > 0)  )
     /*
-     * We have not yet queued sufficient digits to fill the field width
-     * specified for minimum `precision'; pad with zeros to achieve this.
+     * We have not yet accounted for sufficient digits to fill the field
+     * width specified for minimum `precision'; pad with zeros to achieve
+     * this.
      */
-    while( precision-- > 0 )
-      *p++ = '0';
+    count += zeros;
 
-  if( (p == buf) && (stream->precision != 0) )
-    /*
-     * Input value was zero; make sure we print at least one digit,
-     * unless the precision is also explicitly zero.
-     */
-    *p++ = '0';
+  else
+  { zeros = 0;
+    if( ((count = ndigits + nsep) == 0) && (stream->precision != 0) )
+      /*
+       * Input value was zero; make sure we print at least one digit,
+       * unless the precision is also explicitly zero.
+       */
+      zeros = count = 1;
+  }
 
-  if( (stream->width > 0) && ((stream->width -= p - buf) > 0) )
+  if( (stream->width > 0) && ((stream->width -= count) > 0) )
   {
-    /* We have now queued sufficient characters to display the input value,
-     * at the desired precision, but this will not fill the output field...
+    /* We have now accounted for sufficient characters to display the
+     * input value, at the desired precision, but this will not fill the
+     * output field...
      */
     if( stream->flags & PFORMAT_SIGNED )
       /*
@@ -775,12 +982,14 @@ void __pformat_int( __pformat_intarg_t value, __pformat_t *stream )
 
     if(  (stream->precision < 0)
     &&  ((stream->flags & PFORMAT_JUSTIFY) == PFORMAT_ZEROFILL)  )
-      /*
-       * and the `0' flag is in effect, so we pad the remaining spaces,
+    {
+      /* and the `0' flag is in effect, so we pad the remaining spaces,
        * to the left of the displayed value, with zeros.
        */
-      while( stream->width-- > 0 )
-	*p++ = '0';
+      if( stream->width > 0 )
+	zeros += stream->width;
+      stream->width = PFORMAT_IGNORE;
+    }
 
     else if( (stream->flags & PFORMAT_LJUSTIFY) == 0 )
       /*
@@ -788,43 +997,63 @@ void __pformat_int( __pformat_intarg_t value, __pformat_t *stream )
        * so we pad to the left of the displayed value with spaces, so that
        * the value appears right justified within the output field.
        */
-      while( stream->width-- > 0 )
-	__pformat_putc( '\x20', stream );
+      __pformat_pad( '\x20', stream );
   }
 
   if( stream->flags & PFORMAT_NEGATIVE )
     /*
      * A negative value needs a sign...
      */
-    *p++ = '-';
+    sign = '-';
 
   else if( stream->flags & PFORMAT_POSITIVE )
     /*
      * A positive value may have an optionally displayed sign...
      */
-    *p++ = '+';
+    sign = '+';
 
   else if( stream->flags & PFORMAT_ADDSPACE )
     /*
      * Space was reserved for displaying a sign, but none was emitted...
      */
-    *p++ = '\x20';
+    sign = '\x20';
 
-  while( p > buf )
-    /*
-     * Emit the accumulated constituent digits,
-     * in order from most significant to least significant...
+  { /* Assemble the entire displayed value, working backwards from the
+     * least significant digit, in a local buffer of exactly sufficient
+     * size, so that it may be emitted as a single run...
      */
-    __pformat_emit_digit( *--p, stream );
+    char buf[1 + zeros + ndigits + nsep * seplen], *q = buf + sizeof( buf );
+    if( nsep > 0 )
+    {
+      /* ...with group separators interposed between digit groups,
+       * when thousands grouping is in effect...
+       */
+      int size = *grouping;
+      while( nsep-- > 0 )
+      {
+	q -= size; end -= size; memcpy( q, end, size );
+	q -= seplen; memcpy( q, sep, seplen );
+	size = (grouping[1] != '\0') ? *++grouping : *grouping;
+      }
+    }
+    q -= end - p; memcpy( q, p, end - p );
 
-  while( stream->width-- > 0 )
-    /* The specified output field has not yet been completely filled;
-     * the `-' flag must be in effect, resulting in a displayed value which
-     * appears left justified within the output field; we must pad the field
-     * to the right of the displayed value, by emitting additional spaces,
-     * until we reach the rightmost field boundary.
+    /* ...preceded by any zero padding, and the sign.
      */
-    __pformat_putc( '\x20', stream );
+    q -= zeros; memset( q, '0', zeros );
+    if( sign != '\0' )
+      *--q = sign;
+
+    __pformat_putn( q, buf + sizeof( buf ) - q, stream );
+  }
+
+  /* If the specified output field has not yet been completely filled,
+   * the `-' flag must be in effect, resulting in a displayed value which
+   * appears left justified within the output field; we must pad the field
+   * to the right of the displayed value, by emitting additional spaces,
+   * until we reach the rightmost field boundary.
+   */
+  __pformat_pad( '\x20', stream );
 }
 
 static __pformat_inline__
@@ -947,24 +1176,37 @@ void __pformat_xint( int fmt, __pformat_intarg_t value, __pformat_t *stream )
      * is not set), any residual unreserved field width must appear
      * as blank padding, to the left of the output value.
      */
-    while( width-- > 0 )
-      __pformat_putc( '\x20', stream );
+  {
+    __pformat_fill( '\x20', width, stream );
+    width = PFORMAT_IGNORE;
+  }
 
-  while( p > buf )
-    /*
-     * Move the queued output from the local buffer to the ultimate
-     * destination, in LIFO order.
+  if( p > buf )
+  {
+    /* Move the queued output from the local buffer to the ultimate
+     * destination, in LIFO order; (we reverse it in place, so that
+     * it may then be transferred as a single run).
      */
-    __pformat_putc( *--p, stream );
+    char *q = buf, *r = p;
+    while( q < --r )
+    { char tmp = *q; *q++ = *r; *r = tmp;
+    }
+    __pformat_putn( buf, p - buf, stream );
+  }
 
   /* If we still haven't consumed the entire specified field width,
    * we must be doing flush left justification; any residual width
    * must be filled with blanks, to the right of the output value.
    */
-  while( width-- > 0 )
-    __pformat_putc( '\x20', stream );
+  __pformat_fill( '\x20', width, stream );
 }
 
+/* The fast path within `__pformat_cvt()' generates, at most, this many
+ * significant digits; requests for more are delegated to `__gdtoa()'.
+ */
+#define PFORMAT_CVT_MAXDIG  17
+#define PFORMAT_CVT_BUFSIZ  (PFORMAT_CVT_MAXDIG + 1)
+
 typedef union
 { /* A multifaceted representation of an IEEE extended precision,
    * (80-bit), floating point number, facilitating access to its
@@ -986,12 +1228,253 @@ typedef union
  */
 #include "gdtoa.h"
 
+static const struct
+{ /* Cached powers of ten, 10^k for k = -348, -340, ..., +340, each
+   * represented as a 64-bit normalized significand, with a binary
+   * exponent, such that 10^k is approximately f * 2^e, correctly
+   * rounded to the nearest representable value.
+   */
+  unsigned long long   f;
+  signed short         e;
+  signed short         k;
+} __pformat_pow10[] =
+{
+  { 0xfa8fd5a0081c0288ULL, -1220, -348 },
+  { 0xbaaee17fa23ebf76ULL, -1193, -340 },
+  { 0x8b16fb203055ac76ULL, -1166, -332 },
+  { 0xcf42894a5dce35eaULL, -1140, -324 },
+  { 0x9a6bb0aa55653b2dULL, -1113, -316 },
+  { 0xe61acf033d1a45dfULL, -1087, -308 },
+  { 0xab70fe17c79ac6caULL, -1060, -300 },
+  { 0xff77b1fcbebcdc4fULL, -1034, -292 },
+  { 0xbe5691ef416bd60cULL, -1007, -284 },
+  { 0x8dd01fad907ffc3cULL,  -980, -276 },
+  { 0xd3515c2831559a83ULL,  -954, -268 },
+  { 0x9d71ac8fada6c9b5ULL,  -927, -260 },
+  { 0xea9c227723ee8bcbULL,  -901, -252 },
+  { 0xaecc49914078536dULL,  -874, -244 },
+  { 0x823c12795db6ce57ULL,  -847, -236 },
+  { 0xc21094364dfb5637ULL,  -821, -228 },
+  { 0x9096ea6f3848984fULL,  -794, -220 },
+  { 0xd77485cb25823ac7ULL,  -768, -212 },
+  { 0xa086cfcd97bf97f4ULL,  -741, -204 },
+  { 0xef340a98172aace5ULL,  -715, -196 },
+  { 0xb23867fb2a35b28eULL,  -688, -188 },
+  { 0x84c8d4dfd2c63f3bULL,  -661, -180 },
+  { 0xc5dd44271ad3cdbaULL,  -635, -172 },
+  { 0x936b9fcebb25c996ULL,  -608, -164 },
+  { 0xdbac6c247d62a584ULL,  -582, -156 },
+  { 0xa3ab66580d5fdaf6ULL,  -555, -148 },
+  { 0xf3e2f893dec3f126ULL,  -529, -140 },
+  { 0xb5b5ada8aaff80b8ULL,  -502, -132 },
+  { 0x87625f056c7c4a8bULL,  -475, -124 },
+  { 0xc9bcff6034c13053ULL,  -449, -116 },
+  { 0x964e858c91ba2655ULL,  -422, -108 },
+  { 0xdff9772470297ebdULL,  -396, -100 },
+  { 0xa6dfbd9fb8e5b88fULL,  -369,  -92 },
+  { 0xf8a95fcf88747d94ULL,  -343,  -84 },
+  { 0xb94470938fa89bcfULL,  -316,  -76 },
+  { 0x8a08f0f8bf0f156bULL,  -289,  -68 },
+  { 0xcdb02555653131b6ULL,  -263,  -60 },
+  { 0x993fe2c6d07b7facULL,  -236,  -52 },
+  { 0xe45c10c42a2b3b06ULL,  -210,  -44 },
+  { 0xaa242499697392d3ULL,  -183,  -36 },
+  { 0xfd87b5f28300ca0eULL,  -157,  -28 },
+  { 0xbce5086492111aebULL,  -130,  -20 },
+  { 0x8cbccc096f5088ccULL,  -103,  -12 },
+  { 0xd1b71758e219652cULL,   -77,   -4 },
+  { 0x9c40000000000000ULL,   -50,    4 },
+  { 0xe8d4a51000000000ULL,   -24,   12 },
+  { 0xad78ebc5ac620000ULL,     3,   20 },
+  { 0x813f3978f8940984ULL,    30,   28 },
+  { 0xc097ce7bc90715b3ULL,    56,   36 },
+  { 0x8f7e32ce7bea5c70ULL,    83,   44 },
+  { 0xd5d238a4abe98068ULL,   109,   52 },
+  { 0x9f4f2726179a2245ULL,   136,   60 },
+  { 0xed63a231d4c4fb27ULL,   162,   68 },
+  { 0xb0de65388cc8ada8ULL,   189,   76 },
+  { 0x83c7088e1aab65dbULL,   216,   84 },
+  { 0xc45d1df942711d9aULL,   242,   92 },
+  { 0x924d692ca61be758ULL,   269,  100 },
+  { 0xda01ee641a708deaULL,   295,  108 },
+  { 0xa26da3999aef774aULL,   322,  116 },
+  { 0xf209787bb47d6b85ULL,   348,  124 },
+  { 0xb454e4a179dd1877ULL,   375,  132 },
+  { 0x865b86925b9bc5c2ULL,   402,  140 },
+  { 0xc83553c5c8965d3dULL,   428,  148 },
+  { 0x952ab45cfa97a0b3ULL,   455,  156 },
+  { 0xde469fbd99a05fe3ULL,   481,  164 },
+  { 0xa59bc234db398c25ULL,   508,  172 },
+  { 0xf6c69a72a3989f5cULL,   534,  180 },
+  { 0xb7dcbf5354e9beceULL,   561,  188 },
+  { 0x88fcf317f22241e2ULL,   588,  196 },
+  { 0xcc20ce9bd35c78a5ULL,   614,  204 },
+  { 0x98165af37b2153dfULL,   641,  212 },
+  { 0xe2a0b5dc971f303aULL,   667,  220 },
+  { 0xa8d9d1535ce3b396ULL,   694,  228 },
+  { 0xfb9b7cd9a4a7443cULL,   720,  236 },
+  { 0xbb764c4ca7a44410ULL,   747,  244 },
+  { 0x8bab8eefb6409c1aULL,   774,  252 },
+  { 0xd01fef10a657842cULL,   800,  260 },
+  { 0x9b10a4e5e9913129ULL,   827,  268 },
+  { 0xe7109bfba19c0c9dULL,   853,  276 },
+  { 0xac2820d9623bf429ULL,   880,  284 },
+  { 0x80444b5e7aa7cf85ULL,   907,  292 },
+  { 0xbf21e44003acdd2dULL,   933,  300 },
+  { 0x8e679c2f5e44ff8fULL,   960,  308 },
+  { 0xd433179d9c8cb841ULL,   986,  316 },
+  { 0x9e19db92b4e31ba9ULL,  1013,  324 },
+  { 0xeb96bf6ebadf77d9ULL,  1039,  332 },
+  { 0xaf87023b9bf0ee6bULL,  1066,  340 }
+};
+
+#define PFORMAT_POW10_COUNT  \
+  (int)(sizeof( __pformat_pow10 ) / sizeof( *__pformat_pow10 ))
+
+static __pformat_inline__
+unsigned long long __pformat_mul64( unsigned long long x, unsigned long long y )
+{
+  /* Helper to compute the most significant 64 bits of the 128-bit
+   * product of two 64-bit integers, rounded to nearest; the result
+   * is within one unit of the exact value.
+   */
+  unsigned long long xh = x >> 32, xl = x & 0xFFFFFFFFULL;
+  unsigned long long yh = y >> 32, yl = y & 0xFFFFFFFFULL;
+  unsigned long long hl = xh * yl, lh = xl * yh;
+  unsigned long long mid = ((xl * yl) >> 32) + (hl & 0xFFFFFFFFULL)
+    + (lh & 0xFFFFFFFFULL) + (1ULL << 31);
+  return xh * yh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+}
+
 static
-char *__pformat_cvt( int mode, __pformat_fpreg_t x, int nd, int *dp, int *sign )
+char *__pformat_cvt_fast
+( int mode, unsigned long long f, int e, int nd, int *dp, char *buf )
+{
+  /* Helper for `__pformat_cvt()'; for a normal value f * 2^e, with
+   * f having its most significant bit set, it attempts to generate
+   * the same digit string as `__gdtoa()' would return, in `mode' 2
+   * or 3, but using only 64-bit integer arithmetic, (after the
+   * fashion of Florian Loitsch's "Grisu" algorithm).  This succeeds
+   * whenever the approximation error does not obscure the rounding
+   * of the final digit; otherwise, as is the case for values which
+   * lie at, or very close to, a rounding boundary, it returns NULL,
+   * so that the caller may fall back to `__gdtoa()'.
+   */
+  unsigned long long w, one, rest, unit = 1, ten_kappa;
+  unsigned long divisor; int i, shift, kappa, len = 0;
+
+  /* Select a cached power of ten, such that the scaled value, w,
+   * has between four and thirty-two integral bits...
+   */
+  if( (i = (-110 - e - __pformat_pow10[0].e) / 27) < 0 )
+    i = 0;
+  else if( i >= PFORMAT_POW10_COUNT )
+    i = PFORMAT_POW10_COUNT - 1;
+  while( (shift = -(e + __pformat_pow10[i].e + 64)) > 60 )
+    if( ++i >= PFORMAT_POW10_COUNT )
+      return NULL;
+  while( shift < 32 )
+  { if( --i < 0 )
+      return NULL;
+    shift = -(e + __pformat_pow10[i].e + 64);
+  }
+  w = __pformat_mul64( f, __pformat_pow10[i].f );
+  one = 1ULL << shift;
+
+  /* Identify the most significant decimal digit position, within
+   * the integral part of w; this establishes the position of the
+   * radix point, relative to the digit string...
+   */
+  kappa = 1; divisor = 1;
+  while( (w >> shift) / divisor >= 10 )
+    ++kappa, divisor *= 10;
+  *dp = kappa - __pformat_pow10[i].k;
+
+  /* whence we may deduce the number of significant digits which
+   * we must generate, to satisfy the request.
+   */
+  if( mode == 3 )
+    nd += *dp;
+  if( (nd < 1) || (nd > PFORMAT_CVT_MAXDIG) )
+    return NULL;
+
+  /* Generate digits from the integral part of w...
+   */
+  rest = w;
+  for(;;)
+  { unsigned long digit = (unsigned long)(rest >> shift) / divisor;
+    buf[len++] = '0' + digit;
+    rest -= (unsigned long long)(digit * divisor) << shift;
+    if( (--nd == 0) || (--kappa == 0) )
+      break;
+    divisor /= 10;
+  }
+  if( nd == 0 )
+    ten_kappa = (unsigned long long)(divisor) << shift;
+
+  else
+  { /* and, when necessary, also from its fractional part, keeping
+     * track of the scaled magnitude of the approximation error.
+     */
+    while( (nd > 0) && (rest > unit) )
+    {
+      rest *= 10; unit *= 10;
+      buf[len++] = '0' + (int)(rest >> shift);
+      rest &= one - 1;
+      --nd;
+    }
+    if( nd > 0 )
+      return NULL;
+    ten_kappa = one;
+  }
+
+  /* Now, round the final digit, provided that the error interval,
+   * rest +/- unit, lies entirely on one side of the mid-point...
+   */
+  if( (unit >= ten_kappa) || (ten_kappa - unit <= unit) )
+    return NULL;
+
+  if( (ten_kappa - rest > rest) && (ten_kappa - 2 * rest >= 2 * unit) )
+    /*
+     * definitely below it, so we simply truncate...
+     */
+    ;
+
+  else if( (rest > unit) && (ten_kappa - (rest - unit) <= (rest - unit)) )
+  { /* or definitely above it, so we round up, propagating any carry
+     * through preceding nines.
+     */
+    for( i = len - 1; (i >= 0) && (buf[i] == '9'); i-- )
+      buf[i] = '0';
+    if( i < 0 )
+      buf[0] = '1', ++*dp;
+    else
+      ++buf[i];
+  }
+
+  else
+    /* or too close to call.
+     */
+    return NULL;
+
+  /* Finally, like `__gdtoa()', suppress trailing zeros.
+   */
+  while( (len > 1) && (buf[len - 1] == '0') )
+    --len;
+  buf[len] = '\0';
+  return buf;
+}
+
+static
+char *__pformat_cvt
+( int mode, __pformat_fpreg_t x, int nd, int *dp, int *sign, char *buf )
 {
   /* Helper function, derived from David M. Gay's `g_xfmt()', calling
    * his `__gdtoa()' function in a manner to provide extended precision
-   * replacements for `ecvt()' and `fcvt()'.
+   * replacements for `ecvt()' and `fcvt()'; when possible, it uses
+   * the `__pformat_cvt_fast()' helper, to place the result in `buf',
+   * (which must accommodate at least PFORMAT_CVT_BUFSIZ characters),
+   * rather than in memory allocated by `__gdtoa()'.
    */
   int k; unsigned int e = 0; char *ep;
   static FPI fpi = { 64, 1-16383-64+1, 32766-16383-64+1, FPI_Round_near, 0 };
@@ -1034,43 +1517,55 @@ char *__pformat_cvt( int mode, __pformat_fpreg_t x, int nd, int *dp, int *sign )
    */
   *sign = (k == STRTOG_NaN) ? 0 : x.__pformat_fpreg_exponent & 0x8000;
 
-  /* Finally, get the raw digit string, and radix point position index.
+  /* For normal values, try the fast digit generator first...
+   */
+  if( (k == STRTOG_Normal) && ((ep = __pformat_cvt_fast( mode,
+	  x.__pformat_fpreg_mantissa, (int)(e), nd, dp, buf )) != NULL) )
+    return ep;
+
+  /* otherwise, get the raw digit string, and radix point position index.
    */
   return __gdtoa( &fpi, e, &x.__pformat_fpreg_bits, &k, mode, nd, dp, &ep );
 }
 
 static __pformat_inline__
-char *__pformat_ecvt( long double x, int precision, int *dp, int *sign )
+char *__pformat_ecvt
+( long double x, int precision, int *dp, int *sign, char *buf )
 {
   /* A convenience wrapper for the above...
    * it emulates `ecvt()', but takes a `long double' argument.
    */
   __pformat_fpreg_t z; z.__pformat_fpreg_ldouble_t = x;
-  return __pformat_cvt( 2, z, precision, dp, sign );
+  return __pformat_cvt( 2, z, precision, dp, sign, buf );
 }
 
 static __pformat_inline__
-char *__pformat_fcvt( long double x, int precision, int *dp, int *sign )
+char *__pformat_fcvt
+( long double x, int precision, int *dp, int *sign, char *buf )
 {
   /* A convenience wrapper for the above...
    * it emulates `fcvt()', but takes a `long double' argument.
    */
   __pformat_fpreg_t z; z.__pformat_fpreg_ldouble_t = x;
-  return __pformat_cvt( 3, z, precision, dp, sign );
+  return __pformat_cvt( 3, z, precision, dp, sign, buf );
 }
 
 /* The following are required, to clean up the `__gdtoa()' memory pool,
- * after processing the data returned by the above.
+ * after processing the data returned by the above; (there is nothing
+ * to clean up, if the result was placed in the caller's buffer).
  */
-#define __pformat_ecvt_release( value ) __freedtoa( value )
-#define __pformat_fcvt_release( value ) __freedtoa( value )
+#define __pformat_ecvt_release( value, buf ) \
+  do { if( (value) != (buf) ) __freedtoa( value ); } while( 0 )
+#define __pformat_fcvt_release( value, buf ) \
+  do { if( (value) != (buf) ) __freedtoa( value ); } while( 0 )
 
 #else
 /* TODO: remove this before final release; it is included here as a
  * convenience for testing, without requiring a working `__gdtoa()'.
  */
 static __inline__
-char *__pformat_ecvt( long double x, int precision, int *dp, int *sign )
+char *__pformat_ecvt
+( long double x, int precision, int *dp, int *sign, char *buf )
 {
   /* Define in terms of `ecvt()'...
    */
@@ -1091,7 +1586,8 @@ char *__pformat_ecvt( long double x, int precision, int *dp, int *sign )
 }
 
 static __inline__
-char *__pformat_fcvt( long double x, int precision, int *dp, int *sign )
+char *__pformat_fcvt
+( long double x, int precision, int *dp, int *sign, char *buf )
 {
   /* Define in terms of `fcvt()'...
    */
@@ -1113,8 +1609,8 @@ char *__pformat_fcvt( long double x, int precision, int *dp, int *sign )
 
 /* No memory pool clean up needed, for these emulated cases...
  */
-#define __pformat_ecvt_release( value ) /* nothing to be done */
-#define __pformat_fcvt_release( value ) /* nothing to be done */
+#define __pformat_ecvt_release( value, buf ) /* nothing to be done */
+#define __pformat_fcvt_release( value, buf ) /* nothing to be done */
 
 /* TODO: end of conditional to be removed. */
 #endif
@@ -1286,8 +1782,7 @@ void __pformat_emit_float( int sign, char *value, int len, __pformat_t *stream )
    * the output within the alloted field width.
    */
   if( (stream->width > 0) && ((stream->flags & PFORMAT_JUSTIFY) == 0) )
-    while( stream->width-- > 0 )
-      __pformat_putc( '\x20', stream );
+    __pformat_pad( '\x20', stream );
 
   /* Emit the sign indicator, as appropriate...
    */
@@ -1314,17 +1809,20 @@ void __pformat_emit_float( int sign, char *value, int len, __pformat_t *stream )
    */
   if(  (stream->width > 0)
   &&  ((stream->flags & PFORMAT_JUSTIFY) == PFORMAT_ZEROFILL)  )
-    while( stream->width-- > 0 )
-      __pformat_putc( '0', stream );
+    __pformat_pad( '0', stream );
 
   /* Emit the digits of the encoded numeric value...
    */
   if( len > 0 )
     /* ...beginning with those which precede the radix point,
-     * and appending any necessary significant trailing zeros.
-     */
-    do { __pformat_putc( *value ? *value++ : '0', stream );
-         if( (--prefix == 0) && (gc > 0) )
+     * and appending any necessary significant trailing zeros; these
+     * are emitted as runs, each extending to the next group boundary,
+     * when thousands grouping is in effect, or otherwise as a single
+     * run of all such digits.
+     */
+    do { int run = (gc > 0) ? prefix : len;
+	 __pformat_emit_digits( &value, run, stream );
+	 if( ((len -= run) > 0) && (gc > 0) )
 	 {
 	   /* When thousands digits grouping has been enabled,
 	    * emit group separators as directed by the grouping
@@ -1335,7 +1833,7 @@ void __pformat_emit_float( int sign, char *value, int len, __pformat_t *stream )
 	      while( (*gp != '\0') && (*gp != CHAR_MAX) && (--c > 0) );
 	   __pformat_emit_digit( ',', stream ); --len;
 	 }
-       } while( --len > 0 );
+       } while( len > 0 );
 
   else
     /* The magnitude of the encoded value is less than 1.0, so no
@@ -1366,15 +1864,14 @@ void __pformat_emit_float( int sign, char *value, int len, __pformat_t *stream )
      * as are required.
      */
     stream->precision += len;
-    do __pformat_putc( '0', stream );
-       while( ++len < 0 );
+    __pformat_fill( '0', -len, stream );
   }
 
   /* Now we emit any remaining significant digits, or trailing zeros,
    * until the required precision has been achieved.
    */
-  while( stream->precision-- > 0 )
-    __pformat_putc( *value ? *value++ : '0', stream );
+  __pformat_emit_digits( &value, stream->precision, stream );
+  stream->precision = PFORMAT_IGNORE;
 }
 
 static
@@ -1456,7 +1953,7 @@ void __pformat_float( long double x, __pformat_t *stream )
    * and `__pformat_emit_inf_or_nan()', as appropriate, to achieve
    * output in fixed point format.
    */
-  int sign, intlen; char *value;
+  int sign, intlen; char *value, buf[PFORMAT_CVT_BUFSIZ];
 
   /* Establish the precision for the displayed value, defaulting to six
    * digits following the decimal point, if not explicitly specified.
@@ -1466,7 +1963,7 @@ void __pformat_float( long double x, __pformat_t *stream )
 
   /* Encode the input value as ASCII, for display...
    */
-  value = __pformat_fcvt( x, stream->precision, &intlen, &sign );
+  value = __pformat_fcvt( x, stream->precision, &intlen, &sign, buf );
 
   if( intlen == PFORMAT_INFNAN )
     /*
@@ -1483,13 +1980,12 @@ void __pformat_float( long double x, __pformat_t *stream )
      * then we must be doing flush left justification, so pad out to
      * the right hand field boundary.
      */
-    while( stream->width-- > 0 )
-      __pformat_putc( '\x20', stream );
+    __pformat_pad( '\x20', stream );
   }
 
   /* Clean up `__pformat_fcvt()' memory allocation for `value'...
    */
-  __pformat_fcvt_release( value );
+  __pformat_fcvt_release( value, buf );
 }
 
 static
@@ -1501,7 +1997,7 @@ void __pformat_efloat( long double x, __pformat_t *stream )
    * and `__pformat_emit_inf_or_nan()', as appropriate, to achieve
    * output in floating point format.
    */
-  int sign, intlen; char *value;
+  int sign, intlen; char *value, buf[PFORMAT_CVT_BUFSIZ];
 
   /* Establish the precision for the displayed value, defaulting to six
    * digits following the decimal point, if not explicitly specified.
@@ -1511,7 +2007,7 @@ void __pformat_efloat( long double x, __pformat_t *stream )
 
   /* Encode the input value as ASCII, for display...
    */
-  value = __pformat_ecvt( x, stream->precision + 1, &intlen, &sign );
+  value = __pformat_ecvt( x, stream->precision + 1, &intlen, &sign, buf );
 
   if( intlen == PFORMAT_INFNAN )
     /*
@@ -1526,7 +2022,7 @@ void __pformat_efloat( long double x, __pformat_t *stream )
 
   /* Clean up `__pformat_ecvt()' memory allocation for `value'...
    */
-  __pformat_ecvt_release( value );
+  __pformat_ecvt_release( value, buf );
 }
 
 static
@@ -1539,7 +2035,7 @@ void __pformat_gfloat( long double x, __pformat_t *stream )
    * appropriate, to achieve output in the more suitable of either
    * fixed or floating point format.
    */
-  int sign, intlen; char *value;
+  int sign, intlen; char *value, buf[PFORMAT_CVT_BUFSIZ];
 
   /* Establish the precision for the displayed value, defaulting to
    * six significant digits, if not explicitly specified...
@@ -1554,7 +2050,7 @@ void __pformat_gfloat( long double x, __pformat_t *stream )
 
   /* Encode the input value as ASCII, for display.
    */
-  value = __pformat_ecvt( x, stream->precision, &intlen, &sign );
+  value = __pformat_ecvt( x, stream->precision, &intlen, &sign, buf );
 
   if( intlen == PFORMAT_INFNAN )
     /*
@@ -1602,8 +2098,7 @@ void __pformat_gfloat( long double x, __pformat_t *stream )
      * we must be doing flush left justification, so pad out to the
      * right hand field boundary.
      */
-    while( stream->width-- > 0 )
-      __pformat_putc( '\x20', stream );
+    __pformat_pad( '\x20', stream );
   }
 
   else
@@ -1638,7 +2133,7 @@ void __pformat_gfloat( long double x, __pformat_t *stream )
 
   /* Clean up `__pformat_ecvt()' memory allocation for `value'.
    */
-  __pformat_ecvt_release( value );
+  __pformat_ecvt_release( value, buf );
 }
 
 static
@@ -1837,8 +2332,7 @@ void __pformat_emit_xfloat( __pformat_fpreg_t value, __pformat_t *stream )
       /* and then emit any required left side padding spaces.
        */
       if( (stream->flags & PFORMAT_JUSTIFY) == 0 )
-	while( stream->width-- > 0 )
-	  __pformat_putc( '\x20', stream );
+	__pformat_pad( '\x20', stream );
     }
 
     else
@@ -1878,8 +2372,7 @@ void __pformat_emit_xfloat( __pformat_fpreg_t value, __pformat_t *stream )
    */
   if(  (stream->width > 0)
   &&  ((stream->flags & PFORMAT_JUSTIFY) == PFORMAT_ZEROFILL)  )
-    while( stream->width-- > 0 )
-      __pformat_putc( '0', stream );
+    __pformat_pad( '0', stream );
 
   /* Next, we emit the encoded value, without its exponent...
    */
@@ -1889,8 +2382,8 @@ void __pformat_emit_xfloat( __pformat_fpreg_t value, __pformat_t *stream )
   /* followed by any additional zeros needed to satisfy the
    * precision specification...
    */
-  while( stream->precision-- > 0 )
-    __pformat_putc( '0', stream );
+  __pformat_fill( '0', stream->precision, stream );
+  stream->precision = PFORMAT_IGNORE;
 
   /* then the exponent prefix, (C99 and POSIX specify `p'),
    * in the case appropriate to the format specification...
@@ -2667,6 +3160,7 @@ int __pformat_argmap( int argc, const char *fmt, __pformat_argmap_t *map )
 int __pformat( int flags, void *dest, int max, const char *fmt, va_list args )
 {
   int c, argc;
+  char buf[PFORMAT_BUFSIZ];
 
   __pformat_t stream =
   { /* Create and initialise a format control block
@@ -2683,7 +3177,9 @@ int __pformat( int flags, void *dest, int max, const char *fmt, va_list args )
     PFORMAT_MINEXP,				/* exponent chars preferred   */
     PFORMAT_RPINIT,				/* thou' sep uninitialised    */
     (wchar_t)(0),				/* leave it unspecified ...   */
-    NULL					/* with no grouping counts    */
+    NULL,					/* with no grouping counts    */
+    buf,					/* FILE output staging buffer */
+    0						/* which is initially empty   */
   };
 
   /* Establish a variant argument resource pool, to support processing of
@@ -3381,10 +3877,14 @@ int __pformat( int flags, void *dest, int max, const char *fmt, va_list args )
       }
     }
     else
-      /* We just parsed a character which is not included within any format
-       * specification; we simply emit it as a literal.
+    { /* We just parsed a character which is not included within any format
+       * specification; we simply emit it as a literal, together with all
+       * immediately following literal text, as a single run.
        */
-      __pformat_putc( c, &stream );
+      const char *literal = fmt - 1;
+      while( (*fmt != '\0') && (*fmt != '%') ) ++fmt;
+      __pformat_putn( literal, fmt - literal, &stream );
+    }
   }
   /* Clean up the resource pool, which was allocated for local processing of
    * the passed-in argument vector in either sequential or random order.
@@ -3397,6 +3897,12 @@ int __pformat( int flags, void *dest, int max, const char *fmt, va_list args )
    */
   free( stream.grouping );
 
+  /* Ensure that any output which remains staged in the local buffer is
+   * transferred to its ultimate FILE stream destination.
+   */
+  if( flags & PFORMAT_TO_FILE )
+    __pformat_flush( &stream );
+
   /* When we have fully dispatched the format string, the return value is the
    * total number of bytes we transferred to the output destination.
    */
@@ -0,0 +1,1116 @@
+/* pscanf.c
+ *
+ * $Id$
+ *
+ * Provides a core implementation of the input conversion capabilities
+ * common to the entire `scanf()' family of functions; it conforms to the
+ * C99 and SUSv3/POSIX specifications, including support for the `hh',
+ * `ll', `j', `z' and `t' length modifiers, hexadecimal floating point
+ * input, and positional `%n$' argument references, with extensions to
+ * support Microsoft's `I', `I32' and `I64' length modifiers.
+ *
+ * This file is compiled twice: once as is, to provide the `__pscanf()'
+ * function, which implements the `scanf()' family, and once more with
+ * `_UNICODE' defined, to provide `__pwscanf()', which implements the
+ * `wscanf()' family; both share the entire conversion core.
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <locale.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#include "pscanf.h"
+
+#ifdef _WIN32
+/* The floating point conversions are delegated to the same functions
+ * which implement strtof(), strtod() and strtold(), in libmingwex.a
+ */
+#include "gdtoa.h"
+#include <dlfcn.h>
+
+#else
+/* When building on a non-Windows host, (for testing only), we delegate
+ * to the host's own floating point conversion functions.
+ */
+#define __strtof    strtof
+#define __strtod    strtod
+#define __strtold   strtold
+#endif
+
+#ifdef __GNUC__
+# define __pscanf_inline__  __inline__ __attribute__((__always_inline__))
+#else
+# define __pscanf_inline__
+#endif
+
+#ifdef _UNICODE
+/* We are compiling the `wscanf()' variant; both the format and the
+ * input are sequences of wide characters.
+ */
+typedef wchar_t  __pscanf_char_t;
+#define PSCANF_UCHAR(C)       ((int)(C))
+#define __pscanf_isspace(C)   iswspace(C)
+#define __pscanf_core         __pwscanf
+
+#else
+/* We are compiling the `scanf()' variant; both the format and the
+ * input are sequences of (possibly multibyte) char elements.
+ */
+typedef char     __pscanf_char_t;
+#define PSCANF_UCHAR(C)       ((unsigned char)(C))
+#define __pscanf_isspace(C)   isspace(C)
+#define __pscanf_core         __pscanf
+#endif
+
+/* In either case, input characters are handled internally as int
+ * values, with EOF representing end of input; (we cannot use wint_t,
+ * with WEOF, for wide input, because on Windows, wint_t is only 16
+ * bits wide, which leaves no room for our pseudo-character).
+ */
+typedef int      __pscanf_int_t;
+#define PSCANF_EOF            EOF
+
+/* A pseudo-character, returned by `__pscanf_next()' when the input
+ * field width has been exhausted; unlike PSCANF_EOF, this does not
+ * imply that there is no further input.
+ */
+#define PSCANF_NOCHAR         ((__pscanf_int_t)(-2))
+
+/* Argument length classification, (similar to that used by pformat).
+ */
+typedef enum
+{
+  PSCANF_LENGTH_INT = 0,
+  PSCANF_LENGTH_SHORT,
+  PSCANF_LENGTH_LONG,
+  PSCANF_LENGTH_LLONG,
+  PSCANF_LENGTH_LDOUBLE,
+  PSCANF_LENGTH_CHAR
+} __pscanf_length_t;
+
+#define __pscanf_arg_length( type )    \
+  sizeof( type ) == sizeof( long long ) ? PSCANF_LENGTH_LLONG : \
+  sizeof( type ) == sizeof( long )      ? PSCANF_LENGTH_LONG  : \
+  sizeof( type ) == sizeof( short )     ? PSCANF_LENGTH_SHORT : \
+  sizeof( type ) == sizeof( char )      ? PSCANF_LENGTH_CHAR  : \
+  /* should never need this default */    PSCANF_LENGTH_INT
+
+typedef struct
+{
+  /* The input source control block; input is consumed directly from
+   * a contiguous window, which, for a string source, is the entire
+   * string, or for a FILE stream is the unread content of its buffer;
+   * only when this is exhausted do we need to call any function, to
+   * refill it.
+   */
+  const __pscanf_char_t *ptr;
+  const __pscanf_char_t *end;
+  const __pscanf_char_t *base;
+  FILE                  *file;
+  int                    done;
+  int                    eof;
+# ifdef _UNICODE
+  wchar_t                wbuf[1];
+# endif
+} __pscanf_src_t;
+
+#ifdef _WIN32
+/* Access to the content of the FILE stream buffer, and to the stream
+ * locking functions, is necessarily specific to the C runtime library
+ * implementation; for MSVCRT.DLL...
+ */
+#define PSCANF_FILE_PTR(F)    ((F)->_ptr)
+#define PSCANF_FILE_END(F)    ((F)->_ptr + (((F)->_cnt > 0) ? (F)->_cnt : 0))
+#define PSCANF_FILE_SYNC(F,P,E) ((F)->_cnt = (E) - ((F)->_ptr = (char *)(P)))
+#define PSCANF_FILE_FILL(F)   _filbuf( F )
+
+static void __pscanf_lock( FILE *stream, int unlock )
+{
+  /* ...stream locking is available only if the running MSVCRT.DLL
+   * exports the (undocumented) _lock_file() and _unlock_file() pair;
+   * when it doesn't, this becomes a no-op.
+   */
+  typedef void (*lock_fn)( FILE * );
+  static lock_fn lock[2]; static int initialized = 0;
+
+  if( ! initialized )
+  {
+    lock_fn fn[2];
+    fn[0] = (lock_fn)(dlsym( RTLD_DEFAULT, "_lock_file" ));
+    fn[1] = (lock_fn)(dlsym( RTLD_DEFAULT, "_unlock_file" ));
+    if( (fn[0] == NULL) || (fn[1] == NULL) )
+      fn[0] = fn[1] = NULL;
+    lock[0] = fn[0]; lock[1] = fn[1]; initialized = 1;
+  }
+  if( lock[unlock] != NULL )
+    lock[unlock]( stream );
+}
+
+#else
+/* ...whereas, for testing on non-Windows hosts, we assume GNU libc.
+ */
+#define PSCANF_FILE_PTR(F)    ((F)->_IO_read_ptr)
+#define PSCANF_FILE_END(F)    ((F)->_IO_read_end)
+#define PSCANF_FILE_SYNC(F,P,E) ((F)->_IO_read_ptr = (char *)(P))
+#define PSCANF_FILE_FILL(F)   __uflow( F )
+
+extern int __uflow( FILE * );
+
+static void __pscanf_lock( FILE *stream, int unlock )
+{ if( unlock ) funlockfile( stream ); else flockfile( stream ); }
+#endif
+
+static
+__pscanf_int_t __pscanf_refill( __pscanf_src_t *src )
+{
+  /* Helper to refill the input window, when it has been exhausted;
+   * returns the first character from the new window, (which will
+   * then be consumed), or PSCANF_EOF, at end of input.
+   */
+  if( (src->file == NULL) || src->eof )
+    return PSCANF_EOF;
+
+  /* Account for all characters consumed from the exhausted window,
+   * before we replace it.
+   */
+  src->done += src->ptr - src->base;
+
+# ifdef _UNICODE
+  /* For wide character input, we defer to fgetwc(), which handles
+   * any necessary conversion from the external representation; each
+   * window then comprises just the one character it returns, which
+   * we retain, so that it may be pushed back, if necessary.
+   */
+  { wint_t wc;
+    if( (wc = fgetwc( src->file )) == WEOF )
+    { src->eof = 1; src->base = src->ptr = src->end = src->wbuf;
+      return PSCANF_EOF;
+    }
+    src->wbuf[0] = wc;
+  }
+  src->base = src->ptr = src->wbuf; src->end = src->wbuf + 1;
+
+# else
+  /* For char input, we must synchronize the FILE stream with what we
+   * have consumed, before we ask it to refill its buffer; it returns
+   * the first character from the refilled buffer, having consumed it,
+   * but that character remains in the buffer, so we may begin our
+   * new window with it, and thus we may push it back if necessary.
+   */
+  PSCANF_FILE_SYNC( src->file, src->ptr, src->end );
+  if( PSCANF_FILE_FILL( src->file ) == EOF )
+  { src->eof = 1; src->base = src->ptr = src->end = PSCANF_FILE_PTR( src->file );
+    return PSCANF_EOF;
+  }
+  src->base = src->ptr = PSCANF_FILE_PTR( src->file ) - 1;
+  src->end = PSCANF_FILE_END( src->file );
+# endif
+
+  return PSCANF_UCHAR( *src->ptr++ );
+}
+
+static __pscanf_inline__
+__pscanf_int_t __pscanf_getc( __pscanf_src_t *src )
+{
+  /* Fetch the next available input character, (or PSCANF_EOF); this
+   * is the hot path, for which the window makes character retrieval
+   * as cheap as it would be for string input.
+   */
+  if( src->ptr < src->end )
+    return PSCANF_UCHAR( *src->ptr++ );
+  return __pscanf_refill( src );
+}
+
+static __pscanf_inline__
+void __pscanf_ungetc( __pscanf_int_t c, __pscanf_src_t *src )
+{
+  /* Push back the single character most recently fetched; (we never
+   * push back more than one, and that one always remains within the
+   * active window, so this is simply a matter of backing up).
+   */
+  if( (c != PSCANF_EOF) && (c != PSCANF_NOCHAR) )
+    --src->ptr;
+}
+
+static __pscanf_inline__
+int __pscanf_count( __pscanf_src_t *src )
+{
+  /* Report the number of characters consumed, (for `%n').
+   */
+  return src->done + (src->ptr - src->base);
+}
+
+static __pscanf_inline__
+__pscanf_int_t __pscanf_next( int *width, __pscanf_src_t *src )
+{
+  /* Fetch the next character of a field which has been limited to
+   * a maximum of `*width' characters, of which one has already been
+   * fetched, returning PSCANF_NOCHAR when the limit is reached.
+   */
+  return (--*width > 0) ? __pscanf_getc( src ) : PSCANF_NOCHAR;
+}
+
+static __pscanf_inline__
+__pscanf_int_t __pscanf_skip_space( __pscanf_src_t *src )
+{
+  /* Consume, and discard, any white space from the input, returning
+   * the first non-space character, which is pushed back.
+   */
+  __pscanf_int_t c;
+  while( ((c = __pscanf_getc( src )) != PSCANF_EOF) && __pscanf_isspace( c ) )
+    ;
+  __pscanf_ungetc( c, src );
+  return c;
+}
+
+static __pscanf_inline__
+int __pscanf_digit( __pscanf_int_t c )
+{
+  /* Return the numeric value of a character, interpreted as a digit
+   * in any base up to 36, or 36 if it isn't a digit at all.
+   */
+  if( (c >= '0') && (c <= '9') )
+    return c - '0';
+  if( (c >= 'a') && (c <= 'z') )
+    return c - 'a' + 10;
+  if( (c >= 'A') && (c <= 'Z') )
+    return c - 'A' + 10;
+  return 36;
+}
+
+static
+int __pscanf_int( __pscanf_src_t *src, int base, int width, int is_signed,
+    unsigned long long *result )
+{
+  /* Handler for the `%d', `%i', `%o', `%u', `%x', `%X' and `%p' input
+   * conversions, returning 1 on success, 0 on matching failure, or EOF
+   * on input failure; on success, the converted value is stored, with
+   * the same overflow semantics as strtoll(), (when `is_signed'), or
+   * strtoull(), in `*result'.
+   */
+  __pscanf_int_t c = __pscanf_getc( src );
+  unsigned long value = 0UL; unsigned long long wide;
+  int negative = 0, overflow = 0, digits = 0, limit, d;
+
+  if( c == PSCANF_EOF )
+    return EOF;
+
+  if( (c == '-') || (c == '+') )
+  {
+    /* Note any sign, which must be followed by a digit...
+     */
+    negative = (c == '-');
+    if( ((c = __pscanf_next( &width, src )) == PSCANF_EOF) || (c == PSCANF_NOCHAR) )
+      return 0;
+  }
+  if( ((base == 0) || (base == 16)) && (c == '0') )
+  {
+    /* ...although a leading zero may imply octal, or a hexadecimal
+     * prefix; (like GNU libc, we interpret "0x", with no hexadecimal
+     * digits following, as a zero value).
+     */
+    ++digits; c = __pscanf_next( &width, src );
+    if( (c == 'x') || (c == 'X') )
+    {
+      base = 16; c = __pscanf_next( &width, src );
+    }
+    else if( base == 0 )
+      base = 8;
+  }
+  else if( base == 0 )
+    base = 10;
+
+  /* While at most this many digits have been accumulated, the value
+   * is known to fit within 32-bits, so we may use 32-bit arithmetic,
+   * with no need to check for overflow...
+   */
+  limit = (base == 16) ? 8 : (base == 10) ? 9 : 10;
+  while( (digits < limit) && ((d = __pscanf_digit( c )) < base) )
+  {
+    value = value * base + d; ++digits;
+    c = __pscanf_next( &width, src );
+  }
+  /* ...beyond which we must switch to 64-bit arithmetic.
+   */
+  wide = value;
+  while( (d = __pscanf_digit( c )) < base )
+  {
+    if( wide > (ULLONG_MAX - d) / base )
+      overflow = 1;
+    else
+      wide = wide * base + d;
+    ++digits; c = __pscanf_next( &width, src );
+  }
+  __pscanf_ungetc( c, src );
+
+  if( digits == 0 )
+    return 0;
+
+  if( is_signed )
+  {
+    /* Apply strtoll() range limits...
+     */
+    if( overflow || (wide > (negative ? (unsigned long long)(LLONG_MAX) + 1ULL
+	  : (unsigned long long)(LLONG_MAX))) )
+      wide = negative ? (unsigned long long)(LLONG_MIN) : (unsigned long long)(LLONG_MAX);
+    else if( negative )
+      wide = -wide;
+  }
+  else if( overflow )
+    /* ...or strtoull() range limits, as appropriate.
+     */
+    wide = ULLONG_MAX;
+
+  else if( negative )
+    wide = -wide;
+
+  *result = wide;
+  return 1;
+}
+
+typedef struct
+{
+  /* A growable buffer, in which to collect the characters of a
+   * floating point input field.
+   */
+  char  *buf;
+  int    len;
+  int    size;
+  char   local[64];
+} __pscanf_token_t;
+
+static
+int __pscanf_token_add( __pscanf_token_t *token, int c )
+{
+  /* Append one character to a token, extending its buffer if required;
+   * returns zero, if the buffer cannot be extended.
+   */
+  if( token->len + 1 >= token->size )
+  {
+    char *buf = (token->buf == token->local) ? NULL : token->buf;
+    if( (buf = realloc( buf, token->size << 1 )) == NULL )
+      return 0;
+    if( token->buf == token->local )
+      memcpy( buf, token->local, token->len );
+    token->buf = buf; token->size <<= 1;
+  }
+  token->buf[token->len++] = c;
+  return 1;
+}
+
+static __pscanf_inline__
+int __pscanf_lower( __pscanf_int_t c )
+{
+  /* Case folding for ASCII letters, as required for matching "inf",
+   * "nan", and the `e', `p' and `x' elements of numbers.
+   */
+  return ((c >= 'A') && (c <= 'Z')) ? c + 'a' - 'A' : c;
+}
+
+static
+int __pscanf_float_token( __pscanf_src_t *src, int width, int radix,
+    __pscanf_int_t wradix, __pscanf_token_t *token )
+{
+  /* Collect the longest initial sequence of input, (not exceeding
+   * `width' characters), which forms a valid prefix of a floating
+   * point number, as accepted by strtod(); returns the number of
+   * mantissa digits collected, EOF on input failure, or a negative
+   * value other than EOF, if the token is malformed.
+   */
+  __pscanf_int_t c = __pscanf_getc( src );
+  int digits = 0, hex = 0;
+
+# define PSCANF_ADD(C)  \
+  if( ! __pscanf_token_add( token, (C) ) ) { __pscanf_ungetc( c, src ); return -2; }
+
+  if( c == PSCANF_EOF )
+    return EOF;
+
+  if( (c == '-') || (c == '+') )
+  { PSCANF_ADD( c ); c = __pscanf_next( &width, src );
+  }
+  if( (__pscanf_lower( c ) == 'i') || (__pscanf_lower( c ) == 'n') )
+  {
+    /* This may be "inf", or "infinity", or it may be "nan", optionally
+     * followed by a parenthesized sequence of alphanumeric characters;
+     * the first three characters are mandatory, in every case...
+     */
+    int is_nan = (__pscanf_lower( c ) == 'n');
+    const char *match = is_nan ? "nan" : "infinity";
+    const char *end = match + 3;
+    while( (*match != '\0') && (__pscanf_lower( c ) == *match) )
+    { PSCANF_ADD( c ); ++match; c = __pscanf_next( &width, src );
+    }
+    if( (match < end) || ((match > end) && (*match != '\0')) )
+      /*
+       * ...and, since we cannot push back more than one character, a
+       * partial match for "infinity", beyond "inf", is malformed.
+       */
+      goto malformed;
+
+    if( is_nan && (c == '(') )
+    {
+      do { PSCANF_ADD( c ); c = __pscanf_next( &width, src );
+	 } while( (c == '_') || (__pscanf_digit( c ) < 36) );
+      if( c != ')' )
+	goto malformed;
+      PSCANF_ADD( c ); c = PSCANF_NOCHAR;
+    }
+    __pscanf_ungetc( c, src );
+    return 1;
+  }
+
+  if( c == '0' )
+  {
+    /* A leading zero may introduce a hexadecimal number.
+     */
+    PSCANF_ADD( c ); ++digits; c = __pscanf_next( &width, src );
+    if( __pscanf_lower( c ) == 'x' )
+    {
+      PSCANF_ADD( c ); c = __pscanf_next( &width, src );
+      hex = 1; digits = 0;
+    }
+  }
+  while( (hex ? __pscanf_digit( c ) < 16 : (c >= '0') && (c <= '9')) )
+  { PSCANF_ADD( c ); ++digits; c = __pscanf_next( &width, src );
+  }
+  if( (c != PSCANF_EOF) && (c != PSCANF_NOCHAR) && (c == wradix) )
+  {
+    PSCANF_ADD( radix ); c = __pscanf_next( &width, src );
+    while( (hex ? __pscanf_digit( c ) < 16 : (c >= '0') && (c <= '9')) )
+    { PSCANF_ADD( c ); ++digits; c = __pscanf_next( &width, src );
+    }
+  }
+  if( digits == 0 )
+    goto malformed;
+
+  if( __pscanf_lower( c ) == (hex ? 'p' : 'e') )
+  {
+    /* There is an exponent, in which at least one digit is required.
+     */
+    PSCANF_ADD( c ); c = __pscanf_next( &width, src );
+    if( (c == '-') || (c == '+') )
+    { PSCANF_ADD( c ); c = __pscanf_next( &width, src );
+    }
+    if( (c < '0') || (c > '9') )
+      goto malformed;
+    do { PSCANF_ADD( c ); c = __pscanf_next( &width, src );
+       } while( (c >= '0') && (c <= '9') );
+  }
+  __pscanf_ungetc( c, src );
+  return digits;
+
+malformed:
+  __pscanf_ungetc( c, src );
+  return -2;
+# undef PSCANF_ADD
+}
+
+static
+int __pscanf_float( __pscanf_src_t *src, int width, __pscanf_length_t length,
+    void *arg )
+{
+  /* Handler for the `%a', `%e', `%f' and `%g' input conversions, (and
+   * their upper case equivalents), returning 1 on success, 0 on matching
+   * failure, or EOF on input failure.
+   */
+  __pscanf_token_t token;
+  int radix, status; char *end;
+  __pscanf_int_t wradix;
+
+  /* The radix point must be that of the current locale; (we support
+   * only radix points which may be represented as a single byte).
+   */
+  radix = (unsigned char)(*localeconv()->decimal_point);
+  if( radix == '\0' )
+    radix = '.';
+# ifdef _UNICODE
+  if( (wradix = btowc( radix )) == (__pscanf_int_t)(WEOF) )
+    wradix = L'.';
+# else
+  wradix = radix;
+# endif
+
+  token.buf = token.local; token.len = 0; token.size = sizeof( token.local );
+  status = __pscanf_float_token( src, width, radix, wradix, &token );
+  if( status == EOF )
+    return EOF;
+
+  if( status > 0 )
+  {
+    /* We have a plausible token; have strtod(), (or its appropriate
+     * equivalent), convert it, and confirm that it was entirely used.
+     */
+    token.buf[token.len] = '\0';
+    switch( length )
+    {
+      case PSCANF_LENGTH_LDOUBLE:
+	{ long double value = __strtold( token.buf, &end );
+	  if( (status = (end == token.buf + token.len)) && (arg != NULL) )
+	    *(long double *)(arg) = value;
+	}
+	break;
+
+      case PSCANF_LENGTH_LONG:
+	{ double value = __strtod( token.buf, &end );
+	  if( (status = (end == token.buf + token.len)) && (arg != NULL) )
+	    *(double *)(arg) = value;
+	}
+	break;
+
+      default:
+	{ float value = __strtof( token.buf, &end );
+	  if( (status = (end == token.buf + token.len)) && (arg != NULL) )
+	    *(float *)(arg) = value;
+	}
+    }
+  }
+  else
+    status = 0;
+
+  if( token.buf != token.local )
+    free( token.buf );
+  return status;
+}
+
+typedef struct
+{
+  /* The representation of a `%[' conversion scan set; for narrow input
+   * this is a bit map, with one bit for each possible input character,
+   * while for wide input, it refers to the defining format elements.
+   */
+# ifdef _UNICODE
+  const wchar_t *first;
+  const wchar_t *last;
+# else
+  unsigned char  map[(UCHAR_MAX + 1) / CHAR_BIT];
+# endif
+  int            invert;
+} __pscanf_scanset_t;
+
+static
+const __pscanf_char_t *__pscanf_scanset( const __pscanf_char_t *fmt,
+    __pscanf_scanset_t *set )
+{
+  /* Parse the scan set specification, following the opening `[' of
+   * a `%[' conversion specification; returns a pointer to its closing
+   * `]', or NULL if there is none.
+   */
+  const __pscanf_char_t *first;
+
+  if( (set->invert = (*fmt == '^')) )
+    ++fmt;
+
+  /* A `]' immediately following the opening `[', (or `[^'), is taken
+   * literally, as a member of the set.
+   */
+  first = fmt;
+  if( *fmt == ']' )
+    ++fmt;
+  while( (*fmt != '\0') && (*fmt != ']') )
+    ++fmt;
+  if( *fmt == '\0' )
+    return NULL;
+
+# ifdef _UNICODE
+  set->first = first; set->last = fmt;
+
+# else
+  memset( set->map, 0, sizeof( set->map ) );
+  while( first < fmt )
+  {
+    /* A `-' between two characters specifies the inclusive range
+     * of those characters, (provided they appear in ascending order);
+     * otherwise, a `-' represents itself.
+     */
+    unsigned lo = PSCANF_UCHAR( *first ), hi = lo;
+    if( (first[1] == '-') && (first + 2 < fmt) && (PSCANF_UCHAR( first[2] ) >= lo) )
+    { hi = PSCANF_UCHAR( first[2] ); first += 3;
+    }
+    else
+      ++first;
+    do set->map[lo / CHAR_BIT] |= 1 << (lo % CHAR_BIT);
+    while( lo++ < hi );
+  }
+# endif
+  return fmt;
+}
+
+static __pscanf_inline__
+int __pscanf_in_scanset( __pscanf_int_t c, const __pscanf_scanset_t *set )
+{
+  /* Check if the input character `c' is a member of the scan set.
+   */
+  int member = 0;
+# ifdef _UNICODE
+  const wchar_t *p = set->first;
+  while( p < set->last )
+  {
+    if( (p[1] == L'-') && (p + 2 < set->last) && (p[2] >= p[0]) )
+    { if( (c >= p[0]) && (c <= p[2]) )
+      { member = 1; break;
+      }
+      p += 3;
+    }
+    else if( c == *p++ )
+    { member = 1; break;
+    }
+  }
+# else
+  member = (set->map[c / CHAR_BIT] >> (c % CHAR_BIT)) & 1;
+# endif
+  return member ^ set->invert;
+}
+
+typedef struct
+{
+  /* The destination for the `%c', `%s' and `%[' conversions, which
+   * may require conversion between char and wchar_t representations.
+   */
+  char    *str;
+  wchar_t *wcs;
+  mbstate_t state;
+} __pscanf_dest_t;
+
+static __pscanf_inline__
+int __pscanf_store( __pscanf_int_t c, __pscanf_dest_t *dest )
+{
+  /* Store one input character at the destination, (if any), converting
+   * as required; returns zero if the input cannot be converted.
+   */
+# ifdef _UNICODE
+  if( dest->wcs != NULL )
+    *dest->wcs++ = c;
+  else if( dest->str != NULL )
+  { size_t len = wcrtomb( dest->str, c, &dest->state );
+    if( len == (size_t)(-1) )
+      return 0;
+    dest->str += len;
+  }
+# else
+  if( dest->str != NULL )
+    *dest->str++ = c;
+  else if( dest->wcs != NULL )
+  { char mb = c;
+    switch( mbrtowc( dest->wcs, &mb, 1, &dest->state ) )
+    {
+      case (size_t)(-1):
+	return 0;
+      case (size_t)(-2):
+	break;
+      default:
+	++dest->wcs;
+    }
+  }
+# endif
+  return 1;
+}
+
+static __pscanf_inline__
+void __pscanf_terminate( __pscanf_dest_t *dest )
+{
+  /* Append a terminating NUL to a `%s', or `%[' conversion result.
+   */
+  if( dest->wcs != NULL )
+    *dest->wcs = L'\0';
+  else if( dest->str != NULL )
+    *dest->str = '\0';
+}
+
+static __pscanf_inline__
+void __pscanf_store_int( void *arg, __pscanf_length_t length, unsigned long long value )
+{
+  /* Assign a converted integer value to its destination argument,
+   * truncating it as appropriate for the argument type.
+   */
+  switch( length )
+  {
+    case PSCANF_LENGTH_CHAR:
+      *(char *)(arg) = (char)(value);
+      break;
+
+    case PSCANF_LENGTH_SHORT:
+      *(short *)(arg) = (short)(value);
+      break;
+
+    case PSCANF_LENGTH_LONG:
+      *(long *)(arg) = (long)(value);
+      break;
+
+    case PSCANF_LENGTH_LDOUBLE:
+      /* The `L' length modifier, when qualifying an integer conversion,
+       * is taken to mean long long; fall through...
+       */
+    case PSCANF_LENGTH_LLONG:
+      *(long long *)(arg) = (long long)(value);
+      break;
+
+    default:
+      *(int *)(arg) = (int)(value);
+  }
+}
+
+int __cdecl __pscanf_core( int flags, void *src_arg, const __pscanf_char_t *fmt,
+    va_list argv )
+{
+  /* Interpret the format specification, `fmt', consuming input from
+   * `src_arg', which is either a FILE stream, (if `flags' includes
+   * PSCANF_FROM_FILE), or a NUL terminated string, and assigning the
+   * converted values to the arguments referenced by `argv'.
+   */
+  __pscanf_src_t src;
+  int assigned = 0, failed = 0;
+  va_list origin;
+
+  /* Set up the input window...
+   */
+  if( flags & PSCANF_FROM_FILE )
+  {
+    src.file = (FILE *)(src_arg);
+    __pscanf_lock( src.file, 0 );
+#   ifdef _UNICODE
+    src.base = src.ptr = src.end = src.wbuf;
+#   else
+    src.base = src.ptr = PSCANF_FILE_PTR( src.file );
+    src.end = PSCANF_FILE_END( src.file );
+#   endif
+  }
+  else
+  {
+    src.file = NULL;
+    src.base = src.ptr = (const __pscanf_char_t *)(src_arg);
+#   ifdef _UNICODE
+    src.end = src.ptr + wcslen( src.ptr );
+#   else
+    src.end = src.ptr + strlen( src.ptr );
+#   endif
+  }
+  src.done = src.eof = 0;
+  va_copy( origin, argv );
+
+  while( (failed == 0) && (*fmt != '\0') )
+  {
+    __pscanf_length_t length = PSCANF_LENGTH_INT;
+    int width = 0, suppress = 0, positional = 0, wide = 0, status = 1;
+    unsigned long long value;
+    __pscanf_int_t c;
+    void *arg = NULL;
+
+    if( __pscanf_isspace( PSCANF_UCHAR( *fmt ) ) )
+    {
+      /* A white space directive matches any amount of white space,
+       * (including none), in the input.
+       */
+      while( __pscanf_isspace( PSCANF_UCHAR( *++fmt ) ) )
+	;
+      __pscanf_skip_space( &src );
+      continue;
+    }
+
+    if( (*fmt != '%') || (fmt[1] == '%') )
+    {
+      /* An ordinary character, (or "%%"), must match the next input
+       * character exactly, (but "%%" may be preceded by white space).
+       */
+      if( *fmt == '%' )
+      { __pscanf_skip_space( &src ); ++fmt;
+      }
+      if( (c = __pscanf_getc( &src )) != PSCANF_UCHAR( *fmt ) )
+      {
+	__pscanf_ungetc( c, &src );
+	failed = (c == PSCANF_EOF) ? EOF : 1;
+      }
+      ++fmt;
+      continue;
+    }
+
+    /* We have a conversion specification; it may begin with a `%n$'
+     * positional argument reference, or with a field width, either
+     * of which may be preceded by an assignment suppression flag.
+     */
+    if( *++fmt == '*' )
+    { suppress = 1; ++fmt;
+    }
+    while( (*fmt >= '0') && (*fmt <= '9') )
+      width = width * 10 + *fmt++ - '0';
+    if( (*fmt == '$') && (width > 0) && ! suppress )
+    {
+      /* This is a positional argument reference; locate it, (noting
+       * that all scanf() arguments are pointers), then continue with
+       * the remainder of the specification.
+       */
+      va_list argp; va_copy( argp, origin );
+      while( --width > 0 )
+	(void)(va_arg( argp, void * ));
+      arg = va_arg( argp, void * );
+      va_end( argp ); positional = 1;
+
+      if( *++fmt == '*' )
+      { suppress = 1; ++fmt;
+      }
+      while( (*fmt >= '0') && (*fmt <= '9') )
+	width = width * 10 + *fmt++ - '0';
+    }
+
+    /* Interpret any length modifier...
+     */
+    switch( *fmt )
+    {
+      case 'h':
+	length = (*++fmt == 'h') ? (++fmt, PSCANF_LENGTH_CHAR) : PSCANF_LENGTH_SHORT;
+	break;
+
+      case 'l':
+	if( *++fmt == 'l' )
+	{ length = PSCANF_LENGTH_LLONG; ++fmt;
+	}
+	else
+	{ length = PSCANF_LENGTH_LONG; wide = 1;
+	}
+	break;
+
+      case 'q':
+      case 'L':
+	/* For floating point conversions, `L' means long double; for
+	 * integer conversions, (like GNU libc), we take it, and the BSD
+	 * `q', to mean long long, (which `__pscanf_store_int()' takes
+	 * care of, when storing an integer with `L' length).
+	 */
+	length = (*fmt++ == 'L') ? PSCANF_LENGTH_LDOUBLE : PSCANF_LENGTH_LLONG;
+	break;
+
+      case 'j':
+	length = __pscanf_arg_length( intmax_t ); ++fmt;
+	break;
+
+      case 'z':
+	length = __pscanf_arg_length( size_t ); ++fmt;
+	break;
+
+      case 't':
+	length = __pscanf_arg_length( ptrdiff_t ); ++fmt;
+	break;
+
+      case 'I':
+	/* Microsoft's `I64', `I32', and `I', (which is equivalent to
+	 * `z', or `t').
+	 */
+	if( (fmt[1] == '6') && (fmt[2] == '4') )
+	{ length = PSCANF_LENGTH_LLONG; fmt += 3;
+	}
+	else if( (fmt[1] == '3') && (fmt[2] == '2') )
+	{ length = PSCANF_LENGTH_INT; fmt += 3;
+	}
+	else
+	{ length = __pscanf_arg_length( size_t ); ++fmt;
+	}
+	break;
+    }
+    /* The SUSv3 `%C' and `%S' conversions are synonyms for `%lc' and
+     * `%ls' respectively.
+     */
+    if( (*fmt == 'C') || (*fmt == 'S') )
+      wide = 1;
+
+    /* ...and fetch the argument, (unless we already have it, as a
+     * positional reference, or assignment is suppressed).
+     */
+    if( suppress )
+      arg = NULL;
+    else if( ! positional && (*fmt != '\0') )
+      arg = va_arg( argv, void * );
+
+    /* All conversions other than `%[', `%c' and `%n' skip any leading
+     * white space in the input.
+     */
+    if( (*fmt != '[') && (*fmt != 'c') && (*fmt != 'C') && (*fmt != 'n') )
+      if( __pscanf_skip_space( &src ) == PSCANF_EOF )
+	status = EOF;
+
+    if( status != EOF ) switch( *fmt )
+    {
+      case 'd':
+	status = __pscanf_int( &src, 10, width ? width : INT_MAX, 1, &value );
+	goto store_int;
+
+      case 'i':
+	status = __pscanf_int( &src, 0, width ? width : INT_MAX, 1, &value );
+	goto store_int;
+
+      case 'o':
+	status = __pscanf_int( &src, 8, width ? width : INT_MAX, 0, &value );
+	goto store_int;
+
+      case 'u':
+	status = __pscanf_int( &src, 10, width ? width : INT_MAX, 0, &value );
+	goto store_int;
+
+      case 'x':
+      case 'X':
+	status = __pscanf_int( &src, 16, width ? width : INT_MAX, 0, &value );
+
+      store_int:
+	if( (status > 0) && (arg != NULL) )
+	{ __pscanf_store_int( arg, length, value ); ++assigned;
+	}
+	break;
+
+      case 'p':
+	status = __pscanf_int( &src, 16, width ? width : INT_MAX, 0, &value );
+	if( (status > 0) && (arg != NULL) )
+	{ *(void **)(arg) = (void *)(uintptr_t)(value); ++assigned;
+	}
+	break;
+
+      case 'a':
+      case 'A':
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+	status = __pscanf_float( &src, width ? width : INT_MAX, length, arg );
+	if( (status > 0) && (arg != NULL) )
+	  ++assigned;
+	break;
+
+      case 'c':
+      case 'C':
+      case 's':
+      case 'S':
+      case '[':
+	{ /* The string conversions differ only in respect of the set
+	   * of characters which they accept, and whether the result is
+	   * to be NUL terminated.
+	   */
+	  __pscanf_scanset_t set = { 0 }; __pscanf_dest_t dest;
+	  int is_char = (*fmt == 'c') || (*fmt == 'C'), count = 0;
+
+	  if( *fmt == '[' )
+	  {
+	    /* Interpret the scan set; if it isn't properly terminated,
+	     * the entire format specification is invalid, (and we must
+	     * not lose track of `fmt', which is still referenced when
+	     * we leave this conversion).
+	     */
+	    const __pscanf_char_t *close = __pscanf_scanset( fmt + 1, &set );
+	    if( close == NULL )
+	    { status = 0;
+	      break;
+	    }
+	    fmt = close;
+	  }
+	  if( width == 0 )
+	    width = is_char ? 1 : INT_MAX;
+
+	  dest.str = NULL; dest.wcs = NULL;
+	  memset( &dest.state, 0, sizeof( dest.state ) );
+	  if( wide )
+	    dest.wcs = (wchar_t *)(arg);
+	  else
+	    dest.str = (char *)(arg);
+
+	  c = __pscanf_getc( &src );
+	  while( (c != PSCANF_EOF) && (c != PSCANF_NOCHAR) )
+	  {
+	    if( (*fmt == ']') ? ! __pscanf_in_scanset( c, &set )
+		: ! is_char && __pscanf_isspace( c ) )
+	      break;
+	    if( ! __pscanf_store( c, &dest ) )
+	    { status = 0; break;
+	    }
+	    ++count; c = __pscanf_next( &width, &src );
+	  }
+	  __pscanf_ungetc( c, &src );
+
+	  if( (status > 0) && (count == 0) )
+	    status = ((c == PSCANF_EOF) ? EOF : 0);
+	  if( (status > 0) && (arg != NULL) )
+	  {
+	    if( ! is_char )
+	      __pscanf_terminate( &dest );
+	    ++assigned;
+	  }
+	}
+	break;
+
+      case 'n':
+	/* Record the number of characters consumed; this doesn't count
+	 * as a conversion, so it neither completes a conversion, nor is
+	 * it included in the count of assignments.
+	 */
+	if( arg != NULL )
+	  __pscanf_store_int( arg, length, __pscanf_count( &src ) );
+	++fmt;
+	continue;
+
+      default:
+	/* Any other conversion specifier is invalid.
+	 */
+	status = 0;
+    }
+
+    /* Proceed to the next directive, (unless this one failed).
+     */
+    if( status <= 0 )
+      failed = (status == EOF) ? EOF : 1;
+    if( *fmt != '\0' )
+      ++fmt;
+  }
+
+  /* Before returning, we must synchronize any FILE stream with the
+   * input which we have actually consumed...
+   */
+  if( src.file != NULL )
+  {
+#   ifdef _UNICODE
+    if( src.ptr < src.end )
+      ungetwc( *src.ptr, src.file );
+#   else
+    PSCANF_FILE_SYNC( src.file, src.ptr, src.end );
+#   endif
+    __pscanf_lock( src.file, 1 );
+  }
+  va_end( origin );
+
+  /* ...and return EOF, if input failure occurred before any value was
+   * assigned, (which, like GNU libc, we interpret as "before the first
+   * conversion", even if that was an assignment suppressing conversion),
+   * or otherwise the number of assignments made.
+   */
+  return ((failed == EOF) && (assigned == 0)) ? EOF : assigned;
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,72 @@
+#ifndef PSCANF_H
+/*
+ * pscanf.h
+ *
+ * $Id$
+ *
+ * A private header, defining the `pscanf' API; it is to be included
+ * in each compilation unit implementing any of the `scanf' family of
+ * functions, but serves no useful purpose elsewhere.
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#define PSCANF_H
+
+/* We share the compiler compatibility, and function aliasing macros,
+ * which are defined for the `pformat' API.
+ */
+#include <stdarg.h>
+#include "pformat.h"
+
+#include <wchar.h>
+
+/* The following are the declarations specific to the `pscanf' API;
+ * the only flag indicates whether the input source is a FILE stream,
+ * or, (by default), a NUL terminated string.
+ */
+#define PSCANF_FROM_FILE    0x1000
+
+#ifdef __MINGW32__
+ /*
+  * Map MinGW specific function names, for use in place of the generic
+  * implementation defined equivalent function names.
+  */
+# define __pscanf         __mingw_pscanf
+# define __pwscanf        __mingw_pwscanf
+
+# define __vscanf         __mingw_vscanf
+# define __vfscanf        __mingw_vfscanf
+# define __vsscanf        __mingw_vsscanf
+
+# define __vwscanf        __mingw_vwscanf
+# define __vfwscanf       __mingw_vfwscanf
+# define __vswscanf       __mingw_vswscanf
+
+#endif
+
+int __cdecl __pscanf( int, void *, const char *, va_list ) __MINGW_NOTHROW;
+int __cdecl __pwscanf( int, void *, const wchar_t *, va_list ) __MINGW_NOTHROW;
+
+#endif /* !defined PSCANF_H: $RCSfile$$Revision$: end of file */
@@ -1,40 +1,48 @@
-//  By aaronwl 2003-01-28 for mingw-msvcrt
-//  Public domain: all copyrights disclaimed, absolutely no warranties */
-
-#include <stdarg.h>
+/* vfscanf.c
+ *
+ * $Id$
+ *
+ * Provides an implementation of the "vfscanf" function, conforming
+ * generally to C99 and SUSv3/POSIX specifications, for input from a
+ * FILE stream; it is included in libmingwex.a, and is accessible either
+ * as "vfscanf()", (which MSVCRT.DLL does not provide), or directly as
+ * "__mingw_vfscanf()".
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
 #include <stdio.h>
+#include <stdarg.h>
 
-int vfscanf(FILE * __restrict__ stream, const char * __restrict__ format, va_list arg) {
-  int ret;
-
-  __asm__(
-
-    /* allocate stack (esp += frame - arg3 - (8[arg1,2] + 12)) */
-    "movl	%%esp, %%ebx\n\t"
-    "lea	0xFFFFFFEC(%%esp, %6), %%esp\n\t"
-    "subl	%5, %%esp\n\t"
-
-    // set up stack
-    "movl	%1, 0xC(%%esp)\n\t"  // stream
-    "movl	%2, 0x10(%%esp)\n\t"  // format
-    "lea	0x14(%%esp), %%edi\n\t"
-    "movl	%%edi, (%%esp)\n\t"  // memcpy dest
-    "movl	%5, 0x4(%%esp)\n\t"  // memcpy src
-    "movl	%5, 0x8(%%esp)\n\t"
-    "subl	%6, 0x8(%%esp)\n\t"  // memcpy len
-    "call	_memcpy\n\t"
-    "addl	$12, %%esp\n\t"
-
-    // call fscanf
-    "call	_fscanf\n\t"
-
-    // restore stack
-    "movl	%%ebx, %%esp\n\t"
+#include "pscanf.h"
 
-    : "=a"(ret), "=c"(stream), "=d"(format)
-    : "1"(stream), "2"(format), "S"(arg),
-      "a"(&ret)
-    : "ebx", "edi");
+int __cdecl __vfscanf( FILE *, const char *, va_list ) __MINGW_NOTHROW;
+int __cdecl __mingw_alias(vfscanf) ( FILE *, const char *, va_list ) __MINGW_NOTHROW;
 
-  return ret;
+int __cdecl __vfscanf( FILE *stream, const char *fmt, va_list argv )
+{
+  return __pscanf( PSCANF_FROM_FILE, stream, fmt, argv );
 }
+
+/* $RCSfile$$Revision$: end of file */
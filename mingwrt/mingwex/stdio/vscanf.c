@@ -1,9 +1,48 @@
-//  By aaronwl 2003-01-28 for mingw-msvcrt
-//  Public domain: all copyrights disclaimed, absolutely no warranties
-
-#include <stdarg.h>
+/* vscanf.c
+ *
+ * $Id$
+ *
+ * Provides an implementation of the "vscanf" function, conforming
+ * generally to C99 and SUSv3/POSIX specifications, for input from
+ * stdin; it is included in libmingwex.a, and is accessible either as
+ * "vscanf()", (which MSVCRT.DLL does not provide), or directly as
+ * "__mingw_vscanf()".
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
 #include <stdio.h>
+#include <stdarg.h>
 
-int vscanf(const char * __restrict__ format, va_list arg) {
-  return vfscanf(stdin, format, arg);
+#include "pscanf.h"
+
+int __cdecl __vscanf( const char *, va_list ) __MINGW_NOTHROW;
+int __cdecl __mingw_alias(vscanf) ( const char *, va_list ) __MINGW_NOTHROW;
+
+int __cdecl __vscanf( const char *fmt, va_list argv )
+{
+  return __pscanf( PSCANF_FROM_FILE, stdin, fmt, argv );
 }
+
+/* $RCSfile$$Revision$: end of file */
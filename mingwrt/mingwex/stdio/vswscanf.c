@@ -1,43 +1,92 @@
-//  By aaronwl 2003-01-28 for mingw-msvcrt
-//  Public domain: all copyrights disclaimed, absolutely no warranties */
-
-#include <stdarg.h>
+/* vswscanf.c
+ *
+ * $Id$
+ *
+ * Provides an implementation of the "vswscanf" function, conforming
+ * generally to C99 and SUSv3/POSIX specifications, for input from a NUL
+ * terminated wide character string; it is included in libmingwex.a, and
+ * is accessible as "__mingw_vswscanf()".  Also provides "vswscanf()",
+ * (which MSVCRT.DLL does not), with the semantics of MSVCRT.DLL's own
+ * "swscanf()".
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stdio.h>
 #include <wchar.h>
+#include <stdarg.h>
 
+#include "pscanf.h"
 
-int vswscanf(const wchar_t * __restrict__ s, const wchar_t * __restrict__ format,
-  va_list arg) {
+int __cdecl __vswscanf( const wchar_t *, const wchar_t *, va_list ) __MINGW_NOTHROW;
 
-  int ret;
+int __cdecl __vswscanf( const wchar_t *buf, const wchar_t *fmt, va_list argv )
+{
+  return __pwscanf( 0, (void *)(buf), fmt, argv );
+}
+
+/* The standard name, "vswscanf()", is not an alias for the preceding;
+ * since MSVCRT.DLL's swscanf() does not conform to C99, (it takes "%s"
+ * and "%c" to refer to wchar_t, rather than char, data), neither must
+ * "vswscanf()", if it is to remain consistent with swscanf().  Thus,
+ * we simply forward it to swscanf(), copying its argument list onto
+ * the stack.
+ */
+int __cdecl vswscanf( const wchar_t *buf, const wchar_t *fmt, va_list argv )
+{
+  int retval;
 
   __asm__(
 
-    // allocate stack (esp += frame - arg3 - (8[arg1,2] + 12))
+    /* Allocate stack (esp += frame - argv - (8[arg1,2] + 12))...
+     */
     "movl	%%esp, %%ebx\n\t"
     "lea	0xFFFFFFEC(%%esp, %6), %%esp\n\t"
     "subl	%5, %%esp\n\t"
 
-    // set up stack
-    "movl	%1, 0xC(%%esp)\n\t"  // s
-    "movl	%2, 0x10(%%esp)\n\t"  // format
+    /* ...set up the swscanf() call frame...
+     */
+    "movl	%1, 0xC(%%esp)\n\t"	/* buf */
+    "movl	%2, 0x10(%%esp)\n\t"	/* fmt */
     "lea	0x14(%%esp), %%edi\n\t"
-    "movl	%%edi, (%%esp)\n\t"  // memcpy dest
-    "movl	%5, 0x4(%%esp)\n\t"  // memcpy src
+    "movl	%%edi, (%%esp)\n\t"	/* memcpy dest */
+    "movl	%5, 0x4(%%esp)\n\t"	/* memcpy src */
     "movl	%5, 0x8(%%esp)\n\t"
-    "subl	%6, 0x8(%%esp)\n\t"  // memcpy len
+    "subl	%6, 0x8(%%esp)\n\t"	/* memcpy len */
     "call	_memcpy\n\t"
     "addl	$12, %%esp\n\t"
 
-    // call sscanf
+    /* ...call it, and restore the stack.
+     */
     "call	_swscanf\n\t"
-
-    // restore stack
     "movl	%%ebx, %%esp\n\t"
 
-    : "=a"(ret), "=c"(s), "=d"(format)
-    : "1"(s), "2"(format), "S"(arg),
-      "a"(&ret)
+    : "=a"(retval), "=c"(buf), "=d"(fmt)
+    : "1"(buf), "2"(fmt), "S"(argv), "a"(&retval)
     : "ebx", "edi");
 
-  return ret;
+  return retval;
 }
+
+/* $RCSfile$$Revision$: end of file */
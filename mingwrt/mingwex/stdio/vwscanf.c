@@ -1,10 +1,56 @@
-//  By aaronwl 2003-01-28 for mingw-msvcrt.
-//  Public domain: all copyrights disclaimed, absolutely no warranties.
-
-#include <stdarg.h>
-#include <wchar.h>
+/* vwscanf.c
+ *
+ * $Id$
+ *
+ * Provides an implementation of the "vwscanf" function, conforming
+ * generally to C99 and SUSv3/POSIX specifications, for wide character
+ * input from stdin; it is included in libmingwex.a, and is accessible
+ * as "__mingw_vwscanf()".  Also provides "vwscanf()", (which MSVCRT.DLL
+ * does not), with the semantics of MSVCRT.DLL's own "wscanf()".
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
 #include <stdio.h>
+#include <wchar.h>
+#include <stdarg.h>
 
-int vwscanf(const wchar_t * __restrict__ format, va_list arg) {
-  return vfwscanf(stdin, format, arg);
+#include "pscanf.h"
+
+int __cdecl __vwscanf( const wchar_t *, va_list ) __MINGW_NOTHROW;
+
+int __cdecl __vwscanf( const wchar_t *fmt, va_list argv )
+{
+  return __pwscanf( PSCANF_FROM_FILE, stdin, fmt, argv );
 }
+
+/* Like vfwscanf(), the standard name, "vwscanf()", retains Microsoft's
+ * non-conforming semantics; (see vfwscanf.c).
+ */
+int __cdecl vwscanf( const wchar_t *fmt, va_list argv )
+{
+  return vfwscanf( stdin, fmt, argv );
+}
+
+/* $RCSfile$$Revision$: end of file */
@@ -2,7 +2,8 @@
  *
  *
  * Tree search generalized from Knuth (6.2.2) Algorithm T just like
- * the AT&T man page says; tdelete based on Knuth's Algorithm D.
+ * the AT&T man page says; tdelete based on Knuth's Algorithm D, with
+ * subsequent red-black tree rebalancing.
  *
  * Written by reading the System V Interface Definition, not the code.
  *
@@ -21,41 +22,129 @@ __CRT_ALIAS void *__tdelete
    * for private use within this implementation; for public consumption,
    * it becomes an alias for "void".
    */
-  int cmp;
-  node_t *p, *q, *r;
+  int cmp, depth = 0, zdepth, red;
+  node_t *p, *q, *r, *path[TNODE_PATH_MAX + 1]; int dir[TNODE_PATH_MAX + 1];
 
   if( (rootp == NULL) || ((p = *rootp) == NULL) || (compar == NULL) )
     return NULL;
 
-  while( (cmp = (*compar)(key, (*rootp)->key)) != 0 )
+  while( (cmp = (*compar)(key, p->key)) != 0 )
   {
-    rootp = (cmp < 0)
-      ? &(p = *rootp)->llink		/* follow llink branch */
-      : &(p = *rootp)->rlink;		/* follow rlink branch */
-
-    if (*rootp == NULL)
+    path[depth] = p;			/* record the path followed */
+    if( (p = tnode_child( p, dir[depth++] = (cmp > 0) )) == NULL )
       return NULL;			/* key not found */
   }
-  r = (*rootp)->rlink;			/* D1: */
-  if( (q = (*rootp)->llink) == NULL )	/* Left NULL? */
-    q = r;
-  else if( r != NULL ) 			/* Right link is NULL? */
-  { if( r->llink == NULL ) 		/* D2: Find successor */
-    { r->llink = q;
-      q = r;
+  zdepth = depth;			/* "p" is to be deleted */
+  red = tnode_is_red( p );
+
+  if( ((q = tnode_child( p, TNODE_LEFT )) == NULL)	/* D1: */
+  ||  ((r = p->rlink) == NULL)  )	/* Left or right NULL? */
+  {
+    /* The deleted node has at most one child, which simply replaces it.
+     */
+    if( q == NULL )
+      q = p->rlink;
+    if( depth > 0 )
+      tnode_set_child( path[depth - 1], dir[depth - 1], q );
+    else
+      *rootp = q;
+  }
+  else
+  { /* D2, D3: Find the successor, which has no left child, extending
+     * the recorded path to reach it; it will be relinked to replace
+     * the deleted node, adopting its colour, such that it is actually
+     * the successor's original position which is vacated.
+     */
+    path[depth] = p; dir[depth++] = TNODE_RIGHT;
+    while( (q = tnode_child( r, TNODE_LEFT )) != NULL )
+    { path[depth] = r; dir[depth++] = TNODE_LEFT;
+      r = q;
+    }
+    q = r->rlink;
+    if( depth - 1 > zdepth )
+    { /* The successor is not the immediate right child of the deleted
+       * node; its right subtree replaces it, and it adopts the deleted
+       * node's right subtree in its place.
+       */
+      tnode_set_child( path[depth - 1], TNODE_LEFT, q );
+      r->rlink = p->rlink;
     }
-    else				/* D3: Find NULL link */
+    red = tnode_is_red( r );
+    r->llink = p->llink;		/* copies colour, with llink */
+    path[zdepth] = r;			/* "r" takes the place of "p" */
+    if( zdepth > 0 )
+      tnode_set_child( path[zdepth - 1], dir[zdepth - 1], r );
+    else
+      *rootp = r;
+  }
+  r = (zdepth > 0) ? path[zdepth - 1] : NULL;
+  free( p );				/* D4: Free node */
+
+  if( ! red )
+  {
+    /* The vacated position was black; the path through it is now one
+     * black node short, so we must rebalance, working upwards along
+     * the recorded path.
+     */
+    while( (depth > 0) && ! tnode_is_red( q ) )
     {
-      for( q = r->llink; q->llink != NULL; q = r->llink )
-	r = q;
-      r->llink = q->rlink;
-      q->llink = (*rootp)->llink;
-      q->rlink = (*rootp)->rlink;
+      node_t *parent = path[depth - 1], *top;
+      int side = dir[depth - 1];
+      node_t *sibling = tnode_child( parent, ! side );
+
+      if( tnode_is_red( sibling ) )
+      { /* The sibling is red; rotate it above the parent, to obtain
+	 * a black sibling, inserting it into the recorded path.
+	 */
+	tnode_set_black( sibling ); tnode_set_red( parent );
+	top = tnode_rotate( parent, side );
+	if( depth > 1 )
+	  tnode_set_child( path[depth - 2], dir[depth - 2], top );
+	else
+	  *rootp = top;
+	path[depth - 1] = top; dir[depth - 1] = side;
+	path[depth] = parent; dir[depth++] = side;
+	sibling = tnode_child( parent, ! side );
+      }
+      if( ! tnode_is_red( tnode_child( sibling, TNODE_LEFT ) )
+      &&  ! tnode_is_red( tnode_child( sibling, TNODE_RIGHT ) )  )
+      { /* The sibling has no red children; make it red, and push the
+	 * black deficit upwards, to the parent.
+	 */
+	tnode_set_red( sibling );
+	q = parent; --depth;
+      }
+      else
+      { /* The sibling has at least one red child; ensure that it is
+	 * the outer child, then rotate the sibling above the parent,
+	 * recolouring such that the deficit is eliminated.
+	 */
+	if( ! tnode_is_red( tnode_child( sibling, ! side ) ) )
+	{ tnode_set_black( tnode_child( sibling, side ) );
+	  tnode_set_red( sibling );
+	  sibling = tnode_rotate( sibling, ! side );
+	  tnode_set_child( parent, ! side, sibling );
+	}
+	if( tnode_is_red( parent ) ) tnode_set_red( sibling );
+	else tnode_set_black( sibling );
+	tnode_set_black( parent );
+	tnode_set_black( tnode_child( sibling, ! side ) );
+	top = tnode_rotate( parent, side );
+	if( depth > 1 )
+	  tnode_set_child( path[depth - 2], dir[depth - 2], top );
+	else
+	  *rootp = top;
+	q = NULL;
+	break;
+      }
     }
+    if( q != NULL )
+      tnode_set_black( q );
   }
-  free(*rootp);				/* D4: Free node */
-  *rootp = q;				/* link parent to new node */
-  return p;
+  /* Return a reference to the parent of the deleted node, or, if
+   * the root node was deleted, some other arbitrary non-NULL value.
+   */
+  return (r != NULL) ? r : (void *)(rootp);
 }
 
 void *tdelete
@@ -26,15 +26,14 @@ __CRT_ALIAS void *__tfind
   if( (rootp == NULL) || (compar == NULL) )
     return NULL;
 
-  while (*rootp != NULL)	/* Knuth's T1: */
+  node_t *p = *rootp;
+  while (p != NULL)		/* Knuth's T1: */
   {
     int cmp;			/* T2: */
-    if( (cmp = (*compar)(key, (*rootp)->key)) == 0 )
-      return *rootp;		/* key found */
+    if( (cmp = (*compar)(key, p->key)) == 0 )
+      return p;			/* key found */
 
-    rootp = (cmp < 0)
-      ? &(*rootp)->llink	/* T3: follow left branch */
-      : &(*rootp)->rlink; 	/* T4: follow right branch */
+    p = tnode_child (p, cmp > 0);	/* T3, T4: follow branch */
   }
   return NULL;			/* key not found */
 }
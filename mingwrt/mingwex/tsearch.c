@@ -2,7 +2,9 @@
  *
  *
  * Tree search generalized from Knuth (6.2.2) Algorithm T just like
- * the AT&T man page says.
+ * the AT&T man page says; insertion is followed by red-black tree
+ * rebalancing, (after Guibas and Sedgewick), to ensure that search
+ * paths remain logarithmic, regardless of the order of insertion.
  *
  * Written by reading the System V Interface Definition, not the code.
  *
@@ -22,7 +24,7 @@ __CRT_ALIAS void *__tsearch
    * for private use within this implementation; for public consumption,
    * it becomes an alias for "void".
    */
-  node_t *q;
+  node_t *q, *path[TNODE_PATH_MAX]; int dir[TNODE_PATH_MAX], depth = 0;
 
   /* Cannot search from an invalid tree reference pointer, or without a
    * valid comparator function reference.
@@ -30,24 +32,74 @@ __CRT_ALIAS void *__tsearch
   if( (rootp == NULL) || (compar == NULL) )
     return NULL;
 
-  while( *rootp != NULL )		/* Knuth's T1: */
+  q = *rootp;
+  while( q != NULL )			/* Knuth's T1: */
   {
     int cmp;				/* T2: */
-    if( (cmp = (*compar)(key, (*rootp)->key)) == 0 )
-      return *rootp;			/* we found it! */
+    if( (cmp = (*compar)(key, q->key)) == 0 )
+      return q;				/* we found it! */
 
-    rootp = (cmp < 0)
-      ? &(*rootp)->llink		/* T3: follow left branch */
-      : &(*rootp)->rlink;		/* T4: follow right branch */
-  }
+    path[depth] = q;			/* record the path followed */
+    q = tnode_child( q, dir[depth++] = (cmp > 0) );
+  }					/* T3, T4: follow a branch */
 
   q = malloc( sizeof(node_t) );		/* T5: key not found */
-  if( q != NULL )			/* make new node */
+  if( q == NULL )			/* make new node */
+    return NULL;
+
+  q->key = key;				/* initialize new node */
+  q->llink = q->rlink = NULL;
+
+  if( depth == 0 )
+  { *rootp = q;				/* it is the first node; it */
+    return q;				/* must remain black */
+  }
+  tnode_set_red( q );			/* otherwise, it is red, and */
+  tnode_set_child( path[depth - 1], dir[depth - 1], q );
+
+  /* Insertion of a red node may have placed it as the child of another
+   * red node, in violation of the red-black tree constraints; restore
+   * them, working upwards along the recorded path, (noting that, since
+   * the root is always black, any red parent cannot be the root, so it
+   * must have a parent of its own).
+   */
+  while( (depth > 1) && tnode_is_red( path[depth - 1] ) )
   {
-    *rootp = q;				/* link new node to old */
-    q->key = key;			/* initialize new node */
-    q->llink = q->rlink = NULL;
+    node_t *parent = path[depth - 1], *grandparent = path[depth - 2];
+    int side = dir[depth - 2];
+    node_t *uncle = tnode_child( grandparent, ! side );
+
+    if( tnode_is_red( uncle ) )
+    { /* Both the parent and its sibling are red; make both of them
+       * black, and push the red colour up to the grandparent, which
+       * must then be checked in its turn.
+       */
+      tnode_set_black( parent ); tnode_set_black( uncle );
+      tnode_set_red( grandparent );
+      depth -= 2;
+    }
+    else
+    { /* The parent's sibling is black; if the new node is an inner
+       * grandchild, first rotate it to the outside...
+       */
+      if( dir[depth - 1] != side )
+      { parent = tnode_rotate( parent, side );
+	tnode_set_child( grandparent, side, parent );
+      }
+      /* ...then rotate the grandparent away from the red pair, such
+       * that their common parent rises to replace it, recolouring to
+       * restore the constraints; no further adjustment is needed.
+       */
+      tnode_set_black( parent ); tnode_set_red( grandparent );
+      parent = tnode_rotate( grandparent, ! side );
+      if( depth > 2 )
+	tnode_set_child( path[depth - 3], dir[depth - 3], parent );
+      else
+	*rootp = parent;
+      break;
+    }
   }
+  tnode_set_black( *rootp );		/* the root is always black */
   return q;
 }
 
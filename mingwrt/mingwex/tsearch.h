@@ -8,7 +8,7 @@
  * $Id$
  *
  * Written Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2022, MinGW.OSDN Project.
+ * Copyright (C) 2022, 2026, MinGW.OSDN Project.
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -45,6 +45,9 @@
 #define __MINGW_ATTRIB_NONNULL(ARG_INDEX)  /* NOTHING */
 
 #include <search.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
 
 /* In addition to the public API declarations from <search.h>, each of
  * the tsearch(), tfind(), tdelete(), and twalk() implementations needs
@@ -56,4 +59,67 @@ struct node
   struct node 	*llink, *rlink;
 } node_t;
 
+/* The trees are maintained as red-black trees, to guarantee that their
+ * height remains proportional to the logarithm of the number of nodes,
+ * regardless of the order in which keys are inserted.  Since node_t is
+ * always allocated by malloc(), its address is aligned to at least an
+ * eight byte boundary, so the least significant bit of any node address
+ * is always zero; to avoid any increase in node size, we use this bit,
+ * within each node's "llink" field, to record the colour of that node.
+ * Thus, "llink" must NEVER be accessed directly, but only by way of the
+ * following helpers, which preserve, or manipulate, the colour bit as
+ * appropriate.
+ */
+#define TNODE_RED	((uintptr_t)(1))
+
+/* Nodes are visited by descending from the root, recording each node
+ * traversed, so that the tree may subsequently be rebalanced from the
+ * bottom up; the height of a red-black tree of N nodes cannot exceed
+ * 2 * log2(N + 1), and N cannot exceed the number of distinct nodes
+ * which may be addressed, so this is a sufficient path depth limit.
+ */
+#define TNODE_PATH_MAX	(2 * CHAR_BIT * sizeof( void * ) + 1)
+
+/* Each node has a pair of children, which may be identified by index;
+ * a zero index selects "llink", while one selects "rlink".
+ */
+#define TNODE_LEFT	0
+#define TNODE_RIGHT	1
+
+__CRT_ALIAS
+node_t *tnode_child( const node_t *p, int dir )
+{ return dir ? p->rlink : (node_t *)((uintptr_t)(p->llink) & ~TNODE_RED); }
+
+__CRT_ALIAS
+void tnode_set_child( node_t *p, int dir, node_t *q )
+{ if( dir ) p->rlink = q;
+  else p->llink = (node_t *)((uintptr_t)(q) | ((uintptr_t)(p->llink) & TNODE_RED));
+}
+
+__CRT_ALIAS
+int tnode_is_red( const node_t *p )
+{ return (p != NULL) && ((uintptr_t)(p->llink) & TNODE_RED); }
+
+__CRT_ALIAS
+void tnode_set_red( node_t *p )
+{ p->llink = (node_t *)((uintptr_t)(p->llink) | TNODE_RED); }
+
+__CRT_ALIAS
+void tnode_set_black( node_t *p )
+{ p->llink = (node_t *)((uintptr_t)(p->llink) & ~TNODE_RED); }
+
+__CRT_ALIAS
+node_t *tnode_rotate( node_t *p, int dir )
+{
+  /* Rotate the subtree rooted at "p", such that "p" descends towards
+   * its "dir" side, while its child on the opposite side ascends, to
+   * become the new subtree root, (which is returned); the colour of
+   * each node remains unchanged.
+   */
+  node_t *q = tnode_child( p, ! dir );
+  tnode_set_child( p, ! dir, tnode_child( q, dir ) );
+  tnode_set_child( q, dir, p );
+  return q;
+}
+
 /* $RCSfile$: end of file */
@@ -22,13 +22,14 @@ static void trecurse
    * action as each node is traversed, and as appropriate for each
    * phase of traversal.
    */
-  if( (root->llink == NULL) && (root->rlink == NULL) )
+  const node_t *llink = tnode_child (root, TNODE_LEFT);
+  if( (llink == NULL) && (root->rlink == NULL) )
     (*action) (root, leaf, level);
 
   else
   { (*action) (root, preorder, level);
-    if( root->llink != NULL )
-      trecurse (root->llink, action, level + 1);
+    if( llink != NULL )
+      trecurse (llink, action, level + 1);
     (*action) (root, postorder, level);
     if( root->rlink != NULL)
       trecurse (root->rlink, action, level + 1);
@@ -0,0 +1,327 @@
+/*
+ * utfconv.c
+ *
+ * Implementation of direct transcoding, between UTF-16 and each of UTF-8,
+ * and ISO-8859-1, (Latin-1), for use by the ISO-C99 wcsrtombs(), wcrtomb(),
+ * mbsrtowcs(), and mbrtowc() family of functions, when the active code page
+ * is any of CP_UTF8, 28591, or the "C" locale's pseudo code page zero.
+ *
+ * Each conversion is performed in a single pass, which stores, and counts,
+ * each converted code point at once; runs of ASCII, (or Latin-1), units,
+ * and the validation of surrogate pairs, are processed in blocks of sixteen
+ * bytes, when SSE2 is available; otherwise, one code point at a time.
+ *
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include "utfconv.h"
+
+#if defined __i386__ || defined __x86_64__
+/* SSE2 block processing is available, on any host which may support it,
+ * but the functions which use it must be compiled for SSE2, (and nothing
+ * else may be); since their callers, when compiled for i386, need not
+ * have aligned the stack, they must also realign it.
+ */
+#include <emmintrin.h>
+
+#define UTFCONV_HAVE_SSE2  1
+#define SSE2_FUNCTION	__attribute__((__target__ ("sse2"), __force_align_arg_pointer__))
+
+/* All SSE2 block loads are aligned; thus, although they may read beyond
+ * the terminating NUL of an unbounded input, they can never cross into
+ * another page, so cannot fault.
+ */
+#define UTFCONV_ALIGNED(p)  (((uintptr_t)(p) & 15) == 0)
+
+static SSE2_FUNCTION
+size_t utfconv_narrow_sse2
+( char *dst, const uint16_t *src, size_t max, unsigned int mask )
+{ /* Convert whole blocks of eight UTF-16 units, from src, (which must be
+   * 16-byte aligned), to one byte each, at dst, (unless NULL), for each
+   * block in which no unit is NUL, and none has any bit in common with
+   * mask, (0xFF80 for ASCII, or 0xFF00 for Latin-1); no more than max
+   * units are converted.  Returns the number of units converted.
+   */
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bits = _mm_set1_epi16( (short)(mask) );
+  size_t done = 0;
+
+  while( (max - done) >= 8 )
+  { __m128i v = _mm_load_si128( (const __m128i *)(src + done) );
+    __m128i ok = _mm_andnot_si128( _mm_cmpeq_epi16( v, zero ),
+	_mm_cmpeq_epi16( _mm_and_si128( v, bits ), zero )
+      );
+    if( _mm_movemask_epi8( ok ) != 0xFFFF )
+      break;
+    if( dst != NULL )
+      _mm_storel_epi64( (__m128i *)(dst + done), _mm_packus_epi16( v, v ) );
+    done += 8;
+  }
+  return done;
+}
+
+static SSE2_FUNCTION
+size_t utfconv_utf8_count_sse2( const uint16_t *src, size_t max, size_t *bytes )
+{ /* Count the UTF-8 encoded length of whole blocks of eight UTF-16 units,
+   * from src, (which must be 16-byte aligned), adding it to *bytes, for
+   * each block which contains no NUL, and in which each high surrogate
+   * is immediately followed by a low surrogate, and each low surrogate
+   * is immediately preceded by a high surrogate; no more than max units
+   * are counted.  Returns the number of units counted.
+   */
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i m80 = _mm_set1_epi16( (short)(0xFF80) );
+  const __m128i m800 = _mm_set1_epi16( (short)(0xF800) );
+  const __m128i mfc00 = _mm_set1_epi16( (short)(0xFC00) );
+  const __m128i high = _mm_set1_epi16( (short)(0xD800) );
+  const __m128i low = _mm_set1_epi16( (short)(0xDC00) );
+  __m128i total = zero; uint64_t sum[2];
+  size_t done = 0;
+
+  while( (max - done) >= 8 )
+  { __m128i v = _mm_load_si128( (const __m128i *)(src + done) );
+    __m128i hs = _mm_cmpeq_epi16( _mm_and_si128( v, mfc00 ), high );
+    __m128i ls = _mm_cmpeq_epi16( _mm_and_si128( v, mfc00 ), low );
+    unsigned int hmask = _mm_movemask_epi8( hs );
+    unsigned int lmask = _mm_movemask_epi8( ls );
+
+    /* The movemask results carry two bits for each unit, so a valid
+     * block has its low surrogate mask equal to its high surrogate
+     * mask, shifted by one unit; (this also rejects a high surrogate
+     * in the final unit, which must be paired within the next block,
+     * and a low surrogate in the first, which may have been paired
+     * within the preceding block; such blocks are left for scalar
+     * processing).
+     */
+    if( (_mm_movemask_epi8( _mm_cmpeq_epi16( v, zero ) ) != 0)
+    ||  (lmask != ((hmask << 2) & 0xFFFF)) || ((hmask & 0xC000) != 0)  )
+      break;
+
+    /* Each unit encodes to three bytes, less one if it is below 0x800,
+     * less another if it is below 0x80, and less one if it is either of
+     * a surrogate pair, which together encode to four bytes; since each
+     * comparison yields minus one, where it holds, we add their results
+     * to three, then sum the eight byte counts.
+     */
+    v = _mm_add_epi16( _mm_set1_epi16( 3 ),
+	_mm_add_epi16( _mm_add_epi16( hs, ls ),
+	  _mm_add_epi16( _mm_cmpeq_epi16( _mm_and_si128( v, m80 ), zero ),
+	    _mm_cmpeq_epi16( _mm_and_si128( v, m800 ), zero )
+	  )
+	)
+      );
+    total = _mm_add_epi64( total, _mm_sad_epu8( v, zero ) );
+    done += 8;
+  }
+  _mm_storeu_si128( (__m128i *)(sum), total );
+  *bytes += (size_t)(sum[0] + sum[1]);
+  return done;
+}
+
+static SSE2_FUNCTION
+size_t utfconv_widen_sse2
+( uint16_t *dst, const unsigned char *src, size_t max, int latin1 )
+{ /* Convert whole blocks of sixteen bytes, from src, (which must be
+   * 16-byte aligned), to one UTF-16 unit each, at dst, (unless NULL),
+   * for each block in which no byte is NUL, and, unless latin1 is
+   * non-zero, none has its high bit set; no more than max bytes are
+   * converted.  Returns the number of bytes converted.
+   */
+  const __m128i zero = _mm_setzero_si128();
+  size_t done = 0;
+
+  while( (max - done) >= 16 )
+  { __m128i v = _mm_load_si128( (const __m128i *)(src + done) );
+    if( (_mm_movemask_epi8( _mm_cmpeq_epi8( v, zero ) ) != 0)
+    ||  ((latin1 == 0) && (_mm_movemask_epi8( v ) != 0))  )
+      break;
+    if( dst != NULL )
+    { _mm_storeu_si128( (__m128i *)(dst + done), _mm_unpacklo_epi8( v, zero ) );
+      _mm_storeu_si128( (__m128i *)(dst + done + 8), _mm_unpackhi_epi8( v, zero ) );
+    }
+    done += 16;
+  }
+  return done;
+}
+#endif
+
+size_t __mingw_utfconv_encode
+( char *dst, size_t dstlen, const uint16_t **src, size_t srclen, int flags,
+  int *status
+)
+{ /* Convert UTF-16 to UTF-8, or to Latin-1; see utfconv.h
+   */
+  const uint16_t *s = *src;
+  size_t count = 0, left = srclen;
+
+  if( dst == NULL ) dstlen = (size_t)(-1);
+  for( *status = UTFCONV_END; left > 0; )
+  { uint32_t c; size_t need, units = 1;
+
+#ifdef UTFCONV_HAVE_SSE2
+    if( ((flags & UTFCONV_SSE2) != 0) && UTFCONV_ALIGNED( s ) )
+    { /* Process as many whole blocks as possible, at once; blocks which
+       * may not be so processed fall through, to be processed one code
+       * point at a time, until we are once again aligned.
+       */
+      size_t done;
+      if( ((flags & UTFCONV_UTF8) != 0) && (dst == NULL) )
+	done = utfconv_utf8_count_sse2( s, left, &count );
+
+      else
+      { size_t room = dstlen - count;
+	done = utfconv_narrow_sse2( (dst == NULL) ? NULL : dst + count, s,
+	    (left < room) ? left : room, (flags & UTFCONV_UTF8) ? 0xFF80 : 0xFF00
+	  );
+	count += done;
+      }
+      if( done > 0 )
+      { s += done; left -= done;
+	continue;
+      }
+    }
+#endif
+    if( (c = *s) < 0x80 ) need = 1;
+    else if( (flags & UTFCONV_UTF8) == 0 )
+    { /* Latin-1 represents only the first 256 code points, directly.
+       */
+      if( c > 0xFF ) { *status = UTFCONV_EILSEQ; break; }
+      need = 1;
+    }
+    else if( c < 0x800 ) need = 2;
+    else if( (c & 0xFC00) == 0xD800 )
+    { /* A high surrogate is valid, only if immediately followed by a low
+       * surrogate; (when the input is unbounded, there is always at least
+       * one more unit, even if only the terminating NUL).
+       */
+      if( (left < 2) || ((s[1] & 0xFC00) != 0xDC00) )
+      { *status = UTFCONV_EILSEQ; break; }
+      c = 0x10000 + ((c - 0xD800) << 10) + (s[1] - 0xDC00);
+      need = 4; units = 2;
+    }
+    else if( (c & 0xFC00) == 0xDC00 ) { *status = UTFCONV_EILSEQ; break; }
+    else need = 3;
+
+    if( (dstlen - count) < need ) { *status = UTFCONV_FULL; break; }
+    if( dst != NULL )
+    { char *p = dst + count;
+      switch( need )
+      { case 1: p[0] = (char)(c);
+		break;
+	case 2: p[0] = (char)(0xC0 | (c >> 6));
+		p[1] = (char)(0x80 | (c & 0x3F));
+		break;
+	case 3: p[0] = (char)(0xE0 | (c >> 12));
+		p[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+		p[2] = (char)(0x80 | (c & 0x3F));
+		break;
+	case 4: p[0] = (char)(0xF0 | (c >> 18));
+		p[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+		p[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+		p[3] = (char)(0x80 | (c & 0x3F));
+      }
+    }
+    count += need; s += units; left -= units;
+    if( c == 0 ) { *status = UTFCONV_NUL; break; }
+  }
+  *src = s;
+  return count;
+}
+
+size_t __mingw_utfconv_decode
+( uint16_t *dst, size_t dstlen, const char **src, size_t srclen, int flags,
+  int *status
+)
+{ /* Convert UTF-8, or Latin-1, to UTF-16; see utfconv.h
+   */
+  const unsigned char *s = (const unsigned char *)(*src);
+  size_t count = 0, left = srclen;
+
+  if( dst == NULL ) dstlen = (size_t)(-1);
+  for( *status = UTFCONV_END; left > 0; )
+  { uint32_t c; size_t len = 1, need = 1;
+
+#ifdef UTFCONV_HAVE_SSE2
+    if( ((flags & UTFCONV_SSE2) != 0) && UTFCONV_ALIGNED( s ) )
+    { size_t done, room = dstlen - count;
+      done = utfconv_widen_sse2( (dst == NULL) ? NULL : dst + count, s,
+	  (left < room) ? left : room, (flags & UTFCONV_UTF8) == 0
+	);
+      if( done > 0 )
+      { s += done; left -= done; count += done;
+	continue;
+      }
+    }
+#endif
+    if( ((c = *s) >= 0x80) && ((flags & UTFCONV_UTF8) != 0) )
+    { /* This is the lead byte of a UTF-8 multibyte sequence; identify
+       * the sequence length, and the range within which its second byte
+       * must lie, to exclude overlong encodings, encoded surrogates, and
+       * code points beyond U+10FFFF...
+       */
+      unsigned char lo = 0x80, hi = 0xBF; size_t i;
+      if( c < 0xC2 ) { *status = UTFCONV_EILSEQ; break; }
+      else if( c < 0xE0 ) { len = 2; c &= 0x1F; }
+      else if( c < 0xF0 )
+      { len = 3; c &= 0x0F;
+	if( c == 0x00 ) lo = 0xA0; else if( c == 0x0D ) hi = 0x9F;
+      }
+      else if( c < 0xF5 )
+      { len = 4; need = 2; c &= 0x07;
+	if( c == 0x00 ) lo = 0x90; else if( c == 0x04 ) hi = 0x8F;
+      }
+      else { *status = UTFCONV_EILSEQ; break; }
+
+      /* ...then accumulate the code point from its continuation bytes;
+       * (checking each in turn ensures that we never read beyond a NUL,
+       * which is never a valid continuation byte).
+       */
+      if( left < len ) { *status = UTFCONV_EILSEQ; break; }
+      for( i = 1; i < len; i++ )
+      { if( (s[i] < lo) || (s[i] > hi) ) break;
+	c = (c << 6) | (s[i] & 0x3F);
+	lo = 0x80; hi = 0xBF;
+      }
+      if( i < len ) { *status = UTFCONV_EILSEQ; break; }
+    }
+    if( (dstlen - count) < need ) { *status = UTFCONV_FULL; break; }
+    if( dst != NULL )
+    { if( need == 1 ) dst[count] = (uint16_t)(c);
+      else
+      { dst[count] = (uint16_t)(0xD800 + ((c - 0x10000) >> 10));
+	dst[count + 1] = (uint16_t)(0xDC00 + (c & 0x3FF));
+      }
+    }
+    count += need; s += len; left -= len;
+    if( c == 0 ) { *status = UTFCONV_NUL; break; }
+  }
+  *src = (const char *)(s);
+  return count;
+}
+
+/* $RCSfile$: end of file */
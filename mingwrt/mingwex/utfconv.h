@@ -0,0 +1,89 @@
+/*
+ * utfconv.h
+ *
+ * Private header, declaring the transcoding functions which convert
+ * between UTF-16, (as represented by MS-Windows wchar_t), and each of
+ * UTF-8, or ISO-8859-1, (Latin-1), directly, without recourse to the
+ * WideCharToMultiByte(), or MultiByteToWideChar() APIs; (it depends on
+ * no more than <stddef.h> and <stdint.h>, so that it may be used, and
+ * the functions it declares may be checked, on any host).
+ *
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+/* Flags, to specify the multibyte encoding, and whether the SSE2 code
+ * paths may be used, (which the caller must have confirmed, for i386).
+ */
+#define UTFCONV_LATIN1	0
+#define UTFCONV_UTF8	1
+#define UTFCONV_SSE2	2
+
+/* Status codes, to indicate why a conversion stopped:
+ *
+ *   UTFCONV_NUL	The terminating NUL has been converted, and
+ *   			included in the returned count.
+ *
+ *   UTFCONV_END	The specified input length was exhausted.
+ *
+ *   UTFCONV_FULL	The output buffer cannot accommodate the
+ *   			conversion of the next code point.
+ *
+ *   UTFCONV_EILSEQ	The next input code point is invalid, or it
+ *   			has no representation in the output encoding.
+ *
+ * In each case, the input pointer is left referring to the first unit
+ * which was not converted, (or beyond the NUL, for UTFCONV_NUL).
+ */
+#define UTFCONV_NUL	0
+#define UTFCONV_END	1
+#define UTFCONV_FULL	2
+#define UTFCONV_EILSEQ	3
+
+/* Convert UTF-16 to UTF-8, or Latin-1, (as specified by flags), from
+ * at most srclen units, (or unbounded, if (size_t)(-1)), at *src, to
+ * at most dstlen bytes at dst; if dst is NULL, dstlen is ignored, and
+ * the converted bytes are counted, but not stored.  Returns the count
+ * of bytes, (which would be), stored, with the reason for stopping in
+ * *status; a code point is never partially stored.
+ */
+size_t __mingw_utfconv_encode
+(char *, size_t, const uint16_t **, size_t, int, int *);
+
+/* Convert UTF-8, or Latin-1, to UTF-16, from at most srclen bytes at
+ * *src, to at most dstlen units at dst; otherwise, exactly analogous
+ * to __mingw_utfconv_encode(), (noting that a code point which needs
+ * a surrogate pair is never partially stored, and that any truncated
+ * UTF-8 sequence, at the end of a bounded input, is invalid).
+ */
+size_t __mingw_utfconv_decode
+(uint16_t *, size_t, const char **, size_t, int, int *);
+
+/* $RCSfile$: end of file */
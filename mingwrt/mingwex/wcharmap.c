@@ -8,7 +8,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2019, 2020, 2022, MinGW.OSDN Project
+ * Copyright (C) 2019, 2020, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -33,10 +33,6 @@
  */
 #include "wcharmap.h"
 
-/* We need a definition of macro UCHAR_MAX; it is defined in <limits.h>
- */
-#include <limits.h>
-
 /* The working codeset, and its associated effective MB_CUR_MAX,
  * are stored with file-scope visibility, to facilitate passing
  * them to individual elements of the implementation...
@@ -94,103 +90,49 @@ size_t __mingw_wctomb_convert
    */
   size_t retval; int eilseq_flag = 0, *eilseq_ptr = NULL;
 
-  if( codeset == 0 )
+  if( (codeset == 0) || __mingw_utfconv_codeset( codeset ) )
   { /* Code page zero is assumed to represent the encoding which applies
      * within the "C" locale; this is a single-byte encoding, with wchar
      * values in the range L'\0'..L'\255' mapped to their identical byte
-     * values, and all greater wchar values considered to be invalid.
-     *
-     * Simply scan, count, and optionally store valid byte values,
-     * starting from an initial count of zero.
+     * values, and all greater wchar values considered to be invalid;
+     * this is identical to the ISO-8859-1 encoding, which, like UTF-8,
+     * we may encode directly, scanning, counting, and optionally storing
+     * the encoded bytes, in a single pass.
      */
-    retval = 0;
-
-    if( (size_t)(wclen) == (size_t)(-1) )
-      do { /* This is an unbounded scan; simply check that each
-	    * successive wchar lies in the valid range...
-	    */
-	   if( (unsigned)(*wcs) > UCHAR_MAX )
-	     /* ...otherwise, report an invalid encoding, and
-	      * bail out.
-	      */
-	     return errout( EILSEQ, wclen );
-
-	   /* We got a valid input wchar...
-	    */
-	   if( mbs != NULL )
-	   { /* ...which we are now expected to store...
-	      */
-	     if( mblen-- > 0 ) *mbs++ = (unsigned char)(*wcs);
-
-	     /* ...but, we must bail out, if there is no
-	      * space left in the encoding buffer.
-	      */
-	     else return errout( ENOMEM, (size_t)(-1) );
-	   }
-
-	   /* We've accepted the current input wchar; count
-	    * it, and then, provided it isn't the terminating
-	    * NUL, move on to the next.
-	    */
-	   ++retval;
-	 } while( *wcs++ != L'\0' );
-
-    else while( wclen-- > 0 )
-    { /* This is a bounded scan; as in the unbounded case, take
-       * each input wchar in turn, and verify that each lies in
-       * the valid encoding range.
-       */
-      if( (unsigned)(*wcs) > UCHAR_MAX )
-	return errout( EILSEQ, (size_t)(-1) );
-
-      /* We got a valid input wchar...
-       */
-      if( mbs != NULL )
-      { /* ...which we are now expected to store...
-	 */
-	if( mblen-- > 0 ) *mbs++ = (unsigned char)(*wcs);
-
-	/* ...but, we must bail out, if there is no
-   	 * space left in the encoding buffer.
-	 */
-	else return errout( ENOMEM, (size_t)(-1) );
-      }
-
-      /* Ensure that we don't scan beyond a terminating NUL
-       * wchar, even if this lies within the bounded count.
-       */
-      if( *wcs++ == L'\0' ) wclen = 0;
-
-      /* In any case, count the current encoded byte.
-       */
-      ++retval;
-    }
-
-    /* We now have the final count, for a code page zero encoding;
-     * we are done.
+    int status;
+    const uint16_t *src = (const uint16_t *)(wcs);
+    retval = __mingw_utfconv_encode( mbs, mblen, &src, (size_t)(wclen),
+	__mingw_utfconv_flags( codeset ), &status
+      );
+    /* An unbounded scan stops only at the terminating NUL, (which is
+     * included in the count), or on failure; a bounded scan may also
+     * stop on exhaustion of the specified input length.
      */
+    switch( status )
+    { case UTFCONV_EILSEQ: return errout( EILSEQ, (size_t)(-1) );
+      case UTFCONV_FULL: return errout( ENOMEM, (size_t)(-1) );
+    }
     return retval;
   }
 
-  /* For any code page other than zero, we delegate both encoding
-   * and byte counting to the Windows API; note that for code pages
-   * other than CP_UTF7 or CP_UTF8, (and CP_UTF8 is the only code
-   * page with an identifier greater than that for CP_UTF7), there
-   * may be unrepresentable UTF-16 code points, and we must pass a
-   * flag reference to detect their presence in the UTF-16LE input
-   * sequence; OTOH, any valid UTF-16 code point is representable
-   * in both CP_UTF7 and CP_UTF8, but invalid UTF-16 code points
-   * may still arise, due to malformed surrogate pairs.
+  /* For any other code page, we delegate both encoding and byte
+   * counting to the Windows API; note that for code pages other than
+   * CP_UTF7, (and we've already handled CP_UTF8, which is the only code
+   * page with an identifier greater than that for CP_UTF7), there may
+   * be unrepresentable UTF-16 code points, and we must pass a flag
+   * reference to detect their presence in the UTF-16LE input sequence;
+   * OTOH, any valid UTF-16 code point is representable in CP_UTF7, but
+   * invalid UTF-16 code points may still arise, due to malformed
+   * surrogate pairs.
    */
   if( codeset >= CP_UTF7 )
-  { /* Target codeset is either UTF-7, or UTF-8; unfortunately,
-     * Microsoft's WideCharToMultiByte() is critically broken in
-     * respect of invalid sequence detection, when converting to
-     * either of these codeset's ... specifically, the function
-     * will fail if the EILSEQ flag reference is non-NULL, but
-     * without it, orphaned surrogates are not detected, and to
-     * work around this defect, we must explicitly scan for any
-     * such degenerate wide character sequence.
+  { /* Target codeset is UTF-7; unfortunately, Microsoft's function,
+     * WideCharToMultiByte(), is critically broken in respect of invalid
+     * sequence detection, when converting to this codeset, (or to UTF-8)
+     * ... specifically, the function will fail if the EILSEQ flag
+     * reference is non-NULL, but without it, orphaned surrogates are
+     * not detected, and to work around this defect, we must explicitly
+     * scan for any such degenerate wide character sequence.
      */
     size_t count = wclen;
     const wchar_t *chk = wcs;
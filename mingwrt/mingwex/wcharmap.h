@@ -8,7 +8,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2019, 2020, 2022, MinGW.OSDN Project
+ * Copyright (C) 2019, 2020, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -36,6 +36,18 @@
 #include <stdlib.h>
 #include <errno.h>
 
+#include "utfconv.h"
+
+/* We also need to know if the CPU supports SSE2; we cannot include
+ * "cpu_features.h" to determine this, since it includes <stdbool.h>,
+ * which is incompatible with our own boolean type, as defined below,
+ * so we declare just what we need.
+ */
+extern unsigned int __cpu_features;
+#ifndef _CRT_SSE2
+#define _CRT_SSE2  0x0020
+#endif
+
 /* Define a logical boolean type, for use in C code; (note that we don't
  * guard this, because we don't plan to use this header in C++ code).
  */
@@ -94,6 +106,31 @@ unsigned int __mingw_wctomb_cur_max_init (unsigned int);
 size_t __mingw_wctomb_convert (char *, int, const wchar_t *, int);
 unsigned int __mingw_wctomb_cur_max (void);
 
+/* Code pages for which the wchar_t to multi-byte conversion, (and, for
+ * all but code page zero, the complementary conversion), is performed
+ * directly, by the __mingw_utfconv_encode() and __mingw_utfconv_decode()
+ * functions, rather than by the Windows API; (note that CP_LATIN1 is
+ * our own name, for the ISO-8859-1 code page, since <winnls.h> does
+ * not provide one).
+ */
+#define CP_LATIN1  28591
+
+static __mb_inline__
+boolean __mingw_utfconv_codeset( unsigned int codeset )
+{ return (codeset == CP_UTF8) || (codeset == CP_LATIN1); }
+
+/* A helper, to select the appropriate __mingw_utfconv_encode() and
+ * __mingw_utfconv_decode() flags, for any of the preceding code pages,
+ * (including code page zero, which has the same wchar_t mapping as
+ * ISO-8859-1), permitting the SSE2 code paths only on a CPU which
+ * is known to support them.
+ */
+static __mb_inline__
+int __mingw_utfconv_flags( unsigned int codeset )
+{ return ((codeset == CP_UTF8) ? UTFCONV_UTF8 : UTFCONV_LATIN1)
+    | ((__cpu_features & _CRT_SSE2) ? UTFCONV_SSE2 : 0);
+}
+
 /* The legacy MinGW implementation used a get_codepage() function,
  * which was effectively the same as our __mb_codeset_for_locale();
  * this alias may, eventually, become redundant.
@@ -9,7 +9,7 @@
  * $Id$
  *
  * Written by Keith Marshall <keith@users.osdn.me>
- * Copyright (C) 2019, 2020, 2022, MinGW.OSDN Project
+ * Copyright (C) 2019, 2020, 2022, 2026, MinGW.OSDN Project
  *
  *
  * Permission is hereby granted, free of charge, to any person obtaining a
@@ -138,6 +138,85 @@ static __mb_inline__ size_t __mingw_wcsrtombs_internal
   return errout( errno_reset, count );
 }
 
+static __mb_inline__ size_t __mingw_wcsrtombs_direct
+( char *restrict mbs, const wchar_t **restrict wcs, size_t len,
+  mbstate_t *restrict ps, unsigned int codeset
+)
+{ /* Alternative internal implementation of the wcsrtombs() function,
+   * for use when the effective codeset is one which we may encode
+   * directly; this requires only a single pass over the input, both
+   * storing, and counting, the encoded bytes, with no need to first
+   * determine the size of buffer required.
+   */
+  int status, flags = __mingw_utfconv_flags( codeset );
+  const uint16_t *src = (const uint16_t *)(*wcs);
+  size_t count = (size_t)(0);
+
+  /* As in the general case, this wcsrtombs() implementation will not
+   * use any mbstate, except to complete any deferred surrogate pair.
+   */
+  if( ps != NULL )
+  { union { mbstate_t ps; uint16_t wc[2]; } resume = { *ps };
+
+    *ps = (mbstate_t)(0);
+    if( IS_SURROGATE_PAIR( resume.wc[0], *src ) )
+    { /* There is a deferred surrogate pair, which we complete, and
+       * encode, as the first code point in the conversion; if there
+       * is insufficient buffer space to accommodate it, then no
+       * conversion is possible, so we must leave the state as it
+       * was, on entry.
+       */
+      const uint16_t *pair = resume.wc;
+      resume.wc[1] = *src++;
+      count = __mingw_utfconv_encode( mbs, len, &pair, 2, flags, &status );
+      if( status == UTFCONV_FULL )
+      { *ps = resume.ps;
+	return (size_t)(0);
+      }
+      if( status == UTFCONV_EILSEQ )
+      { /* The completed pair has no encoding in the effective codeset;
+	 * this must be reported, exactly as it would be in the case of
+	 * any other such code point, (with the input pointer referring
+	 * to the low surrogate, which completed the pair).
+	 */
+	if( mbs != NULL ) *wcs = (const wchar_t *)(src - 1);
+	return errout( EILSEQ, (size_t)(-1) );
+      }
+      if( mbs != NULL )
+      { mbs += count; len -= count;
+      }
+    }
+  }
+
+  /* Encode the remainder of the input sequence, stopping at its NUL
+   * terminator, at the first code point which has no encoding, or when
+   * the encoding buffer, (if any), can accommodate no more.
+   */
+  count += __mingw_utfconv_encode( mbs, len, &src, (size_t)(-1), flags,
+      &status
+    );
+  if( status == UTFCONV_EILSEQ )
+  { /* An invalid code point must be reported; per ISO-C99, when there
+     * is an encoding buffer, we leave the input pointer referring to
+     * this code point, in case the caller wishes to handle it.
+     */
+    if( mbs != NULL ) *wcs = (const wchar_t *)(src);
+    return errout( EILSEQ, (size_t)(-1) );
+  }
+  if( mbs != NULL )
+    /* In the case that the NUL terminator was encoded, ISO-C99 decrees
+     * that the input pointer must be set to NULL; otherwise, it must
+     * refer to the first code point which was not encoded.
+     */
+    *wcs = (status == UTFCONV_NUL) ? NULL : (const wchar_t *)(src);
+
+  /* In either case, the returned count must exclude the terminating NUL,
+   * if it was encoded, (and, in the absence of an encoding buffer, it
+   * always will have been).
+   */
+  return (status == UTFCONV_NUL) ? count - 1 : count;
+}
+
 size_t wcsrtombs( char *mbs, const wchar_t **wcs, size_t len, mbstate_t *ps )
 {
   /* Implementation of ISO-C99 wcsrtombs() function, in libmingwex.a;
@@ -147,10 +226,12 @@ size_t wcsrtombs( char *mbs, const wchar_t **wcs, size_t len, mbstate_t *ps )
   if( (wcs == NULL) || (*wcs == NULL) ) return errout( EINVAL, (size_t)(-1) );
 
   /* With a valid wcs reference, store the effective codeset, and
-   * hand the conversion off to the inline expansion of the preceding
-   * implementation.
+   * hand the conversion off to the inline expansion of the appropriate
+   * preceding implementation.
    */
-  (void)(__mingw_wctomb_codeset_init() );
+  unsigned int codeset = __mingw_wctomb_codeset_init();
+  if( (codeset == 0) || __mingw_utfconv_codeset( codeset ) )
+    return __mingw_wcsrtombs_direct( mbs, wcs, len, ps, codeset );
   return __mingw_wcsrtombs_internal( mbs, wcs, len, ps );
 }
 
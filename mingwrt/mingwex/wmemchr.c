@@ -11,6 +11,41 @@
 */
 
 #include	<wchar.h>
+#include	<stdint.h>
+#include	<emmintrin.h>
+#include	"cpu_features.h"
+
+#define	SSE2_FUNCTION	__attribute__((__target__ ("sse2"), __force_align_arg_pointer__))
+
+/*	SSE2 variant, selected at run time, when __cpu_features reports
+	that the CPU supports it; it compares eight wchar_t at a time, in
+	16-byte aligned blocks, which lie wholly within the n wchar_t to
+	be scanned, so it never reads beyond them.
+*/
+static SSE2_FUNCTION wchar_t *
+wmemchr_sse2( const wchar_t *s, wchar_t c, size_t n )
+	{
+	__m128i	key = _mm_set1_epi16((short)c);
+
+	for ( ; n > 0 && ((uintptr_t)s & 15) != 0; ++s, --n )
+		if ( *s == c )
+			return (wchar_t *)s;
+
+	for ( ; n >= 8; s += 8, n -= 8 )
+		{
+		int	mask = _mm_movemask_epi8(_mm_cmpeq_epi16(key,
+				_mm_load_si128((const __m128i *)s)));
+
+		if ( mask != 0 )
+			return (wchar_t *)s + (__builtin_ctz(mask) >> 1);
+		}
+
+	for ( ; n > 0; ++s, --n )
+		if ( *s == c )
+			return (wchar_t *)s;
+
+	return NULL;
+	}
 
 wchar_t*
 wmemchr(s, c, n)
@@ -18,6 +53,9 @@ wmemchr(s, c, n)
 	register wchar_t		c;
 	register size_t			n;
 	{
+	if ( s != NULL && (__cpu_features & _CRT_SSE2) )
+		return wmemchr_sse2(s, c, n);
+
 	if ( s != NULL )
 		for ( ; n > 0; ++s, --n )
 			if ( *s == c )
@@ -11,6 +11,43 @@
 */
 
 #include	<wchar.h>
+#include	<stdint.h>
+#include	<emmintrin.h>
+#include	"cpu_features.h"
+
+#define	SSE2_FUNCTION	__attribute__((__target__ ("sse2"), __force_align_arg_pointer__))
+
+/*	SSE2 variant, selected at run time, when __cpu_features reports
+	that the CPU supports it; it compares eight wchar_t at a time,
+	with aligned loads from s1, and unaligned loads from s2.
+*/
+static SSE2_FUNCTION int
+wmemcmp_sse2( const wchar_t *s1, const wchar_t *s2, size_t n )
+	{
+	for ( ; n > 0 && ((uintptr_t)s1 & 15) != 0; ++s1, ++s2, --n )
+		if ( *s1 != *s2 )
+			return *s1 - *s2;
+
+	for ( ; n >= 8; s1 += 8, s2 += 8, n -= 8 )
+		{
+		int	mask = _mm_movemask_epi8(_mm_cmpeq_epi16(
+				_mm_load_si128((const __m128i *)s1),
+				_mm_loadu_si128((const __m128i *)s2)));
+
+		if ( mask != 0xFFFF )
+			{
+			int	i = __builtin_ctz(~mask) >> 1;
+
+			return s1[i] - s2[i];
+			}
+		}
+
+	for ( ; n > 0; ++s1, ++s2, --n )
+		if ( *s1 != *s2 )
+			return *s1 - *s2;
+
+	return 0;
+	}
 
 int
 wmemcmp(s1, s2, n)
@@ -24,6 +61,9 @@ wmemcmp(s1, s2, n)
 	if ( (s1 != NULL) != (s2 != NULL) )
 		return s2 == NULL ? 1 : -1;	/* robust */
 
+	if ( __cpu_features & _CRT_SSE2 )
+		return wmemcmp_sse2(s1, s2, n);
+
 	for ( ; n > 0; ++s1, ++s2, --n )
 		if ( *s1 != *s2 )
 			return *s1 - *s2;
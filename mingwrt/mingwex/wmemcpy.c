@@ -10,6 +10,7 @@
 
 */
 
+#include	<string.h>
 #include	<wchar.h>
 
 
@@ -24,9 +25,9 @@ wmemcpy(s1, s2, n)
 	if ( s1 == NULL || s2 == NULL || n == 0 )
 		return orig_s1;		/* robust */
 
-	for ( ; n > 0; --n )
-		*s1++ = *s2++;
-
-	return orig_s1;
+	/* The C runtime's memcpy() moves whole words, (or more), at a
+	   time, so delegate to it, rather than copying each wchar_t.
+	*/
+	return memcpy(orig_s1, s2, n * sizeof(wchar_t));
 	}
 
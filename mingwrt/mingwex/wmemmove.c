@@ -13,6 +13,7 @@
 #include	<errno.h>
 #include	<stdio.h>
 #include	<stdlib.h>
+#include	<string.h>
 #include	<wchar.h>
 
 wchar_t *
@@ -26,18 +27,9 @@ wmemmove(s1, s2, n)
 	if ( s1 == NULL || s2 == NULL || n == 0 )
 		return orig_s1;		/* robust */
 
-	/* XXX -- The following test works only within a flat address space! */
-	if ( s2 >= s1 )
-		for ( ; n > 0; --n )
-			*s1++ = *s2++;
-	else	{
-		s1 += n;
-		s2 += n;
-
-		for ( ; n > 0; --n )
-			*--s1 = *--s2;
-		}
-
-	return orig_s1;
+	/* As for wmemcpy(), delegate to the C runtime's memmove(), which
+	   also handles overlapping regions in either direction.
+	*/
+	return memmove(orig_s1, s2, n * sizeof(wchar_t));
 	}
 
@@ -11,7 +11,30 @@
 */
 
 #include	<wchar.h>
+#include	<stdint.h>
+#include	<emmintrin.h>
+#include	"cpu_features.h"
 
+#define	SSE2_FUNCTION	__attribute__((__target__ ("sse2"), __force_align_arg_pointer__))
+
+/*	SSE2 variant, selected at run time, when __cpu_features reports
+	that the CPU supports it; it stores eight wchar_t at a time, in
+	16-byte aligned blocks.
+*/
+static SSE2_FUNCTION void
+wmemset_sse2( wchar_t *s, wchar_t c, size_t n )
+	{
+	__m128i	fill = _mm_set1_epi16((short)c);
+
+	for ( ; n > 0 && ((uintptr_t)s & 15) != 0; --n )
+		*s++ = c;
+
+	for ( ; n >= 8; s += 8, n -= 8 )
+		_mm_store_si128((__m128i *)s, fill);
+
+	for ( ; n > 0; --n )
+		*s++ = c;
+	}
 
 wchar_t *
 wmemset(s, c, n)
@@ -21,7 +44,10 @@ wmemset(s, c, n)
 	{
 	wchar_t			*orig_s = s;
 
-	if ( s != NULL )
+	if ( s != NULL && (__cpu_features & _CRT_SSE2) )
+		wmemset_sse2(s, c, n);
+
+	else if ( s != NULL )
 		for ( ; n > 0; --n )
 			*s++ = c;
 
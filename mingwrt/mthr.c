@@ -21,97 +21,43 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #undef WIN32_LEAN_AND_MEAN
-#include <stdlib.h>
 
-/* To protect the thread/key association data structure modifications. */
+/* To serialize deregistration of key/dtor associations, with respect
+   to the running of the destructors.  */
 CRITICAL_SECTION __mingwthr_cs;
 
-typedef struct __mingwthr_key __mingwthr_key_t;
-
-/* The list of threads active with key/dtor pairs. */
-struct __mingwthr_key {
-  DWORD key;
-  void (*dtor) (void *);
-  __mingwthr_key_t *next;
-};
-
-
-static __mingwthr_key_t *key_dtor_list;
+/* The registry of key/dtor associations. */
+#include "tlskeys.h"
 
 /*
  * __mingwthr_key_add:
  *
- * Add key/dtor association for this thread. If the thread entry does not
- * exist, create a new one and add to the head of the threads list; add
- * the new assoc at the head of the keys list.
+ * Add key/dtor association; this is recorded in the slot indexed
+ * by the key itself, so no allocation, and no locking, is needed.
  *
  */
 
 static int
 ___mingwthr_add_key_dtor ( DWORD key, void (*dtor) (void *))
 {
-  __mingwthr_key_t *new_key;
-
-  new_key = (__mingwthr_key_t *) calloc (1, sizeof (__mingwthr_key_t));
-  if (new_key == NULL)
-    return -1;
-
-  new_key->key = key;
-  new_key->dtor = dtor;
-
-  EnterCriticalSection (&__mingwthr_cs);
-
-  new_key->next = key_dtor_list;
-  key_dtor_list = new_key;
-
-  LeaveCriticalSection (&__mingwthr_cs);
-
 #ifdef DEBUG
-  printf ("%s: allocating: (%ld, %x)\n",
+  printf ("%s: registering: (%ld, %x)\n",
           __FUNCTION__, key, dtor);
 #endif
 
-  return 0;
+  return __mingwthr_key_register (key, dtor);
 }
 
 static int
 ___mingwthr_remove_key_dtor ( DWORD key )
 {
-  __mingwthr_key_t *prev_key;
-  __mingwthr_key_t *cur_key;
-
-  EnterCriticalSection (&__mingwthr_cs);
-
-  prev_key = NULL;
-  cur_key = key_dtor_list;
-
-  while( cur_key != NULL )
-  {
-     if( cur_key->key == key )
-     {
-// take key/dtor out of list
-        if( prev_key == NULL )
-        {
-           key_dtor_list = cur_key->next;
-        }
-        else
-        {
-           prev_key->next = cur_key->next;
-        }
-
 #ifdef DEBUG
-        printf ("%s: removing: (%ld)\n",
-                __FUNCTION__, key );
+  printf ("%s: removing: (%ld)\n",
+          __FUNCTION__, key );
 #endif
 
-        free( cur_key );
-        break;
-     }
-
-     prev_key = cur_key;
-     cur_key = cur_key->next;
-  }
-
+  EnterCriticalSection (&__mingwthr_cs);
+  __mingwthr_key_deregister (key);
   LeaveCriticalSection (&__mingwthr_cs);
 
   return 0;
@@ -126,43 +72,20 @@ ___mingwthr_remove_key_dtor ( DWORD key )
  * Note that this does not delete the key itself, but just runs
  * the dtor if the current value are both non-NULL. Note that the
  * keys with NULL dtors are not added by __mingwthr_key_dtor, the
- * only public interface, so we don't need to check.
+ * only public interface, so we don't need to check.  Only those
+ * keys which are registered are visited, and no lock is taken,
+ * unless there is a destructor to run.
  *
  */
 
 void
 __mingwthr_run_key_dtors (void)
 {
-  __mingwthr_key_t *keyp;
-
 #ifdef DEBUG
   printf ("%s: Entering Thread id %ld\n", __FUNCTION__, GetCurrentThreadId() );
 #endif
 
-  EnterCriticalSection (&__mingwthr_cs);
-
-  for (keyp = key_dtor_list; keyp; )
-  {
-     LPVOID value = TlsGetValue (keyp->key);
-     if (GetLastError () == ERROR_SUCCESS)
-     {
-#ifdef DEBUG
-        printf ("   (%ld, %x)\n", keyp->key, keyp->dtor);
-#endif
-        if (value)
-           (*keyp->dtor) (value);
-     }
-#ifdef DEBUG
-     else
-     {
-        printf ("   TlsGetValue FAILED  (%ld, %x)\n",
-                keyp->key, keyp->dtor);
-     }
-#endif
-     keyp = keyp->next;
-  }
-
-  LeaveCriticalSection (&__mingwthr_cs);
+  __mingwthr_key_run_dtors (&__mingwthr_cs);
 
 #ifdef DEBUG
   printf ("%s: Exiting Thread id %ld\n", __FUNCTION__, GetCurrentThreadId() );
@@ -77,6 +77,104 @@ fake_sbrk(int size)
     return malloc(size);
 }
 
+#ifdef __MINGW32__
+/*
+ * allocate an empty arc table, with at least the specified number
+ * of slots, (rounded up to a power of two).
+ */
+struct arctab *
+_gmon_arctab(slots, prev)
+	u_long slots;
+	struct arctab *prev;
+{
+	struct arctab *tab;
+	u_long size = 1;
+
+	while (size < slots || size < MINARCS)
+		size <<= 1;
+	tab = calloc(1, sizeof(struct arctab) +
+	    (size - 1) * sizeof(struct arcent));
+	if (tab != NULL) {
+		tab->prev = prev;
+		tab->mask = size - 1;
+	}
+	return (tab);
+}
+
+/*
+ * fold one arc into the table tab, (which must not be subject to
+ * concurrent update); returns zero, if there is no free slot.
+ */
+static int
+mergearc(tab, arc)
+	struct arctab *tab;
+	struct arcent *arc;
+{
+	u_long index, probe;
+	struct arcent *slot;
+
+	index = ARCHASH(arc->frompc, arc->selfpc);
+	for (probe = 0; probe <= tab->mask; probe++, index++) {
+		slot = &tab->arc[index & tab->mask];
+		if (slot->frompc == 0) {
+			*slot = *arc;
+			return (1);
+		}
+		if (slot->frompc == arc->frompc
+		    && slot->selfpc == arc->selfpc) {
+			slot->count += arc->count;
+			return (1);
+		}
+	}
+	return (0);
+}
+
+/*
+ * write one arc, as a gmon.out rawarc record.
+ */
+static void
+writearc(fd, arc)
+	int fd;
+	struct arcent *arc;
+{
+	struct rawarc rawarc;
+
+	rawarc.raw_frompc = arc->frompc;
+	rawarc.raw_selfpc = arc->selfpc;
+	rawarc.raw_count = arc->count;
+	write(fd, &rawarc, sizeof rawarc);
+}
+
+/*
+ * write a separate gmon-<tid>.out file, containing only the histogram,
+ * for each thread which was sampled individually by profil().
+ */
+static void
+writethreads(p, hdr)
+	struct gmonparam *p;
+	struct gmonhdr *hdr;
+{
+	struct profthread *thr;
+	char name[32];
+	u_int hz;
+	int fd;
+
+	for (thr = NULL;
+	    (thr = profile_thread_hist(thr, p->kcount, &hz)) != NULL; ) {
+		snprintf(name, sizeof name, "gmon-%lu.out", thr->tid);
+		fd = open(name, O_CREAT|O_TRUNC|O_WRONLY|O_BINARY, 0666);
+		if (fd < 0) {
+			perror(name);
+			continue;
+		}
+		hdr->profrate = hz;
+		write(fd, (char *)hdr, sizeof *hdr);
+		write(fd, p->kcount, p->kcountsize);
+		close(fd);
+	}
+}
+#endif /* __MINGW32__ */
+
 void
 monstartup(lowpc, highpc)
 	u_long lowpc;
@@ -103,6 +201,30 @@ monstartup(lowpc, highpc)
 		p->tolimit = MAXARCS;
 	p->tossize = p->tolimit * sizeof(struct tostruct);
 
+#ifdef __MINGW32__
+	/*
+	 * MinGW doesn't use the froms[] and tos[] chains, (see mcount.c),
+	 * so only the histogram is allocated here; arcs are recorded in the
+	 * growable table, which is sized for the same number of arcs as
+	 * tos[] would have accommodated.
+	 */
+	cp = fake_sbrk(p->kcountsize);
+	if (cp == (char *)-1) {
+		ERR("monstartup: out of memory\n");
+		return;
+	}
+	bzero(cp, p->kcountsize);
+
+	p->kcount = (u_short *)cp;
+	p->froms = NULL;
+	p->tos = NULL;
+
+	if ((p->arcs = _gmon_arctab(p->tolimit + (p->tolimit >> 1), NULL))
+	    == NULL) {
+		ERR("monstartup: out of memory\n");
+		return;
+	}
+#else
 	cp = fake_sbrk(p->kcountsize + p->fromssize + p->tossize);
 	if (cp == (char *)-1) {
 		ERR("monstartup: out of memory\n");
@@ -121,6 +243,7 @@ monstartup(lowpc, highpc)
         /* XXX minbrk needed? */
 	//minbrk = fake_sbrk(0);
 	p->tos[0].link = 0;
+#endif
 
 	o = p->highpc - p->lowpc;
 	if (p->kcountsize < o) {
@@ -149,11 +272,17 @@ _mcleanup()
 {
 	int fd;
 	int hz;
+#ifdef __MINGW32__
+	struct arctab *tab, *merged;
+	struct arcent *arc;
+	u_long slot, slots;
+#else
 	int fromindex;
 	int endfrom;
 	u_long frompc;
 	int toindex;
 	struct rawarc rawarc;
+#endif
 	struct gmonparam *p = &_gmonparam;
 	struct gmonhdr gmonhdr, *hdr;
 	char *proffile;
@@ -167,6 +296,9 @@ _mcleanup()
 
         hz = PROF_HZ;
 	moncontrol(0);
+#ifdef __MINGW32__
+	hz = profile_rate();
+#endif
 
 #ifdef nope
 	if ((profdir = getenv("PROFDIR")) != NULL) {
@@ -240,6 +372,44 @@ _mcleanup()
 	hdr->profrate = hz;
 	write(fd, (char *)hdr, sizeof *hdr);
 	write(fd, p->kcount, p->kcountsize);
+#ifdef __MINGW32__
+	/*
+	 * merge the content of the current arc table, and of all retired
+	 * tables, into a new table which is large enough for all of them,
+	 * so that each arc, (including any duplicate which mcount() may
+	 * have recorded), is written only once; if we cannot allocate
+	 * this, write each arc as found, (leaving gprof to merge them).
+	 */
+	slots = 0;
+	for (tab = p->arcs; tab != NULL; tab = tab->prev)
+		slots += tab->mask + 1;
+	merged = (slots > 0) ? _gmon_arctab(slots, NULL) : NULL;
+	for (tab = p->arcs; tab != NULL; tab = tab->prev)
+		for (slot = 0; slot <= tab->mask; slot++) {
+			arc = &tab->arc[slot];
+			if (arc->selfpc == 0
+			    || (merged != NULL && mergearc(merged, arc)))
+				continue;
+			writearc(fd, arc);
+		}
+	if (merged != NULL) {
+		for (slot = 0; slot <= merged->mask; slot++) {
+			arc = &merged->arc[slot];
+			if (arc->selfpc == 0)
+				continue;
+#ifdef DEBUG
+			len = sprintf(dbuf,
+			"[mcleanup2] frompc 0x%x selfpc 0x%x count %d\n" ,
+				arc->frompc, arc->selfpc, arc->count);
+			write(log, dbuf, len);
+#endif
+			writearc(fd, arc);
+		}
+		free(merged);
+	}
+	close(fd);
+	writethreads(p, hdr);
+#else
 	endfrom = p->fromssize / sizeof(*p->froms);
 	for (fromindex = 0; fromindex < endfrom; fromindex++) {
 		if (p->froms[fromindex] == 0)
@@ -263,6 +433,7 @@ _mcleanup()
 		}
 	}
 	close(fd);
+#endif
 }
 
 /*
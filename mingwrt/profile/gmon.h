@@ -121,6 +121,42 @@ struct tostruct {
 	u_short pad;
 };
 
+#ifdef __MINGW32__
+/*
+ * MinGW doesn't use the froms[] and tos[] chains, (which cannot safely
+ * be updated by more than one thread at a time); rather, arcs are kept
+ * in an open-addressed hash table, keyed on the (frompc, selfpc) pair,
+ * in which slots are claimed, and counts updated, by interlocked memory
+ * operations.  When a table becomes too full, it is replaced by another
+ * of twice the size, (to which all new arcs are added); the retired
+ * table remains linked to its successor, so that the counts which it
+ * holds may be merged into the final gmon.out, by _mcleanup().
+ */
+struct arcent {
+	u_long	frompc;		/* absolute address of the call site */
+	u_long	selfpc;		/* absolute address of the callee */
+	long	count;
+};
+
+struct arctab {
+	struct arctab	*prev;	/* the table which this one replaced */
+	u_long		mask;	/* number of slots, less one */
+	long		used;	/* number of slots claimed */
+	struct arcent	arc[1];
+};
+
+/*
+ * maximum number of slots to probe, before growing the table, and the
+ * proportion of slots, (three quarters), which may be claimed before
+ * the table is considered to be too full.
+ */
+#define ARCPROBES	16
+#define ARCLOAD(t)	(((t)->mask + 1) - (((t)->mask + 1) >> 2))
+#define ARCHASH(f,s)	((((f) ^ ((s) << 7)) * 0x9E3779B1UL) >> 8)
+
+struct arctab *_gmon_arctab __P((u_long, struct arctab *));
+#endif /* __MINGW32__ */
+
 /*
  * a raw arc, with pointers to the calling site and
  * the called site and a count.
@@ -153,6 +189,9 @@ struct gmonparam {
 	u_long		highpc;
 	u_long		textsize;
 	u_long		hashfraction;
+#ifdef __MINGW32__
+	struct arctab	*volatile arcs;
+#endif
 };
 extern struct gmonparam _gmonparam;
 
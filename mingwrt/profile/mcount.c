@@ -51,6 +51,10 @@ static char rcsid[] = "$OpenBSD: mcount.c,v 1.6 1997/07/23 21:11:27 kstailey Exp
 #endif
 #include <sys/types.h>
 #include <gmon.h>
+#ifdef __MINGW32__
+#include <stdlib.h>
+#include <windows.h>
+#endif
 
 /*
  * mcount is called on entry to each function compiled with the profiling
@@ -67,6 +71,100 @@ static char rcsid[] = "$OpenBSD: mcount.c,v 1.6 1997/07/23 21:11:27 kstailey Exp
  * both frompcindex and frompc.  Any reasonable, modern compiler will
  * perform this optimization.
  */
+#ifdef __MINGW32__
+/*
+ * MinGW records arcs in the hash table described in <gmon.h>, rather
+ * than in the froms[] and tos[] chains; since every update is atomic,
+ * there is no need to mark the profiler as GMON_PROF_BUSY, (which would
+ * cause arcs traversed concurrently, by other threads, to be lost).
+ */
+static void
+growarcs (struct gmonparam *p, struct arctab *tab)
+{
+	/*
+	 * replace tab by a table of twice the size, unless some
+	 * other thread has already done so.
+	 */
+	struct arctab *grown;
+
+	if (p->arcs != tab)
+		return;
+	if ((grown = _gmon_arctab((tab->mask + 1) << 1, tab)) == NULL) {
+		p->state = GMON_PROF_ERROR;
+		return;
+	}
+	if (InterlockedCompareExchangePointer((void *volatile *)&p->arcs,
+	    grown, tab) != tab)
+		free(grown);
+}
+
+/* _mcount; may be static, inline, etc */
+_MCOUNT_DECL (u_long frompc, u_long selfpc)
+{
+	register struct gmonparam *p;
+	register struct arctab *tab;
+	register struct arcent *arc;
+	register u_long index;
+	int probe;
+
+	p = &_gmonparam;
+	/*
+	 * check that we are profiling,
+	 * and that frompc is a reasonable pc value.
+	 */
+	if (p->state != GMON_PROF_ON)
+		return;
+	if (frompc - p->lowpc > p->textsize)
+		return;
+
+	while ((tab = p->arcs) != NULL) {
+		index = ARCHASH(frompc, selfpc);
+		for (probe = 0; probe < ARCPROBES; probe++, index++) {
+			arc = &tab->arc[index & tab->mask];
+			if (arc->frompc == 0) {
+				/*
+				 * first time traversing this arc; claim
+				 * the slot, unless another thread beats us
+				 * to it, in which case we must look again.
+				 */
+				if (InterlockedCompareExchange(
+				    (volatile LONG *)&arc->frompc,
+				    frompc, 0) != 0) {
+					if (arc->frompc != frompc)
+						continue;
+				} else {
+					arc->selfpc = selfpc;
+					InterlockedIncrement(
+					    (volatile LONG *)&arc->count);
+					if (InterlockedIncrement(
+					    (volatile LONG *)&tab->used)
+					    >= ARCLOAD(tab))
+						growarcs(p, tab);
+					return;
+				}
+			}
+			/*
+			 * a slot whose selfpc has yet to be stored, by the
+			 * thread which claimed it, is passed over; at worst,
+			 * this records a duplicate of the arc, and _mcleanup()
+			 * merges the two into a single gmon.out record.
+			 */
+			if (arc->frompc == frompc && arc->selfpc == selfpc) {
+				InterlockedIncrement(
+				    (volatile LONG *)&arc->count);
+				return;
+			}
+		}
+		/*
+		 * too many collisions; grow the table, and try again.
+		 */
+		growarcs(p, tab);
+		if (p->state != GMON_PROF_ON)
+			return;
+	}
+}
+
+#else
 /* _mcount; may be static, inline, etc */
 _MCOUNT_DECL (u_long frompc, u_long selfpc)
 {
@@ -176,6 +274,7 @@ overflow:
 	p->state = GMON_PROF_ERROR;
 	return;
 }
+#endif /* __MINGW32__ */
 
 /*
  * Actual definition of mcount function.  Defined in <machine/profile.h>,
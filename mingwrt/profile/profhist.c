@@ -0,0 +1,126 @@
+/*
+ * profhist.c
+ *
+ * Histogram bucketing, merging, and folding, on behalf of profil(); this
+ * is kept free of any Windows API dependency, so that it may be compiled,
+ * and tested, on any host.
+ *
+ *
+ *
+ * $Id$
+ *
+ * Written by agent <agent@local>
+ * Copyright (C) 2026, MinGW.OSDN Project
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OF OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *
+ * profil() accumulates samples in 32-bit bins, which do not wrap on long
+ * runs, but gmon.out, (as read by gprof), requires 16-bit HISTCOUNTER
+ * bins; profile_fold() scales the former down to fit the latter, and
+ * reports the divisor by which the sampling rate must be reduced, so that
+ * gprof will continue to report correct times.  Those times are correct
+ * only if the sampling rate is itself correct; since Sleep() cannot wait
+ * for exactly 1000 / hz milliseconds, profile_measured_rate() derives it
+ * from the number of samples actually taken, over the elapsed interval.
+ *
+ */
+#define _BSD_SOURCE
+#include <sys/types.h>
+#ifdef __MINGW32__
+#include <sys/bsdtypes.h>
+#endif
+
+#include <profil.h>
+
+/* Map PC to the index of the bin in which it is to be counted, within
+   the histogram described by P, or return PROFBIN_NONE if it lies outside
+   the profiled range.  */
+
+size_t
+profile_bin (const struct profinfo *p, u_long pc)
+{
+  size_t idx;
+
+  if (pc < p->lowpc || pc >= p->highpc)
+    return PROFBIN_NONE;
+  idx = PROFIDX (pc, p->lowpc, p->scale);
+  return (idx < p->nbins) ? idx : PROFBIN_NONE;
+}
+
+/* Add each of NBINS bins in FROM to its counterpart in INTO, saturating
+   rather than wrapping on overflow.  */
+
+void
+profile_merge (u_int *into, const u_int *from, size_t nbins)
+{
+  size_t i;
+
+  for (i = 0; i < nbins; i++)
+    into[i] = (from[i] > ~into[i]) ? ~0U : into[i] + from[i];
+}
+
+/* Fold NBINS 32-bit BINS, sampled at HZ, into 16-bit COUNTER bins; each
+   is divided by the smallest divisor which brings the largest within
+   range, (preferring one which divides HZ exactly, so that the effective
+   rate, HZ / divisor, remains an exact integer, provided that this costs
+   less than half of the remaining resolution), and rounded to nearest.
+   Returns the divisor.  */
+
+u_int
+profile_fold (u_short *counter, const u_int *bins, size_t nbins, u_int hz)
+{
+  u_int max = 0, div, d;
+  size_t i;
+
+  for (i = 0; i < nbins; i++)
+    if (bins[i] > max)
+      max = bins[i];
+
+  div = (max > 0xFFFF) ? (max - 1) / 0xFFFF + 1 : 1;
+  for (d = div; d < 2 * div && d <= hz; d++)
+    if (hz % d == 0)
+      {
+	div = d;
+	break;
+      }
+
+  for (i = 0; i < nbins; i++)
+    counter[i] = (bins[i] / div) + ((bins[i] % div) >= (div - div / 2));
+  return div;
+}
+
+/* Compute the sampling rate actually achieved, when TICKS samples have
+   been taken over an ELAPSED interval, measured in units of which there
+   are FREQ per second, rounded to the nearest whole number of samples per
+   second; returns the nominal rate, HZ, if no interval was measured.  */
+
+u_int
+profile_measured_rate (u_long ticks, unsigned long long elapsed,
+		       unsigned long long freq, u_int hz)
+{
+  unsigned long long rate;
+
+  if (ticks == 0 || elapsed == 0 || freq == 0)
+    return hz;
+  rate = ((unsigned long long) ticks * freq + elapsed / 2) / elapsed;
+  return (rate > 0) ? (u_int) rate : 1;
+}
@@ -21,7 +21,39 @@
 
 #include <profil.h>
 
+#ifdef __MINGW32__
+#include <stdlib.h>
+#include <string.h>
+#include <tlhelp32.h>
+
+#define SLEEPTIME (1000 / p->hz)
+
+/* Number of scans of the process thread list per second, when sampling
+   in PROF_THREADS_ALL or PROF_THREADS_EACH mode.  */
+#define SCANS_PER_SEC 10
+
+/* The thread enumeration API, and OpenThread(), are not available on
+   WinNT4, (the minimum supported platform), so must be looked up at run
+   time; if we can't find them, only PROF_THREADS_SELF mode is supported.
+   Similarly, we use timeBeginPeriod(), if available, to achieve sampling
+   rates higher than the default system timer resolution would allow.  */
+static struct
+{
+  HANDLE (WINAPI *snapshot) (DWORD, DWORD);
+  BOOL (WINAPI *first) (HANDLE, LPTHREADENTRY32);
+  BOOL (WINAPI *next) (HANDLE, LPTHREADENTRY32);
+  HANDLE (WINAPI *open) (DWORD, BOOL, DWORD);
+} toolhelp;
+
+static struct
+{
+  HMODULE dll;
+  UINT (WINAPI *begin) (UINT);
+  UINT (WINAPI *end) (UINT);
+} winmm;
+#else
 #define SLEEPTIME (1000 / PROF_HZ)
+#endif
 
 /* global profinfo for profil() call */
 static struct profinfo prof;
@@ -58,6 +90,123 @@ print_prof (struct profinfo *p)
 }
 #endif
 
+#ifdef __MINGW32__
+/* Count the current pc of thread THR into BINS. */
+
+static void
+sample_thr (struct profinfo *p, HANDLE thr, u_int *bins)
+{
+  size_t idx = profile_bin (p, get_thrpc (thr));
+
+  if (idx != PROFBIN_NONE && bins[idx] != ~0U)
+    bins[idx]++;
+}
+
+/* Bring the list of threads to be sampled up to date; this must not be
+   done while any thread is suspended, since it allocates memory.  */
+
+static void
+scan_threads (struct profinfo *p, u_long scan)
+{
+  struct profthread *t, **link;
+  THREADENTRY32 te;
+  HANDLE snap;
+  BOOL ok;
+  DWORD pid = GetCurrentProcessId (), self = GetCurrentThreadId ();
+
+  snap = toolhelp.snapshot (TH32CS_SNAPTHREAD, 0);
+  if (snap == INVALID_HANDLE_VALUE)
+    return;
+  te.dwSize = sizeof te;
+  for (ok = toolhelp.first (snap, &te); ok; ok = toolhelp.next (snap, &te))
+    {
+      if (te.th32OwnerProcessID != pid || te.th32ThreadID == self)
+	continue;
+      for (t = p->threads; t; t = t->next)
+	if (t->handle && t->tid == te.th32ThreadID)
+	  break;
+      if (t == NULL)
+	{
+	  /* a thread we haven't seen before */
+	  HANDLE h = toolhelp.open (THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT,
+				    FALSE, te.th32ThreadID);
+	  if (h == NULL)
+	    continue;
+	  if ((t = calloc (1, sizeof *t)) == NULL
+	      || (p->mode == PROF_THREADS_EACH
+		  && (t->bins = calloc (p->nbins, sizeof (u_int))) == NULL))
+	    {
+	      free (t);
+	      CloseHandle (h);
+	      continue;
+	    }
+	  t->handle = h;
+	  t->tid = te.th32ThreadID;
+	  t->next = p->threads;
+	  p->threads = t;
+	}
+      t->seen = scan;
+    }
+  CloseHandle (snap);
+
+  /* Forget threads which have terminated, but keep any histograms.  */
+  for (link = &p->threads; (t = *link) != NULL;)
+    {
+      if (t->handle && t->seen != scan)
+	{
+	  CloseHandle (t->handle);
+	  t->handle = NULL;
+	  if (t->bins == NULL)
+	    {
+	      *link = t->next;
+	      free (t);
+	      continue;
+	    }
+	}
+      link = &t->next;
+    }
+}
+
+/* Everytime we wake up, sample the pc of the main thread, or of every
+   thread in the process, into the 32-bit profile bins of ARG, (or of
+   each thread).  */
+
+static DWORD CALLBACK
+profthr_func (LPVOID arg)
+{
+  struct profinfo *p = (struct profinfo *) arg;
+  struct profthread *t;
+  u_long tick, scan = 0;
+  u_int rescan = (p->hz > SCANS_PER_SEC) ? p->hz / SCANS_PER_SEC : 1;
+  LARGE_INTEGER freq, start, now;
+
+  /* SLEEPTIME is truncated, and Sleep() rounds it up to the system timer
+     resolution, so the nominal rate is seldom achieved; time the run, so
+     that the rate which is reported reflects the samples actually taken.  */
+  if (!QueryPerformanceFrequency (&freq) || !QueryPerformanceCounter (&start))
+    freq.QuadPart = 0;
+
+  for (tick = 0; !p->stop; tick++)
+    {
+      if (p->mode == PROF_THREADS_SELF)
+	sample_thr (p, p->targthr, p->bins);
+      else
+	{
+	  if (tick % rescan == 0)
+	    scan_threads (p, ++scan);
+	  for (t = p->threads; t; t = t->next)
+	    if (t->handle)
+	      sample_thr (p, t->handle, t->bins ? t->bins : p->bins);
+	}
+      Sleep (SLEEPTIME);
+    }
+  if (freq.QuadPart && QueryPerformanceCounter (&now))
+    p->rate = profile_measured_rate (tick, now.QuadPart - start.QuadPart,
+				     freq.QuadPart, p->hz);
+  p->stop = 2;
+  return 0;
+}
+#else
 /* Everytime we wake up use the main thread pc to hash into the cell in the
    profile buffer ARG. */
 
@@ -82,12 +231,51 @@ profthr_func (LPVOID arg)
     }
   return 0;
 }
+#endif
 
 /* Stop profiling to the profiling buffer pointed to by P. */
 
 static int
 profile_off (struct profinfo *p)
 {
+#ifdef __MINGW32__
+  struct profthread *t;
+  int wait;
+
+  if (p->profthr)
+    {
+      /* Ask the profiling thread to stop, rather than terminating it
+	 forthwith; it may have another thread suspended, or hold the
+	 heap lock.  Allow it one second to comply.  */
+      p->stop = 1;
+      for (wait = 0; p->stop != 2 && wait < 1000; wait++)
+	if (WaitForSingleObject (p->profthr, 1) == WAIT_OBJECT_0)
+	  break;
+      if (p->stop != 2)
+	TerminateThread (p->profthr, 0);
+      CloseHandle (p->profthr);
+      p->profthr = 0;
+      if (winmm.end && p->hz > PROF_HZ)
+	winmm.end (1);
+
+      /* Fold the 32-bit bins, (including those of each thread), into
+	 the caller's 16-bit counters.  */
+      for (t = p->threads; t; t = t->next)
+	{
+	  if (t->handle)
+	    {
+	      CloseHandle (t->handle);
+	      t->handle = NULL;
+	    }
+	  if (t->bins)
+	    profile_merge (p->bins, t->bins, p->nbins);
+	}
+      p->divisor = profile_fold (p->counter, p->bins, p->nbins, p->rate);
+    }
+  if (p->targthr)
+    CloseHandle (p->targthr);
+  p->targthr = 0;
+#else
   if (p->profthr)
     {
       TerminateThread (p->profthr, 0);
@@ -95,9 +283,72 @@ profile_off (struct profinfo *p)
     }
   if (p->targthr)
     CloseHandle (p->targthr);
+#endif
   return 0;
 }
 
+#ifdef __MINGW32__
+/* Release all memory associated with the profiling buffer P. */
+
+static void
+profile_free (struct profinfo *p)
+{
+  struct profthread *t;
+
+  while ((t = p->threads) != NULL)
+    {
+      p->threads = t->next;
+      free (t->bins);
+      free (t);
+    }
+  free (p->bins);
+  p->bins = NULL;
+}
+
+/* Select the sampling frequency and mode, from the environment, and look
+   up any API entry points they require.  */
+
+static void
+profile_config (struct profinfo *p)
+{
+  const char *env;
+  HMODULE kernel32;
+
+  p->rate = p->hz = PROF_HZ;
+  if ((env = getenv ("GMON_HZ")) != NULL && atoi (env) > 0)
+    p->rate = p->hz = (atoi (env) < PROF_HZ_MAX) ? atoi (env) : PROF_HZ_MAX;
+  if (p->hz > PROF_HZ && winmm.dll == NULL
+      && (winmm.dll = LoadLibrary ("winmm.dll")) != NULL)
+    {
+      winmm.begin = (void *) GetProcAddress (winmm.dll, "timeBeginPeriod");
+      winmm.end = (void *) GetProcAddress (winmm.dll, "timeEndPeriod");
+      if (winmm.begin == NULL || winmm.end == NULL)
+	winmm.begin = winmm.end = NULL;
+    }
+
+  p->mode = PROF_THREADS_SELF;
+  if ((env = getenv ("GMON_THREADS")) != NULL)
+    {
+      if (strcmp (env, "all") == 0)
+	p->mode = PROF_THREADS_ALL;
+      else if (strcmp (env, "each") == 0)
+	p->mode = PROF_THREADS_EACH;
+    }
+  if (p->mode != PROF_THREADS_SELF && toolhelp.open == NULL
+      && (kernel32 = GetModuleHandle ("kernel32.dll")) != NULL)
+    {
+      toolhelp.snapshot = (void *) GetProcAddress (kernel32,
+						   "CreateToolhelp32Snapshot");
+      toolhelp.first = (void *) GetProcAddress (kernel32, "Thread32First");
+      toolhelp.next = (void *) GetProcAddress (kernel32, "Thread32Next");
+      if (toolhelp.snapshot && toolhelp.first && toolhelp.next)
+	toolhelp.open = (void *) GetProcAddress (kernel32, "OpenThread");
+    }
+  if (toolhelp.open == NULL)
+    p->mode = PROF_THREADS_SELF;
+}
+#endif
+
 /* Create a timer thread and pass it a pointer P to the profiling buffer. */
 
 static int
@@ -129,6 +380,10 @@ profile_on (struct profinfo *p)
       errno = EAGAIN;
       return -1;
     }
+#ifdef __MINGW32__
+  if (winmm.begin && p->hz > PROF_HZ)
+    winmm.begin (1);
+#endif
   return 0;
 }
 
@@ -159,6 +414,9 @@ profile_ctl (struct profinfo * p, char *samples, size_t size,
   profile_off (p);
   if (scale)
     {
+#ifdef __MINGW32__
+      profile_free (p);
+#endif
       memset (samples, 0, size);
       memset (p, 0, sizeof *p);
       maxbin = size >> 1;
@@ -166,6 +424,16 @@ profile_ctl (struct profinfo * p, char *samples, size_t size,
       prof.lowpc = offset;
       prof.highpc = PROFADDR (maxbin, offset, scale);
       prof.scale = scale;
+#ifdef __MINGW32__
+      p->nbins = maxbin;
+      p->divisor = 1;
+      if ((p->bins = calloc (maxbin, sizeof (u_int))) == NULL)
+	{
+	  errno = ENOMEM;
+	  return -1;
+	}
+      profile_config (p);
+#endif
 
       return profile_on (p);
     }
@@ -173,7 +441,7 @@ profile_ctl (struct profinfo * p, char *samples, size_t size,
 }
 
 /* Equivalent to unix profil()
-   Every SLEEPTIME interval, the user's program counter (PC) is examined:
+   Every SLEEPTIME interval, (nominally), the user's program counter (PC) is examined:
    offset is subtracted and the result is multiplied by scale.
    The word pointed to by this address is incremented.  Buf is unused. */
 
@@ -183,3 +451,38 @@ profil (char *samples, size_t size, u_long offset, u_int scale)
   return profile_ctl (&prof, samples, size, offset, scale);
 }
 
+#ifdef __MINGW32__
+/* The effective sampling rate of the counters most recently stopped. */
+
+u_int
+profile_rate (void)
+{
+  u_int hz = prof.rate ? prof.rate : PROF_HZ;
+  u_int div = prof.divisor ? prof.divisor : 1;
+
+  return (hz >= div) ? (hz + div / 2) / div : 1;
+}
+
+/* Step to the next thread after PREV, (or the first, if PREV is NULL),
+   which has its own histogram; fold that into COUNTER, and store its
+   effective sampling rate in *HZ.  Returns NULL when there are none left,
+   or if profiling is still active.  */
+
+struct profthread *
+profile_thread_hist (struct profthread *prev, u_short *counter, u_int *hz)
+{
+  struct profthread *t = prev ? prev->next : prof.threads;
+  u_int div;
+
+  if (prof.profthr)
+    return NULL;
+  while (t && t->bins == NULL)
+    t = t->next;
+  if (t)
+    {
+      div = profile_fold (counter, t->bins, prof.nbins, prof.rate);
+      *hz = (prof.rate >= div) ? (prof.rate + div / 2) / div : 1;
+    }
+  return t;
+}
+#endif
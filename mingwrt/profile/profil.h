@@ -38,14 +38,64 @@ details. */
 
 typedef void *_WINHANDLE;
 
+#ifdef __MINGW32__
+/* profiling frequency may be changed, within the range 1..PROF_HZ_MAX,
+   by setting GMON_HZ in the environment.  */
+#define PROF_HZ_MAX		1000
+
+/* sampling modes, selected by setting GMON_THREADS in the environment
+   to "self" (the default), "all", or "each".  */
+#define PROF_THREADS_SELF	0	/* sample the thread calling profil */
+#define PROF_THREADS_ALL	1	/* sample every thread in the process */
+#define PROF_THREADS_EACH	2	/* likewise, with per-thread histograms */
+
+/* an index which lies outside of any histogram */
+#define PROFBIN_NONE		((size_t)(-1))
+
+/* a thread which is sampled, in PROF_THREADS_ALL or PROF_THREADS_EACH
+   mode; the record persists after the thread has terminated, (when its
+   handle is closed, and cleared), if it carries a histogram.  */
+struct profthread {
+    struct profthread *next;
+    _WINHANDLE handle;			/* thread to profile, or NULL */
+    u_long tid;				/* its thread ID */
+    u_long seen;			/* last scan which found it */
+    u_int *bins;			/* its histogram, or NULL */
+};
+#endif /* __MINGW32__ */
+
 struct profinfo {
     _WINHANDLE targthr;			/* thread to profile */
     _WINHANDLE profthr;			/* profiling thread */
     u_short *counter;			/* profiling counters */
     u_long lowpc, highpc;		/* range to be profiled */
     u_int scale;			/* scale value of bins */
+#ifdef __MINGW32__
+    u_int *bins;			/* 32-bit counters, folded to counter */
+    size_t nbins;			/* number of elements in each */
+    u_int hz;				/* nominal sampling frequency */
+    u_int rate;				/* frequency actually achieved */
+    u_int divisor;			/* counter = bins / divisor */
+    int mode;				/* PROF_THREADS_SELF, ALL or EACH */
+    volatile int stop;			/* request to profthr to terminate */
+    struct profthread *threads;		/* threads sampled, if not SELF */
+#endif /* __MINGW32__ */
 };
 
 int profile_ctl(struct profinfo *, char *, size_t, u_long, u_int);
 int profil(char *, size_t, u_long, u_int);
 
+#ifdef __MINGW32__
+/* histogram bucketing and merging, (independent of the Windows API) */
+size_t profile_bin(const struct profinfo *, u_long);
+void profile_merge(u_int *, const u_int *, size_t);
+u_int profile_fold(u_short *, const u_int *, size_t, u_int);
+u_int profile_measured_rate(u_long, unsigned long long, unsigned long long,
+			    u_int);
+
+/* effective rate of the samples most recently folded into counter,
+   and iterator over per-thread histograms, for use by _mcleanup */
+u_int profile_rate(void);
+struct profthread *profile_thread_hist(struct profthread *, u_short *, u_int *);
+#endif /* __MINGW32__ */
+
@@ -0,0 +1,28 @@
+/*
+ * pseudo-reloc-hook.c
+ * This file has no copyright assigned and is placed in the Public Domain.
+ * This file is a part of the mingw-runtime package.
+ * No warranty is given; refer to the file DISCLAIMER within the package.
+ *
+ * This libmingw32.a object sets _CRT_pseudo_reloc_hook to NULL, so that
+ * _pei386_runtime_relocator() does not report any diagnostic information.
+ *
+ * To override the default, add, eg:
+ *
+ * void report (void *image_base, unsigned int relocs, unsigned int ranges,
+ *              long long ticks)
+ * { ... }
+ * void (*_CRT_pseudo_reloc_hook)(void *, unsigned int, unsigned int,
+ *                                long long) = report;
+ *
+ * to your application, (or DLL); the function is then called, once only,
+ * on completion of run time pseudo-relocation of the module, (before any
+ * C++ static constructors have been run), with the module's base address,
+ * the number of relocations applied, the number of page ranges which were
+ * made temporarily writable, and the elapsed time, in ticks as counted by
+ * QueryPerformanceCounter().
+ */
+#include <stddef.h>
+
+void (*_CRT_pseudo_reloc_hook)(void *, unsigned int, unsigned int, long long)
+  = NULL;
@@ -28,6 +28,8 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 
+#include "pseudo-reloc.h"
+
 #if defined(__CYGWIN__)
 #include <wchar.h>
 #include <ntdef.h>
@@ -57,6 +59,12 @@ extern char __MINGW_LSYMBOL(_image_base__);
 
 void _pei386_runtime_relocator (void);
 
+/* Optional diagnostic hook; it is NULL, unless the application defines
+ * it otherwise.
+ */
+extern void (*_CRT_pseudo_reloc_hook)
+  (void *, unsigned int, unsigned int, long long);
+
 /* v1 relocation is basically:
  *   *(base + .target) += .addend
  * where (base + .target) is always assumed to point
@@ -162,11 +170,22 @@ __report_error (const char *msg, ...)
 #endif
 }
 
-/* This function temporarily marks the page containing addr
- * writable, before copying len bytes from *src to *addr, and
- * then restores the original protection settings to the page.
+/* The following functions make the pages containing each relocation
+ * target writable, before any relocation is applied, and then restore
+ * their original protection settings, after ALL relocations have been
+ * applied.  To achieve this, the relocation list is processed twice: in
+ * the first pass, nothing is written, but each target is surveyed, using
+ * VirtualQuery(); this identifies the region of pages, extending from
+ * the target to the end of its section, (or of any sub-range of the
+ * section which shares the same protection).  Such regions which end
+ * at the same address are merged, so that, however many relocations
+ * there are, and in whatever order they are listed, each section is
+ * made writable by just one VirtualProtect() call, before the second
+ * pass applies the relocations, with another to restore it; (the
+ * grouping logic itself is implemented in pseudo-reloc.h, and these
+ * functions provide its VirtualQuery() and VirtualProtect() methods).
  *
- * Using this function eliminates the requirement with older
+ * Using these functions eliminates the requirement with older
  * pseudo-reloc implementations, that sections containing
  * pseudo-relocs (such as .text and .rdata) be permanently
  * marked writable. This older behavior sabotaged any memory
@@ -175,30 +194,128 @@ __report_error (const char *msg, ...)
  * .text section is still marked writable, and the .rdata section
  * is folded into the (writable) .data when --enable-auto-import.
  */
+static void __query_memory
+  (pseudo_reloc_regions *, char *, pseudo_reloc_region *);
+static void __restore_region (pseudo_reloc_regions *, pseudo_reloc_region *);
+
+static NO_COPY pseudo_reloc_regions __regions =
+  { __query_memory, __restore_region };
+static NO_COPY unsigned int __reloc_count, __protect_count;
+
 static void
-__write_memory (void *addr, const void *src, size_t len)
+__query_memory (pseudo_reloc_regions *regions __attribute__ ((__unused__)),
+		char *addr, pseudo_reloc_region *r)
 {
   MEMORY_BASIC_INFORMATION b;
-  DWORD oldprot;
-
-  if (!len)
-    return;
 
+  /* Query method, for __regions: identify the region of pages which
+   * includes addr, as the extent, and the protection, which Windows
+   * reports for it.
+   */
   if (!VirtualQuery (addr, &b, sizeof(b)))
     {
       __report_error ("  VirtualQuery failed for %d bytes at address %p",
 		      (int) sizeof(b), addr);
     }
+  r->base = (char *) b.BaseAddress;
+  r->size = b.RegionSize;
+  r->protect = b.Protect & 0xff;
+}
+
+static void
+__restore_region (pseudo_reloc_regions *regions __attribute__ ((__unused__)),
+		  pseudo_reloc_region *r)
+{
+  DWORD oldprot;
+
+  /* Restore method, for __regions: reinstate the protection which the
+   * region had, before we made it writable.
+   */
+  VirtualProtect (r->base, r->size, r->oldprot, &oldprot);
+}
+
+static void
+__restore_modified_sections (void)
+{
+  int i;
 
-  /* Temporarily allow write access to read-only protected memory.  */
-  if (b.Protect != PAGE_EXECUTE_READWRITE && b.Protect != PAGE_READWRITE)
-    VirtualProtect (b.BaseAddress, b.RegionSize, PAGE_EXECUTE_READWRITE,
-		  &oldprot);
-  /* write the data. */
-  memcpy (addr, src, len);
-  /* Restore original protection. */
-  if (b.Protect != PAGE_EXECUTE_READWRITE && b.Protect != PAGE_READWRITE)
-    VirtualProtect (b.BaseAddress, b.RegionSize, oldprot, &oldprot);
+  /* Restore original protection, on every region which we made
+   * writable, then forget all recorded regions.
+   */
+  for (i = 0; i < __regions.count; i++)
+    if (__regions.region[i].changed)
+      __restore_region (&__regions, __regions.region + i);
+  __regions.count = __regions.last = 0;
+}
+
+static void
+__make_writable (pseudo_reloc_region *r)
+{
+  DWORD prot = r->protect;
+
+  /* Temporarily allow write access to read-only protected memory,
+   * while preserving execute access, where the region already has it.
+   */
+  if (!r->changed
+      && prot != PAGE_EXECUTE_READWRITE && prot != PAGE_READWRITE
+      && prot != PAGE_EXECUTE_WRITECOPY && prot != PAGE_WRITECOPY)
+    {
+      prot = (prot & (PAGE_EXECUTE | PAGE_EXECUTE_READ))
+	? PAGE_EXECUTE_READWRITE : PAGE_READWRITE;
+      if (VirtualProtect (r->base, r->size, prot, &r->oldprot))
+	{
+	  r->changed = 1;
+	  ++__protect_count;
+	}
+    }
+}
+
+static void
+__unprotect_sections (void)
+{
+  int i;
+
+  /* On completion of the survey pass, make every recorded region
+   * writable, once only.
+   */
+  for (i = 0; i < __regions.count; i++)
+    __make_writable (__regions.region + i);
+}
+
+static void
+__mark_writable (char *addr)
+{
+  pseudo_reloc_region *r;
+
+  /* Nothing to do, if addr lies within any region we've already
+   * recorded, (and, when writing, already made writable); otherwise,
+   * query the region, and record it.
+   */
+  if ((r = pseudo_reloc_find_region (&__regions, addr)) == NULL)
+    {
+      r = pseudo_reloc_query_region (&__regions, addr);
+      if (__regions.pass > 0)
+	__make_writable (r);
+    }
+}
+
+static void
+__write_memory (void *addr, const void *src, size_t len)
+{
+  if (!len)
+    return;
+
+  /* Ensure that every page spanned by the write is writable, (it may
+   * straddle the boundary between two regions); when surveying, that
+   * is all we do, otherwise we also write the data.
+   */
+  __mark_writable ((char *) addr);
+  __mark_writable ((char *) addr + len - 1);
+  if (__regions.pass > 0)
+    {
+      memcpy (addr, src, len);
+      ++__reloc_count;
+    }
 }
 
 #define RP_VERSION_V1 0
@@ -365,10 +482,38 @@ void
 _pei386_runtime_relocator (void)
 {
   static NO_COPY int was_init = 0;
+  LARGE_INTEGER start, stop;
   if (was_init)
     return;
   ++was_init;
-  do_pseudo_reloc (&__RUNTIME_PSEUDO_RELOC_LIST__,
-		   &__RUNTIME_PSEUDO_RELOC_LIST_END__,
-		   &__MINGW_LSYMBOL(_image_base__));
+
+  /* When the application has opted in, by defining its own non-NULL
+   * _CRT_pseudo_reloc_hook, (see pseudo-reloc-hook.c), time the entire
+   * relocation process, and report it, together with the number of
+   * relocation entries, and the number of page ranges which were made
+   * temporarily writable.
+   */
+  if (_CRT_pseudo_reloc_hook != NULL)
+    QueryPerformanceCounter (&start);
+
+  /* Survey the relocation targets, make all affected sections writable,
+   * apply the relocations, then restore the original protection.
+   */
+  for (__regions.pass = 0; __regions.pass < 2; __regions.pass++)
+    {
+      do_pseudo_reloc (&__RUNTIME_PSEUDO_RELOC_LIST__,
+		       &__RUNTIME_PSEUDO_RELOC_LIST_END__,
+		       &__MINGW_LSYMBOL(_image_base__));
+      if (__regions.pass == 0)
+	__unprotect_sections ();
+    }
+  __restore_modified_sections ();
+
+  if (_CRT_pseudo_reloc_hook != NULL)
+    {
+      QueryPerformanceCounter (&stop);
+      _CRT_pseudo_reloc_hook (&__MINGW_LSYMBOL(_image_base__),
+			      __reloc_count, __protect_count,
+			      stop.QuadPart - start.QuadPart);
+    }
 }
@@ -0,0 +1,143 @@
+/*
+ * pseudo-reloc.h
+ *
+ * Private header, implementing the grouping of runtime pseudo-relocation
+ * targets into regions of pages, within which pseudo-reloc.c must make a
+ * temporary change of page protection.  The grouping logic accesses the
+ * memory map only through the methods of a pseudo_reloc_regions table,
+ * (and this header depends on no more than the <stddef.h> header), so
+ * that it may be checked, on any host, by substitution of a simulated
+ * memory map for the VirtualQuery() and VirtualProtect() APIs.
+ *
+ * This file has no copyright assigned and is placed in the Public Domain.
+ * This file is a part of the mingw-runtime package.
+ * No warranty is given; refer to the file DISCLAIMER within the package.
+ *
+ */
+#include <stddef.h>
+
+#define PSEUDO_RELOC_INLINE  static __inline__ __attribute__((__always_inline__))
+
+/* The capacity of the regions table; most images have far fewer sections
+ * than this.
+ */
+#define PSEUDO_RELOC_REGIONS_MAX 32
+
+typedef struct {
+  char *base;
+  size_t size;
+  unsigned long protect;
+  unsigned long oldprot;
+  int changed;
+} pseudo_reloc_region;
+
+typedef struct pseudo_reloc_regions pseudo_reloc_regions;
+
+struct pseudo_reloc_regions {
+  /* Methods to query the extent, and the protection, of the region of
+   * pages which includes a specified address, storing them in the base,
+   * size, and protect fields of the specified region, (the query method
+   * must not return, if it cannot do so), and to restore the original
+   * protection of a region, which is to be evicted from a full table.
+   */
+  void (*query) (pseudo_reloc_regions *, char *, pseudo_reloc_region *);
+  void (*restore) (pseudo_reloc_regions *, pseudo_reloc_region *);
+
+  /* The recorded regions, the index of the most recently used region,
+   * and the relocation pass: zero while surveying, and non-zero while
+   * writing.
+   */
+  int count, last, pass;
+  pseudo_reloc_region region[PSEUDO_RELOC_REGIONS_MAX];
+};
+
+PSEUDO_RELOC_INLINE pseudo_reloc_region *
+pseudo_reloc_find_region (pseudo_reloc_regions *regions, char *addr)
+{
+  pseudo_reloc_region *r;
+  int i;
+
+  /* Successive relocations usually fall within the same region as
+   * their predecessor, so check that first, then check all others.
+   */
+  if (regions->count > 0)
+    {
+      r = regions->region + regions->last;
+      if (addr >= r->base && (size_t)(addr - r->base) < r->size)
+	return r;
+      for (i = 0, r = regions->region; i < regions->count; i++, r++)
+	if (addr >= r->base && (size_t)(addr - r->base) < r->size)
+	  {
+	    regions->last = i;
+	    return r;
+	  }
+    }
+  return NULL;
+}
+
+PSEUDO_RELOC_INLINE pseudo_reloc_region *
+pseudo_reloc_query_region (pseudo_reloc_regions *regions, char *addr)
+{
+  pseudo_reloc_region b, *r;
+  int i;
+
+  regions->query (regions, addr, &b);
+
+  /* While surveying, before any protection has been changed, a region
+   * which ends where one already recorded ends must lie within the same
+   * section, with the same protection, so extend the recorded region
+   * to include it.
+   */
+  if (regions->pass == 0)
+    {
+      for (i = 0, r = regions->region; i < regions->count; i++, r++)
+	if (b.base + b.size == r->base + r->size)
+	  {
+	    if (b.base < r->base)
+	      {
+		r->size += r->base - b.base;
+		r->base = b.base;
+	      }
+	    regions->last = i;
+	    return r;
+	  }
+    }
+  else
+    {
+      /* When writing, a newly queried region may run on into one which
+       * we have already made writable; clip it, to avoid any overlap.
+       */
+      for (i = 0, r = regions->region; i < regions->count; i++, r++)
+	if (r->base > b.base && (size_t)(r->base - b.base) < b.size)
+	  b.size = r->base - b.base;
+    }
+
+  /* Otherwise, record a new region, if there is room; if not, while
+   * surveying, we simply leave it for lazy recording, when the second
+   * pass writes to it, but, in that pass, we must make room by evicting
+   * one already recorded, (other than the most recently used, which may
+   * be needed for the other end of a write which straddles two regions),
+   * and restoring its protection; (this is unlikely, because most images
+   * have far fewer sections than we allow for, but it remains correct,
+   * since the evicted region may be recorded again, if required).
+   */
+  if (regions->count == PSEUDO_RELOC_REGIONS_MAX)
+    {
+      if (regions->pass == 0)
+	return NULL;
+      i = (regions->last == 0) ? 1 : 0;
+      r = regions->region + i;
+      if (r->changed)
+	regions->restore (regions, r);
+      *r = regions->region[--regions->count];
+    }
+  regions->last = regions->count++;
+  r = regions->region + regions->last;
+  r->base = b.base;
+  r->size = b.size;
+  r->protect = b.protect;
+  r->changed = 0;
+  return r;
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,139 @@
+/*
+ * tlskeys.h
+ *
+ * Private header, implementing the registry of destructors for Win32 TLS
+ * keys, which is used by the libmingw32.a, (tlsthrd.c), and mingwm10.dll,
+ * (mthr.c), thread support modules, to run those destructors on behalf of
+ * each thread, (or of the process), on detach.
+ *
+ * This file has no copyright assigned and is placed in the Public Domain.
+ * This file is a part of the mingw-runtime package.
+ * No warranty is given; refer to the file DISCLAIMER within the package.
+ *
+ * Since a TLS key is a small integer index, (less than the sum of the
+ * TLS_MINIMUM_AVAILABLE base slots, and the 1024 expansion slots, which
+ * Windows provides), each key indexes its own slot in a fixed capacity
+ * destructor table, with a bitmap to identify the keys in use.  Thus,
+ * there is no per-key allocation, and registration is a matter of a few
+ * interlocked memory updates.  Thread detach visits only the keys which
+ * are in use; it first checks, without entering any critical section,
+ * whether the thread has any value for which a destructor must be run,
+ * and only when it has, does it enter the caller's critical section, to
+ * run the destructors.  Deregistration must be performed within that
+ * same critical section, so that no destructor may be called after its
+ * deregistration has been completed, (when the caller may release the
+ * key, or unload the module which provides the destructor); since the
+ * critical section is recursive, a destructor may itself deregister any
+ * key, including its own.  Registration need not be serialized.
+ */
+#define __MINGWTHR_KEY_MAX   (TLS_MINIMUM_AVAILABLE + 1024)
+#define __MINGWTHR_MAP_BITS  (8 * sizeof (LONG))
+#define __MINGWTHR_MAP_SIZE  (__MINGWTHR_KEY_MAX / __MINGWTHR_MAP_BITS)
+
+typedef void (*__mingwthr_dtor_t)(void *);
+
+static __mingwthr_dtor_t volatile __mingwthr_dtor_table[__MINGWTHR_KEY_MAX];
+static LONG volatile __mingwthr_key_map[__MINGWTHR_MAP_SIZE];
+static LONG volatile __mingwthr_key_words;
+
+static __inline__ void
+__mingwthr_key_map_update (LONG word, ULONG set, ULONG clear)
+{
+  /* Bit arithmetic on the map is performed unsigned, (so that the
+   * bit for the last key in each word is not the sign bit); only the
+   * interlocked exchange itself sees the map as LONG.
+   */
+  ULONG old;
+  do old = (ULONG)(__mingwthr_key_map[word]);
+  while ((ULONG)(InterlockedCompareExchange (__mingwthr_key_map + word,
+	  (LONG)((old & ~clear) | set), (LONG)(old))) != old);
+}
+
+static __inline__ int
+__mingwthr_key_register (DWORD key, __mingwthr_dtor_t dtor)
+{
+  LONG word, words;
+
+  if (key >= __MINGWTHR_KEY_MAX)
+    return -1;
+
+  /* Publish the destructor, before marking its key as in use, and
+   * extending the range of the bitmap to be scanned, if necessary.
+   */
+  word = key / __MINGWTHR_MAP_BITS;
+  InterlockedExchangePointer ((PVOID volatile *)(__mingwthr_dtor_table + key),
+			      (PVOID)(dtor));
+  __mingwthr_key_map_update (word, 1UL << (key % __MINGWTHR_MAP_BITS), 0);
+  while ((words = __mingwthr_key_words) <= word)
+    InterlockedCompareExchange (&__mingwthr_key_words, word + 1, words);
+  return 0;
+}
+
+static __inline__ void
+__mingwthr_key_deregister (DWORD key)
+{
+  if (key >= __MINGWTHR_KEY_MAX)
+    return;
+
+  /* Unmark the key, and withdraw its destructor; since the caller holds
+   * the critical section, within which any destructor must be called,
+   * none can be running, (except on this thread), so thereafter, the
+   * caller may safely release the key, for reallocation.
+   */
+  __mingwthr_key_map_update (key / __MINGWTHR_MAP_BITS, 0,
+			     1UL << (key % __MINGWTHR_MAP_BITS));
+  InterlockedExchangePointer ((PVOID volatile *)(__mingwthr_dtor_table + key),
+			      NULL);
+}
+
+static __inline__ int
+__mingwthr_key_visit (int run)
+{
+  LONG word, words = __mingwthr_key_words;
+  int count = 0;
+
+  /* Visit each key which is in use, and for which the calling thread
+   * has a non-NULL value, calling its destructor, with that value, when
+   * "run" is non-zero; otherwise, stop at the first such key.  Returns
+   * non-zero, if any such key was found.
+   */
+  for (word = 0; word < words; word++)
+    {
+      ULONG map;
+
+      for (map = (ULONG)(__mingwthr_key_map[word]); map != 0; map &= map - 1)
+	{
+	  DWORD key = word * __MINGWTHR_MAP_BITS + __builtin_ctz (map);
+	  __mingwthr_dtor_t dtor;
+	  LPVOID value;
+
+	  if ((dtor = __mingwthr_dtor_table[key]) != NULL)
+	    {
+	      value = TlsGetValue (key);
+	      if ((GetLastError () == ERROR_SUCCESS) && (value != NULL))
+		{
+		  if (run == 0)
+		    return 1;
+		  dtor (value);
+		  count = 1;
+		}
+	    }
+	}
+    }
+  return count;
+}
+
+static __inline__ void
+__mingwthr_key_run_dtors (CRITICAL_SECTION *cs)
+{
+  /* Unless the calling thread has no value for which a destructor must
+   * be run, (in which case, we need not enter the critical section at
+   * all), run each such destructor, within the critical section.
+   */
+  if (__mingwthr_key_visit (0))
+    {
+      EnterCriticalSection (cs);
+      __mingwthr_key_visit (1);
+      LeaveCriticalSection (cs);
+    }
+}
@@ -12,6 +12,7 @@
 
 #include <windows.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <memory.h>
 #include <malloc.h>
 
@@ -30,52 +31,55 @@ extern WINBOOL __mingw_TLScallback (HANDLE hDllHandle, DWORD reason, LPVOID rese
 
 #define FUNCS_PER_NODE 30
 
+/* Each thread's destructors, as registered by __tlregdtor(), or by
+   __cxa_thread_atexit_impl(), are kept in a list of TlsDtorNode blocks;
+   since this module is itself compiled without any assurance that the
+   loader will provide static TLS, (it doesn't, for DLLs loaded by
+   LoadLibrary() on Windows versions prior to Vista), the list head is
+   stored in a dynamically allocated TLS slot.  */
 typedef struct TlsDtorNode {
   int count;
   struct TlsDtorNode *next;
-  _PVFV funcs[FUNCS_PER_NODE];
+  struct {
+    void (*dtor) (void *);
+    void *obj;
+    HMODULE dso;
+  } funcs[FUNCS_PER_NODE];
 } TlsDtorNode;
 
+static DWORD volatile __tls_dtor_slot = TLS_OUT_OF_INDEXES;
+static DWORD __tls_dtor_slot_get (void);
+
 ULONG _tls_index = 0;
 
-/* TLS raw template data start and end. */
-_CRTALLOC(".tls$AAA") char _tls_start = 0;
-_CRTALLOC(".tls$ZZZ") char _tls_end = 0;
+/* TLS raw template data start and end.  These are pointer sized, so
+   that the template data remains pointer aligned; the template must
+   begin at the start of the .tls section, since the compiler refers
+   to each static TLS variable by its section relative offset.  */
+_CRTALLOC(".tls$AAA") char *_tls_start = NULL;
+_CRTALLOC(".tls$ZZZ") char *_tls_end = NULL;
 
 _CRTALLOC(".CRT$XLA") PIMAGE_TLS_CALLBACK __xl_a = 0;
 _CRTALLOC(".CRT$XLZ") PIMAGE_TLS_CALLBACK __xl_z = 0;
 
+/* The TLS directory itself is not a part of the template; it must not
+   be copied into each thread's TLS block.  */
 #ifdef _WIN64
-_CRTALLOC(".tls") const IMAGE_TLS_DIRECTORY64 _tls_used = {
-  (ULONGLONG) &_tls_start+1, (ULONGLONG) &_tls_end, (ULONGLONG) &_tls_index,
+_CRTALLOC(".rdata$T") const IMAGE_TLS_DIRECTORY64 _tls_used = {
+  (ULONGLONG) &_tls_start, (ULONGLONG) &_tls_end, (ULONGLONG) &_tls_index,
   (ULONGLONG) (&__xl_a+1), (ULONG) 0, (ULONG) 0
 };
 #else
-_CRTALLOC(".tls") const IMAGE_TLS_DIRECTORY _tls_used = {
-  (ULONG)(ULONG_PTR) &_tls_start+1, (ULONG)(ULONG_PTR) &_tls_end,
+_CRTALLOC(".rdata$T") const IMAGE_TLS_DIRECTORY _tls_used = {
+  (ULONG)(ULONG_PTR) &_tls_start, (ULONG)(ULONG_PTR) &_tls_end,
   (ULONG)(ULONG_PTR) &_tls_index, (ULONG)(ULONG_PTR) (&__xl_a+1),
   (ULONG) 0, (ULONG) 0
 };
 #endif
 
-#ifndef __CRT_THREAD
-#ifdef HAVE_ATTRIBUTE_THREAD
-#define __CRT_THREAD  __declspec(thread)
-#else
-#define __CRT_THREAD  __thread
-#endif
-#endif
-
-#define DISABLE_MS_TLS 1
-
 static _CRTALLOC(".CRT$XDA") _PVFV __xd_a = 0;
 static _CRTALLOC(".CRT$XDZ") _PVFV __xd_z = 0;
 
-#if !defined (DISABLE_MS_TLS)
-static __CRT_THREAD TlsDtorNode *dtor_list;
-static __CRT_THREAD TlsDtorNode dtor_list_head;
-#endif
-
 extern int _CRT_MT;
 
 BOOL WINAPI __dyn_tls_init (HANDLE, DWORD, LPVOID);
@@ -113,19 +117,100 @@ const PIMAGE_TLS_CALLBACK __dyn_tls_init_callback = (const PIMAGE_TLS_CALLBACK)
 _CRTALLOC(".CRT$XLC") PIMAGE_TLS_CALLBACK __xl_c = (PIMAGE_TLS_CALLBACK) __dyn_tls_init;
 
 int __cdecl __tlregdtor (_PVFV);
+int __cdecl __cxa_thread_atexit_impl (void (*) (void *), void *, void *);
 
-int __cdecl
-__tlregdtor (_PVFV func)
+static DWORD
+__tls_dtor_slot_get (void)
 {
-  if (!func)
-    return 0;
-#if !defined (DISABLE_MS_TLS)
-  if (dtor_list == NULL)
+  DWORD slot;
+
+  /* The slot is allocated only when the first destructor is registered,
+     so that modules which register none do not consume one; since that
+     may happen on any thread, we must allow for a race to allocate it.  */
+  if ((slot = __tls_dtor_slot) == TLS_OUT_OF_INDEXES
+      && (slot = TlsAlloc ()) != TLS_OUT_OF_INDEXES)
     {
-      dtor_list = &dtor_list_head;
-      dtor_list_head.count = 0;
+      DWORD prev = (DWORD) InterlockedCompareExchange (
+	(LONG volatile *) &__tls_dtor_slot, (LONG) slot,
+	(LONG) TLS_OUT_OF_INDEXES);
+      if (prev != TLS_OUT_OF_INDEXES)
+	{
+	  TlsFree (slot);
+	  slot = prev;
+	}
     }
-    else if (dtor_list->count == FUNCS_PER_NODE)
+  return slot;
+}
+
+#ifndef GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS
+#define GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS		0x00000004
+#define GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT	0x00000002
+#endif
+
+typedef BOOL WINAPI (*__tls_module_handle_ex) (DWORD, LPCSTR, HMODULE *);
+
+static HMODULE
+__tls_dso_pin (void *dso_symbol)
+{
+  static __tls_module_handle_ex get_handle_ex
+    = (__tls_module_handle_ex) (-1);
+  HMODULE dso, self;
+
+  /* Take a reference to the module which contains dso_symbol, so that
+     it cannot be unloaded before its destructor has run; this requires
+     GetModuleHandleExA(), which is not available prior to WinXP, so we
+     must resolve it at run time, (and without it, we simply proceed
+     without the reference, as we always did).  No reference is needed
+     for this module itself, since the destructors are run, at latest,
+     when it is detached.  */
+  if (dso_symbol == NULL)
+    return NULL;
+  if (get_handle_ex == (__tls_module_handle_ex) (-1))
+    get_handle_ex = (__tls_module_handle_ex) GetProcAddress (
+      GetModuleHandleA ("kernel32.dll"), "GetModuleHandleExA");
+  if (get_handle_ex == NULL
+      || !get_handle_ex (GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS
+			 | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+			 (LPCSTR) __tls_dso_pin, &self)
+      || !get_handle_ex (GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
+			 (LPCSTR) dso_symbol, &dso))
+    return NULL;
+  if (dso == self)
+    {
+      FreeLibrary (dso);
+      return NULL;
+    }
+  return dso;
+}
+
+static void __tls_run_dtors (void);
+static LONG volatile __tls_atexit_registered = 0;
+
+int __cdecl
+__cxa_thread_atexit_impl (void (*dtor) (void *), void *obj, void *dso_symbol)
+{
+  TlsDtorNode *dtor_list;
+  DWORD slot;
+
+  /* Each module links its own copy of this registry, but the destructor
+     may belong to another module, (as identified by dso_symbol), which
+     we must keep loaded, until the destructor has been run.  */
+  if (!dtor)
+    return 0;
+  if ((slot = __tls_dtor_slot_get ()) == TLS_OUT_OF_INDEXES)
+    return -1;
+
+  /* The destructors registered by the thread which calls exit() must be
+     run before any static destructor which was registered, by atexit(),
+     before the first thread destructor; (later registrations cannot be
+     so ordered, but those for the main thread are most likely to occur
+     when main() first uses each thread local object, which is after all
+     static constructors have been run).  */
+  if (InterlockedCompareExchange (&__tls_atexit_registered, 1, 0) == 0)
+    atexit (__tls_run_dtors);
+
+  dtor_list = (TlsDtorNode *) TlsGetValue (slot);
+  if (dtor_list == NULL || dtor_list->count == FUNCS_PER_NODE)
     {
       TlsDtorNode *pnode = (TlsDtorNode *) malloc (sizeof (TlsDtorNode));
       if (pnode == NULL)
@@ -133,45 +218,80 @@ __tlregdtor (_PVFV func)
       pnode->count = 0;
       pnode->next = dtor_list;
       dtor_list = pnode;
-
-      dtor_list->count = 0;
+      TlsSetValue (slot, dtor_list);
     }
-  dtor_list->funcs[dtor_list->count++] = func;
-#endif
+  dtor_list->funcs[dtor_list->count].dtor = dtor;
+  dtor_list->funcs[dtor_list->count].obj = obj;
+  dtor_list->funcs[dtor_list->count++].dso = __tls_dso_pin (dso_symbol);
   return 0;
 }
 
+static void
+__tlregdtor_call (void *func)
+{
+  (*(_PVFV) func) ();
+}
+
+int __cdecl
+__tlregdtor (_PVFV func)
+{
+  if (!func)
+    return 0;
+  return __cxa_thread_atexit_impl (__tlregdtor_call, (void *) func, NULL);
+}
+
+static void
+__tls_run_dtors (void)
+{
+  TlsDtorNode *pnode;
+  DWORD slot;
+
+  if ((slot = __tls_dtor_slot) == TLS_OUT_OF_INDEXES)
+    return;
+
+  /* Run destructors in the reverse order of registration, one at a
+     time, fetching the list head afresh each time, since any
+     destructor may register further destructors, (reusing the entry
+     which we have just removed, so we must take a copy of it); after
+     running each, release the reference, if any, to its module.  */
+  while ((pnode = (TlsDtorNode *) TlsGetValue (slot)) != NULL)
+    {
+      if (pnode->count == 0)
+	{
+	  TlsSetValue (slot, pnode->next);
+	  free ((void *) pnode);
+	}
+      else
+	{
+	  void (*dtor) (void *) = pnode->funcs[--pnode->count].dtor;
+	  void *obj = pnode->funcs[pnode->count].obj;
+	  HMODULE dso = pnode->funcs[pnode->count].dso;
+
+	  (*dtor) (obj);
+	  if (dso != NULL)
+	    FreeLibrary (dso);
+	}
+    }
+}
+
 static BOOL WINAPI
 __dyn_tls_dtor (HANDLE hDllHandle, DWORD dwReason, LPVOID lpreserved)
 {
-#if !defined (DISABLE_MS_TLS)
-  TlsDtorNode *pnode, *pnext;
-  int i;
-#endif
-
   if (dwReason != DLL_THREAD_DETACH && dwReason != DLL_PROCESS_DETACH)
     return TRUE;
-  /* As TLS variables are detroyed already by DLL_THREAD_DETACH
-     call, we have to avoid access on the possible DLL_PROCESS_DETACH
-     call the already destroyed TLS vars.
-     TODO: The used local thread based variables have to be handled
-     manually, so that we can control their lifetime here.  */
-#if !defined (DISABLE_MS_TLS)
-  if (dwReason != DLL_PROCESS_DETACH)
+
+  /* On DLL_PROCESS_DETACH, only the destructors registered by the
+     detaching thread remain to be run; when detaching because of
+     FreeLibrary(), rather than process termination, we must also
+     release the TLS slot, but any destructors which other threads
+     have registered are necessarily abandoned.  */
+  __tls_run_dtors ();
+  if (dwReason == DLL_PROCESS_DETACH && lpreserved == NULL
+      && __tls_dtor_slot != TLS_OUT_OF_INDEXES)
     {
-      for (pnode = dtor_list; pnode != NULL; pnode = pnext)
-        {
-          for (i = pnode->count - 1; i >= 0; --i)
-            {
-              if (pnode->funcs[i] != NULL)
-                (*pnode->funcs[i])();
-            }
-          pnext = pnode->next;
-          if (pnext != NULL)
-            free ((void *) pnode);
-        }
+      TlsFree (__tls_dtor_slot);
+      __tls_dtor_slot = TLS_OUT_OF_INDEXES;
     }
-#endif
   __mingw_TLScallback (hDllHandle, dwReason, lpreserved);
   return TRUE;
 }